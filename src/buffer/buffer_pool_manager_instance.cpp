@@ -55,13 +55,9 @@ bool BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) {
  }
   frame_id_t frame_id=page_table_[page_id];
   Page*page=&pages_[frame_id];
-  if(page->pin_count_){
-    latch_.unlock();
-
-    return true;
-
-  }
+  // pinned pages are written as well, a checkpoint relies on every dirty page reaching disk
   if(page->is_dirty_){
+    FlushLogForPage(page);
     disk_manager_->WritePage(page_id,page->data_);
     page->is_dirty_=false;
   }
@@ -113,6 +109,7 @@ Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) {
   page=&pages_[frame_id];
   page_id_t page_id_new=page->page_id_;
   if(page->is_dirty_){
+    FlushLogForPage(page);
     disk_manager_->WritePage(page_id_new,page->data_);
   }
   page_table_.erase(page_id_new);
@@ -157,6 +154,7 @@ Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
       page=&pages_[frame_id];
       page_id_t page_id_old=page->page_id_;
       if(page->is_dirty_){   
+        FlushLogForPage(page);
         disk_manager_->WritePage(page_id_old,page->data_);
       }
       page_table_.erase(page_id_old);
@@ -233,6 +231,13 @@ bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) {
   return true; 
 }
 
+void BufferPoolManagerInstance::FlushLogForPage(Page *page) {
+  // Write-ahead rule: the log records describing a page must reach disk before the page itself does.
+  if (enable_logging && log_manager_ != nullptr && page->GetLSN() > log_manager_->GetPersistentLSN()) {
+    log_manager_->FlushUntil(page->GetLSN());
+  }
+}
+
 page_id_t BufferPoolManagerInstance::AllocatePage() {
   const page_id_t next_page_id = next_page_id_;
   next_page_id_ += num_instances_;
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// catalog.cpp
+//
+// Identification: src/catalog/catalog.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/catalog.h"
+
+#include <deque>
+#include <future>  // NOLINT
+#include <iterator>
+#include <utility>
+
+#include "common/thread_pool.h"
+#include "storage/page/table_page.h"
+
+namespace bustub {
+
+namespace {
+/** The number of table pages scanned by one task of an index rebuild. */
+constexpr size_t REBUILD_SCAN_BATCH_PAGES = 16;
+
+/** The index entries found by one scan task, one vector per index of the table. */
+using IndexEntries = std::vector<std::vector<std::pair<Tuple, RID>>>;
+}  // namespace
+
+void Catalog::RebuildIndexes(Transaction *txn, size_t num_threads) {
+  // Declared before the pool, so that they outlive the tasks still running if a task fails
+  std::deque<IndexEntries> scanned;
+  std::vector<std::future<void>> builds;
+  ThreadPool pool(num_threads);
+
+  for (const auto &[table_oid, table_info] : tables_) {
+    std::vector<IndexInfo *> indexes = GetTableIndexes(table_info->name_);
+    if (indexes.empty()) {
+      continue;
+    }
+    for (auto *index_info : indexes) {
+      index_info->index_->Destroy(txn);
+      index_info->index_ = index_info->make_empty_index_();
+    }
+
+    // Walk the page chain and hand out batches of pages to scan; a page fetched here to find its successor is
+    // usually still cached when its batch is scanned.
+    std::vector<IndexEntries *> table_entries;
+    std::vector<std::future<void>> scans;
+    const Schema *schema = &table_info->schema_;
+    TableHeap *table = table_info->table_.get();
+    page_id_t page_id = table->GetFirstPageId();
+    if (page_id == INVALID_PAGE_ID) {
+      // A table that is not a chain of table pages, such as an LsmTable, is scanned with its iterator in one task
+      auto *entries = &scanned.emplace_back(indexes.size());
+      table_entries.push_back(entries);
+      scans.push_back(pool.Submit([table, entries, schema, indexes, txn] {
+        for (auto tuple = table->Begin(txn); tuple != table->End(); ++tuple) {
+          for (size_t i = 0; i < indexes.size(); i++) {
+            auto *index = indexes[i]->index_.get();
+            (*entries)[i].emplace_back(tuple->KeyFromTuple(*schema, indexes[i]->key_schema_, index->GetKeyAttrs()),
+                                       tuple->GetRid());
+          }
+        }
+      }));
+    }
+    while (page_id != INVALID_PAGE_ID) {
+      std::vector<page_id_t> batch;
+      while (page_id != INVALID_PAGE_ID && batch.size() < REBUILD_SCAN_BATCH_PAGES) {
+        batch.push_back(page_id);
+        auto *page = static_cast<TablePage *>(bpm_->FetchPage(page_id));
+        page->RLatch();
+        page_id = page->GetNextPageId();
+        page->RUnlatch();
+        bpm_->UnpinPage(page->GetTablePageId(), false);
+      }
+      auto *entries = &scanned.emplace_back(indexes.size());
+      table_entries.push_back(entries);
+      scans.push_back(pool.Submit([this, batch = std::move(batch), entries, schema, indexes] {
+        for (page_id_t batch_page_id : batch) {
+          auto *page = static_cast<TablePage *>(bpm_->FetchPage(batch_page_id));
+          page->RLatch();
+          RID rid;
+          for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+            Tuple tuple;
+            if (!page->GetTupleUnlocked(rid, &tuple)) {
+              continue;
+            }
+            for (size_t i = 0; i < indexes.size(); i++) {
+              auto *index = indexes[i]->index_.get();
+              (*entries)[i].emplace_back(tuple.KeyFromTuple(*schema, indexes[i]->key_schema_, index->GetKeyAttrs()),
+                                         rid);
+            }
+          }
+          page->RUnlatch();
+          bpm_->UnpinPage(batch_page_id, false);
+        }
+      }));
+    }
+    for (auto &scan : scans) {
+      scan.get();
+    }
+
+    // Build the indexes of this table while the next table is scanned
+    for (size_t i = 0; i < indexes.size(); i++) {
+      builds.push_back(pool.Submit([table_entries, i, index = indexes[i]->index_.get(), txn] {
+        std::vector<std::pair<Tuple, RID>> entries;
+        for (auto *batch_entries : table_entries) {
+          auto &index_entries = (*batch_entries)[i];
+          std::move(index_entries.begin(), index_entries.end(), std::back_inserter(entries));
+        }
+        index->InsertEntries(&entries, txn);
+      }));
+    }
+  }
+
+  for (auto &build : builds) {
+    build.get();
+  }
+}
+
+}  // namespace bustub
@@ -18,25 +18,65 @@
 namespace bustub {
 
 bool LockManager::LockShared(Transaction *txn, const RID &rid) {
+  std::scoped_lock lock(latch_);
   txn->GetSharedLockSet()->emplace(rid);
+  InheritCommitDependency(txn, rid);
   return true;
 }
 
 bool LockManager::LockExclusive(Transaction *txn, const RID &rid) {
+  std::scoped_lock lock(latch_);
   txn->GetExclusiveLockSet()->emplace(rid);
+  InheritCommitDependency(txn, rid);
   return true;
 }
 
 bool LockManager::LockUpgrade(Transaction *txn, const RID &rid) {
+  std::scoped_lock lock(latch_);
   txn->GetSharedLockSet()->erase(rid);
   txn->GetExclusiveLockSet()->emplace(rid);
   return true;
 }
 
-bool LockManager::Unlock(Transaction *txn, const RID &rid) {
+bool LockManager::Unlock(Transaction *txn, const RID &rid, lsn_t commit_lsn) {
+  std::scoped_lock lock(latch_);
   txn->GetSharedLockSet()->erase(rid);
-  txn->GetExclusiveLockSet()->erase(rid);
+  bool exclusive = txn->GetExclusiveLockSet()->erase(rid) > 0;
+  // Only data written by txn can make a later transaction depend on the commit of txn.
+  if (exclusive && commit_lsn != INVALID_LSN) {
+    auto it = lock_table_.find(rid);
+    if (it == lock_table_.end()) {
+      it = lock_table_.try_emplace(rid).first;
+    }
+    it->second.released_commit_lsn_ = std::max(it->second.released_commit_lsn_, commit_lsn);
+    released_rids_.emplace(commit_lsn, rid);
+  }
   return true;
 }
 
+void LockManager::ForgetDurableCommits(lsn_t persistent_lsn) {
+  std::scoped_lock lock(latch_);
+  auto end = released_rids_.upper_bound(persistent_lsn);
+  for (auto released = released_rids_.begin(); released != end; ++released) {
+    auto it = lock_table_.find(released->second);
+    if (it == lock_table_.end() || it->second.released_commit_lsn_ > persistent_lsn) {
+      // gone already, or released again by a commit that is not on disk yet
+      continue;
+    }
+    if (it->second.request_queue_.empty() && it->second.upgrading_ == INVALID_TXN_ID) {
+      lock_table_.erase(it);
+    } else {
+      it->second.released_commit_lsn_ = INVALID_LSN;
+    }
+  }
+  released_rids_.erase(released_rids_.begin(), end);
+}
+
+void LockManager::InheritCommitDependency(Transaction *txn, const RID &rid) {
+  auto it = lock_table_.find(rid);
+  if (it != lock_table_.end()) {
+    txn->AddCommitDependency(it->second.released_commit_lsn_);
+  }
+}
+
 }  // namespace bustub
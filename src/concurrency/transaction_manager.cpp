@@ -30,6 +30,11 @@ Transaction *TransactionManager::Begin(Transaction *txn, IsolationLevel isolatio
   if (txn == nullptr) {
     txn = new Transaction(next_txn_id_++, isolation_level);
   }
+  if (enable_logging) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BEGIN);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+  }
+
   txn_map_mutex.lock();
   txn_map[txn->GetTransactionId()] = txn;
   txn_map_mutex.unlock();
@@ -41,6 +46,7 @@ void TransactionManager::Commit(Transaction *txn) {
 
   // Perform all deletes before we commit.
   auto write_set = txn->GetWriteSet();
+  bool read_only = write_set->empty() && txn->GetIndexWriteSet()->empty();
   while (!write_set->empty()) {
     auto &item = write_set->back();
     auto table = item.table_;
@@ -52,8 +58,25 @@ void TransactionManager::Commit(Transaction *txn) {
   }
   write_set->clear();
 
-  // Release all the locks.
-  ReleaseLocks(txn);
+  lsn_t commit_lsn = INVALID_LSN;
+  if (enable_logging) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+    commit_lsn = log_manager_->AppendLogRecord(&log_record);
+    txn->SetPrevLSN(commit_lsn);
+  }
+
+  // Release all the locks. Once the COMMIT record is appended nothing can abort the transaction anymore, so the locks
+  // are released before the flush. Transactions that go on to lock our writes inherit commit_lsn as a dependency.
+  ReleaseLocks(txn, commit_lsn);
+
+  // The commit is durable once its COMMIT record is on disk. An asynchronous commit leaves that to the flush thread.
+  // A transaction that wrote nothing only has to wait for the commits whose data it has seen.
+  if (enable_logging && !txn->IsAsyncCommit()) {
+    log_manager_->FlushUntil(read_only ? txn->GetCommitDependencyLSN() : commit_lsn);
+  }
+  if (enable_logging) {
+    lock_manager_->ForgetDurableCommits(log_manager_->GetPersistentLSN());
+  }
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
@@ -102,6 +125,11 @@ void TransactionManager::Abort(Transaction *txn) {
   table_write_set->clear();
   index_write_set->clear();
 
+  if (enable_logging) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ABORT);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -54,7 +56,7 @@ uint32_t HASH_TABLE_TYPE::Hash(KeyType key) {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 uint32_t HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) {
-  uint32_t hash_=this->Hash(key);
+  uint32_t hash_=this->Hash(key)>>dir_page->GetParentDepth();
   uint32_t global_mask=dir_page->GetGlobalDepthMask();
   return hash_&global_mask;
 }
@@ -73,6 +75,37 @@ HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectoryPage() {
   return dir_page;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectoryPage(const KeyType &key, page_id_t *parent_page_id) {
+  page_id_t parent = INVALID_PAGE_ID;
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  uint32_t dir_index = KeyToDirectoryIndex(key, dir_page);
+  while (dir_page->IsChildDirectory(dir_index)) {
+    parent = dir_page->GetPageId();
+    page_id_t child_page_id = dir_page->GetBucketPageId(dir_index);
+    buffer_pool_manager_->UnpinPage(parent, false);
+    dir_page = reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(child_page_id)->GetData());
+    dir_index = KeyToDirectoryIndex(key, dir_page);
+  }
+  if (parent_page_id != nullptr) {
+    *parent_page_id = parent;
+  }
+  return dir_page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visitor>
+void HASH_TABLE_TYPE::VisitDirectoryPages(page_id_t dir_page_id, Visitor visit) {
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(dir_page_id)->GetData());
+  visit(dir_page);
+  for (uint32_t dir_index = 0; dir_index < dir_page->Size(); dir_index++) {
+    if (dir_page->IsChildDirectory(dir_index)) {
+      VisitDirectoryPages(dir_page->GetBucketPageId(dir_index), visit);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(dir_page_id, false);
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_BUCKET_TYPE *HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
   Page*page=buffer_pool_manager_->FetchPage(bucket_page_id);
@@ -86,96 +119,134 @@ HASH_TABLE_BUCKET_TYPE *HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_i
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
   table_latch_.RLock();
-  auto dir_page=this->FetchDirectoryPage();
-  page_id_t bucket_page_id=this->KeyToPageId(key,dir_page);
-  auto bucket_page=this->FetchBucketPage(bucket_page_id);
-  bool flag=bucket_page->GetValue(key,comparator_, result);
-  buffer_pool_manager_->UnpinPage(bucket_page_id,false);
-  buffer_pool_manager_->UnpinPage(directory_page_id_,false);
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage(key);
+  page_id_t dir_page_id = dir_page->GetPageId();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->RLatch();
+  auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool found = bucket_page->GetValue(key, comparator_, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  buffer_pool_manager_->UnpinPage(dir_page_id, false);
   table_latch_.RUnlock();
-  return flag;
+  return found;
 }
 
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
+/*
+ * Insert with the directory read latched and only the bucket of the key write
+ * latched, so that inserts into different buckets run side by side. Only an
+ * insert into a full bucket goes on to SplitInsert, which latches the whole
+ * directory.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  //加锁
-  table_latch_.WLock();
-  HashTableDirectoryPage *dir_page=this->FetchDirectoryPage();
-  page_id_t page_id=KeyToPageId(key,dir_page);
-  HASH_TABLE_BUCKET_TYPE * bucket_page=this->FetchBucketPage(page_id);
-  bool is_dirty=bucket_page->Insert(key,value,comparator_);
-  table_latch_.WUnlock();
-  //这里几个脏位需要注意,直接设为true理论上没有错误
-  if(is_dirty){
-    //解锁
-    buffer_pool_manager_->UnpinPage(page_id,true);
-    buffer_pool_manager_->UnpinPage(directory_page_id_,false);
-    return true;
-  }
-  if(bucket_page->IsExist(key,value,comparator_)){
-    //解锁
-    buffer_pool_manager_->UnpinPage(page_id,false);
-    buffer_pool_manager_->UnpinPage(directory_page_id_,false);
-    return false;
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage(key);
+  page_id_t dir_page_id = dir_page->GetPageId();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->WLatch();
+  auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool inserted = bucket_page->Insert(key, value, comparator_);
+  // the bucket refused the pair because it has it already or because it is full
+  bool exists = !inserted && bucket_page->IsExist(key, value, comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  buffer_pool_manager_->UnpinPage(dir_page_id, false);
+  table_latch_.RUnlock();
+  if (inserted || exists) {
+    return inserted;
   }
-  is_dirty=SplitInsert(transaction,key,value);
-  buffer_pool_manager_->UnpinPage(page_id,is_dirty);
-  buffer_pool_manager_->UnpinPage(directory_page_id_,false);
-  return is_dirty;
+  return SplitInsert(transaction, key, value);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  // With the directory write latched no other thread is in any bucket, so the buckets are not latched
   table_latch_.WLock();
-  HashTableDirectoryPage *dir_page=this->FetchDirectoryPage();
-  page_id_t page_id=KeyToPageId(key,dir_page);
-  HASH_TABLE_BUCKET_TYPE * bucket_page=this->FetchBucketPage(page_id);
-  uint32_t bucket_index=KeyToDirectoryIndex(key,dir_page);
-  uint32_t local_depth=dir_page->GetLocalDepth(bucket_index);
-  if(dir_page->GetGlobalDepth()==local_depth){
-    if(dir_page->Size()<<1!=DIRECTORY_ARRAY_SIZE){
+  bool inserted = false;
+  while (true) {
+    // Another split may have made room for the key since Insert found its bucket full
+    HashTableDirectoryPage *dir_page = FetchDirectoryPage(key);
+    page_id_t dir_page_id = dir_page->GetPageId();
+    page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+    auto *bucket_page = FetchBucketPage(bucket_page_id);
+    inserted = bucket_page->Insert(key, value, comparator_);
+    if (inserted || bucket_page->IsExist(key, value, comparator_)) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+      buffer_pool_manager_->UnpinPage(dir_page_id, false);
+      break;
+    }
+
+    uint32_t bucket_index = KeyToDirectoryIndex(key, dir_page);
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_index);
+    uint32_t split_bit = dir_page->GetParentDepth() + local_depth;
+    if (split_bit >= 32) {
+      // The pairs of the bucket agree in every bit of the hash, so no split can part them
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      buffer_pool_manager_->UnpinPage(dir_page_id, false);
+      break;
+    }
+    if (local_depth == dir_page->GetGlobalDepth()) {
+      if (dir_page->Size() * 2 > DIRECTORY_ARRAY_SIZE) {
+        // The directory page is full, so the bucket takes a child directory page of its own and splits there
+        buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+        page_id_t child_page_id;
+        Page *child_page = buffer_pool_manager_->NewPage(&child_page_id);
+        if (child_page == nullptr) {
+          buffer_pool_manager_->UnpinPage(dir_page_id, false);
+          break;
+        }
+        auto *child_dir_page = reinterpret_cast<HashTableDirectoryPage *>(child_page->GetData());
+        child_dir_page->SetPageId(child_page_id);
+        child_dir_page->SetParentDepth(dir_page->GetParentDepth() + DIRECTORY_MAX_DEPTH);
+        child_dir_page->SetBucketPageId(0, bucket_page_id);
+        dir_page->SetBucketPageId(bucket_index, child_page_id);
+        dir_page->SetChildDirectory(bucket_index, true);
+        buffer_pool_manager_->UnpinPage(child_page_id, true);
+        buffer_pool_manager_->UnpinPage(dir_page_id, true);
+        continue;
+      }
       dir_page->IncrGlobalDepth();
-    }else{
-      table_latch_.WUnlock();
-      return false;
+      bucket_index = KeyToDirectoryIndex(key, dir_page);
     }
-    
-  }
-  page_id_t page_id_new=INVALID_PAGE_ID;
-  Page*page=buffer_pool_manager_->NewPage(&page_id_new);
-  HASH_TABLE_BUCKET_TYPE*bucket_page_image=reinterpret_cast<HashTableBucketPage<KeyType,ValueType,KeyComparator> *>(page->GetData());
-  size_t common_bit=(bucket_index)%(1<<local_depth);
-  for(size_t bucket_idx=common_bit;bucket_idx<dir_page->Size();bucket_idx+=(1<<local_depth)){
-    if(((bucket_idx>>local_depth)&1)!=((bucket_index>>local_depth)&1)){
-      dir_page->SetBucketPageId(bucket_idx,page_id_new);
-    }else{
-      //也可不要
-      dir_page->SetBucketPageId(bucket_idx,page_id);
+    page_id_t image_page_id;
+    Page *image_page = buffer_pool_manager_->NewPage(&image_page_id);
+    if (image_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      buffer_pool_manager_->UnpinPage(dir_page_id, true);
+      break;
     }
-    dir_page->IncrLocalDepth(bucket_idx);
-  }
-  for(size_t bucket_idx=0;bucket_idx<BUCKET_ARRAY_SIZE;bucket_idx++){
-    bool readable=bucket_page->IsReadable(bucket_idx);
-    auto data_key=bucket_page->KeyAt(bucket_idx);
-    auto data_value=bucket_page->ValueAt(bucket_idx);   
-    if(readable){
-      page_id_t page_id_insert=static_cast<page_id_t>(this->KeyToPageId(data_key,dir_page));
-      if(page_id_insert==page_id_new){
-        bucket_page_image->InsertAt(bucket_idx,data_key,data_value);
-        bucket_page->SetUnOccupied(bucket_idx);
-        bucket_page->SetUnReadable(bucket_idx);
-      }     
+    auto *image_bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(image_page->GetData());
+
+    // The slots whose hashes have the bit at local_depth set point to the split image from now on
+    uint32_t low_bits = bucket_index & ((1U << local_depth) - 1);
+    for (uint32_t dir_index = low_bits; dir_index < dir_page->Size(); dir_index += 1U << local_depth) {
+      if (((dir_index >> local_depth) & 1) == 1) {
+        dir_page->SetBucketPageId(dir_index, image_page_id);
+      }
+      dir_page->IncrLocalDepth(dir_index);
     }
+    // The moved pairs are packed at the front of the image, and only made unreadable in the bucket, so that the
+    // occupied slots of both stay a prefix as IsFull and IsEmpty expect
+    uint32_t image_index = 0;
+    for (uint32_t slot = 0; slot < BUCKET_ARRAY_SIZE; slot++) {
+      if (bucket_page->IsReadable(slot) && ((Hash(bucket_page->KeyAt(slot)) >> split_bit) & 1) == 1) {
+        image_bucket_page->InsertAt(image_index++, bucket_page->KeyAt(slot), bucket_page->ValueAt(slot));
+        bucket_page->RemoveAt(slot);
+      }
+    }
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    buffer_pool_manager_->UnpinPage(dir_page_id, true);
+    // If every pair went to the same side, the bucket of the key is still full and splits again
   }
-  buffer_pool_manager_->UnpinPage(page_id_new,true);
-  buffer_pool_manager_->UnpinPage(page_id,true);
-  buffer_pool_manager_->UnpinPage(directory_page_id_,true);
   table_latch_.WUnlock();
-  bool is_inserted=this->Insert(transaction,key,value);
-  return is_inserted;
+  return inserted;
 }
 
 /*****************************************************************************
@@ -183,23 +254,25 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  HashTableDirectoryPage *dir_page=this->FetchDirectoryPage();
-  table_latch_.WLock();
-  page_id_t page_id=KeyToPageId(key,dir_page);
-  HASH_TABLE_BUCKET_TYPE * bucket_page=this->FetchBucketPage(page_id);
-  bool is_dirty=bucket_page->Remove(key,value,comparator_);
-  if(is_dirty&&bucket_page->IsEmpty()){
-    buffer_pool_manager_->UnpinPage(page_id,is_dirty);
-    buffer_pool_manager_->UnpinPage(directory_page_id_,false);
-    Merge(transaction,key,value);
-  }
-  else{
-    buffer_pool_manager_->UnpinPage(page_id,is_dirty);
-    buffer_pool_manager_->UnpinPage(directory_page_id_,false);
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage(key);
+  page_id_t dir_page_id = dir_page->GetPageId();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->WLatch();
+  auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool removed = bucket_page->Remove(key, value, comparator_);
+  bool empty = removed && bucket_page->IsEmpty();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  buffer_pool_manager_->UnpinPage(dir_page_id, false);
+  table_latch_.RUnlock();
+  if (empty) {
+    Merge(transaction, key, value);
   }
-  table_latch_.WUnlock();
-  return is_dirty;
+  return removed;
 }
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::PrintBit(){
   // HashTableDirectoryPage *dir_page=this->FetchDirectoryPage();
@@ -213,62 +286,73 @@ void HASH_TABLE_TYPE::PrintBit(){
  * MERGE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value){
-  HashTableDirectoryPage *dir_page=this->FetchDirectoryPage();
-  page_id_t page_id=KeyToPageId(key,dir_page);
-  uint32_t bucket_index=KeyToDirectoryIndex(key,dir_page);
-  MergeMain(page_id,bucket_index);
-  buffer_pool_manager_->UnpinPage(directory_page_id_,false);//改为true试试？
-}
-
-template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_TYPE::MergeMain(page_id_t page_id,uint32_t bucket_index){
-  HashTableDirectoryPage *dir_page=this->FetchDirectoryPage();
-  //page_id_t page_id=KeyToPageId(key,dir_page);
-  //HASH_TABLE_BUCKET_TYPE * bucket_page=this->FetchBucketPage(page_id);
-  //uint32_t bucket_index=KeyToDirectoryIndex(key,dir_page);
-  uint32_t local_depth=dir_page->GetLocalDepth(bucket_index);
-  uint32_t bucket_index_image=dir_page->GetSplitImageIndex(bucket_index);
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  page_id_t parent_page_id;
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage(key, &parent_page_id);
+  page_id_t dir_page_id = dir_page->GetPageId();
+  uint32_t bucket_index = KeyToDirectoryIndex(key, dir_page);
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_index);
+  uint32_t local_depth = dir_page->GetLocalDepth(bucket_index);
+  uint32_t image_index = dir_page->GetSplitImageIndex(bucket_index);
+  page_id_t image_page_id = dir_page->GetBucketPageId(image_index);
 
-  if(local_depth!=0&&dir_page->GetLocalDepth(bucket_index)==dir_page->GetLocalDepth(bucket_index_image)
-  &&dir_page->GetBucketPageId(bucket_index)!=dir_page->GetBucketPageId(bucket_index_image)){
-    size_t common_bit=(bucket_index)%(1<<(local_depth-1));
-    for(size_t bucket_idx=common_bit;bucket_idx<dir_page->Size();bucket_idx+=(1<<local_depth)){
-      int bucket_bit=(bucket_index>>local_depth)&1;
-      int bucket_image_bit=(bucket_idx>>local_depth)&1;
-      if(bucket_bit==bucket_image_bit){
-        dir_page->SetBucketPageId(bucket_idx,dir_page->GetBucketPageId(bucket_index_image));
-      }
-      dir_page->DecrLocalDepth(bucket_idx);
-    }
-    buffer_pool_manager_->DeletePage(bucket_index);
-    bool flag=false;
-    for(size_t i=0;i<dir_page->Size();i++){
-      if(dir_page->GetLocalDepth(i)==dir_page->GetGlobalDepth()){
-        flag=true;
-        break;
+  // An insert may have refilled the bucket since Remove emptied it
+  bool empty = false;
+  if (local_depth != 0 && dir_page->GetLocalDepth(image_index) == local_depth &&
+      !dir_page->IsChildDirectory(image_index)) {
+    empty = FetchBucketPage(bucket_page_id)->IsEmpty();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  }
+  if (empty) {
+    for (uint32_t dir_index = 0; dir_index < dir_page->Size(); dir_index++) {
+      page_id_t slot_page_id = dir_page->GetBucketPageId(dir_index);
+      if (slot_page_id == bucket_page_id || slot_page_id == image_page_id) {
+        dir_page->SetBucketPageId(dir_index, image_page_id);
+        dir_page->DecrLocalDepth(dir_index);
       }
     }
-    if(!flag){
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+    while (dir_page->CanShrink()) {
       dir_page->DecrGlobalDepth();
-      for(size_t i=0;i<dir_page->Size();i++){
-        page_id_t bucket_index_next=dir_page->GetBucketPageId(i);
-        auto bucket_page_next=reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->FetchPage(bucket_index_next)->GetData());
-        if(bucket_page_next->IsEmpty()){
-          buffer_pool_manager_->UnpinPage(bucket_index_next,false);
-          MergeMain(bucket_index_next,i);
-        }
-        else{
-          buffer_pool_manager_->UnpinPage(bucket_index_next,false);
-        }
-      }     
     }
-    buffer_pool_manager_->UnpinPage(directory_page_id_,true);
-    return true;
   }
-  buffer_pool_manager_->UnpinPage(page_id,false);
-  buffer_pool_manager_->UnpinPage(directory_page_id_,false);
-  return false;
+  // A child directory page left with a single bucket gives it back to its parent
+  bool collapse = empty && parent_page_id != INVALID_PAGE_ID && dir_page->GetGlobalDepth() == 0;
+  if (collapse) {
+    auto *parent_dir_page =
+        reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+    uint32_t parent_index = KeyToDirectoryIndex(key, parent_dir_page);
+    parent_dir_page->SetBucketPageId(parent_index, dir_page->GetBucketPageId(0));
+    parent_dir_page->SetChildDirectory(parent_index, false);
+    buffer_pool_manager_->UnpinPage(parent_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(dir_page_id, empty);
+  if (collapse) {
+    buffer_pool_manager_->DeletePage(dir_page_id);
+  }
+  table_latch_.WUnlock();
+}
+
+/*****************************************************************************
+ * DESTROY
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::Destroy() {
+  table_latch_.WLock();
+  // a bucket shows up in every slot that points to it, so the pages are collected first
+  std::set<page_id_t> page_ids;
+  VisitDirectoryPages(directory_page_id_, [&page_ids](HashTableDirectoryPage *dir_page) {
+    page_ids.insert(dir_page->GetPageId());
+    for (uint32_t dir_index = 0; dir_index < dir_page->Size(); dir_index++) {
+      page_ids.insert(dir_page->GetBucketPageId(dir_index));
+    }
+  });
+  for (page_id_t page_id : page_ids) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  directory_page_id_ = INVALID_PAGE_ID;
+  table_latch_.WUnlock();
 }
 
 /*****************************************************************************
@@ -277,9 +361,10 @@ bool HASH_TABLE_TYPE::MergeMain(page_id_t page_id,uint32_t bucket_index){
 template <typename KeyType, typename ValueType, typename KeyComparator>
 uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
   table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  uint32_t global_depth = dir_page->GetGlobalDepth();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
+  uint32_t global_depth = 0;
+  VisitDirectoryPages(directory_page_id_, [&global_depth](HashTableDirectoryPage *dir_page) {
+    global_depth = std::max(global_depth, dir_page->GetParentDepth() + dir_page->GetGlobalDepth());
+  });
   table_latch_.RUnlock();
   return global_depth;
 }
@@ -290,9 +375,7 @@ uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::VerifyIntegrity() {
   table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  dir_page->VerifyIntegrity();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
+  VisitDirectoryPages(directory_page_id_, [](HashTableDirectoryPage *dir_page) { dir_page->VerifyIntegrity(); });
   table_latch_.RUnlock();
 }
 
@@ -11,12 +11,128 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include "common/exception.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexScanExecutor::Init() {
+  Catalog *catalog = GetExecutorContext()->GetCatalog();
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  table_info_ = catalog->GetTable(index_info_->table_name_);
+  auto *tree = dynamic_cast<TreeIndex *>(index_info_->index_.get());
+  if (tree == nullptr) {
+    throw NotImplementedException("index scans only run over B+ tree indexes of 8 byte keys");
+  }
+
+  lower_.reset();
+  upper_.reset();
+  lower_inclusive_ = upper_inclusive_ = true;
+  if (plan_->GetPredicate() != nullptr) {
+    NarrowRange(plan_->GetPredicate());
+  }
+  iterator_ = tree->GetRangeIterator(lower_ ? &*lower_ : nullptr, lower_inclusive_, upper_ ? &*upper_ : nullptr,
+                                     upper_inclusive_);
+}
+
+void IndexScanExecutor::NarrowRange(const AbstractExpression *predicate) {
+  const auto &key_attrs = index_info_->index_->GetKeyAttrs();
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(predicate);
+  if (key_attrs.size() != 1 || comparison == nullptr) {
+    return;
+  }
+
+  // bring the comparison into the form column comp_type constant
+  ComparisonType comp_type = comparison->GetComparisonType();
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+  if (column == nullptr && constant == nullptr) {
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        comp_type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        comp_type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        comp_type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        comp_type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  if (column == nullptr || constant == nullptr || column->GetColIdx() != key_attrs[0]) {
+    return;
+  }
+
+  KeyType key;
+  try {
+    key = KeyOf(constant->Evaluate(nullptr, nullptr));
+  } catch (Exception &e) {
+    // a constant that does not fit the key column leaves the scan unbounded, the predicate still filters it
+    return;
+  }
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      lower_ = upper_ = key;
+      break;
+    case ComparisonType::LessThan:
+    case ComparisonType::LessThanOrEqual:
+      upper_ = key;
+      upper_inclusive_ = comp_type == ComparisonType::LessThanOrEqual;
+      break;
+    case ComparisonType::GreaterThan:
+    case ComparisonType::GreaterThanOrEqual:
+      lower_ = key;
+      lower_inclusive_ = comp_type == ComparisonType::GreaterThanOrEqual;
+      break;
+    case ComparisonType::NotEqual:
+      break;
+  }
+}
+
+IndexScanExecutor::KeyType IndexScanExecutor::KeyOf(const Value &value) const {
+  // the index encodes its keys by the types of the table columns
+  Schema *key_schema = index_info_->index_->GetKeySchema();
+  Tuple key_tuple({value.CastAs(key_schema->GetColumn(0).GetType())}, key_schema);
+  KeyType key;
+  key.SetFromKey(key_tuple, key_schema);
+  return key;
+}
 
-void IndexScanExecutor::Init() {}
+bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
+  const Schema &table_schema = table_info_->schema_;
+  while (!iterator_.IsEnd()) {
+    RID table_rid = (*iterator_).second;
+    ++iterator_;
+    Tuple table_tuple;
+    if (!table_info_->table_->GetTuple(table_rid, &table_tuple, GetExecutorContext()->GetTransaction())) {
+      continue;
+    }
+    // the range only narrows the scan, the predicate decides on every tuple in it
+    const AbstractExpression *predicate = plan_->GetPredicate();
+    if (predicate != nullptr && !predicate->Evaluate(&table_tuple, &table_schema).GetAs<bool>()) {
+      continue;
+    }
 
-bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+    std::vector<Value> values;
+    for (const auto &column : GetOutputSchema()->GetColumns()) {
+      values.push_back(column.GetExpr()->Evaluate(&table_tuple, &table_schema));
+    }
+    *tuple = Tuple(values, GetOutputSchema());
+    *rid = table_rid;
+    return true;
+  }
+  return false;
+}
 
 }  // namespace bustub
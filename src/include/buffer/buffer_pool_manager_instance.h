@@ -102,6 +102,12 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void FlushAllPgsImp() override;
 
+  /**
+   * Forces the log up to the page LSN before a dirty page is written out, if logging is enabled.
+   * @param page the page about to be written to disk
+   */
+  void FlushLogForPage(Page *page);
+
   /**
    * Allocate a page on disk.∂
    * @return the id of the allocated page
@@ -137,7 +143,7 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
   /** Page table for keeping track of buffer pool pages. */
   std::unordered_map<page_id_t, frame_id_t> page_table_;
   /** Replacer to find unpinned pages for replacement. */
@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -21,8 +23,13 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/adaptive_radix_tree_index.h"
+#include "storage/index/b_epsilon_tree_index.h"
+#include "storage/index/b_link_tree_index.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
+#include "storage/table/lsm_table.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -34,6 +41,26 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/**
+ * The kinds of index that the catalog can create. A NonUniqueBPlusTreeIndex keeps every entry of a key, its KeyType
+ * must be KEY_RID_SIZE bytes wider than the key. A BEpsilonTreeIndex buffers its writes, for insert heavy indexes. An
+ * AdaptiveRadixTreeIndex lives in memory only, for hot indexes that fit in it, and is rebuilt with RebuildIndexes.
+ */
+enum class IndexType {
+  HashTableIndex,
+  BPlusTreeIndex,
+  BLinkTreeIndex,
+  NonUniqueBPlusTreeIndex,
+  BEpsilonTreeIndex,
+  AdaptiveRadixTreeIndex
+};
+
+/**
+ * The kinds of table that the catalog can create. An LsmTable buffers its writes in memory and writes them out as
+ * sorted runs, for append heavy tables such as event logs. It is not persistent and goes away with the process.
+ */
+enum class TableType { TableHeap, LsmTable };
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -90,6 +117,8 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** Creates a new, empty index of the same kind and key, used when the index is rebuilt from its table */
+  std::function<std::unique_ptr<Index>()> make_empty_index_;
 };
 
 /**
@@ -119,15 +148,22 @@ class Catalog {
    * @param txn The transaction in which the table is being created
    * @param table_name The name of the new table
    * @param schema The schema of the new table
+   * @param table_type The kind of table to create
    * @return A (non-owning) pointer to the metadata for the table
    */
-  TableInfo *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema) {
+  TableInfo *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                         TableType table_type = TableType::TableHeap) {
     if (table_names_.count(table_name) != 0) {
       return NULL_TABLE_INFO;
     }
 
     // Construct the table heap
-    auto table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
+    std::unique_ptr<TableHeap> table;
+    if (table_type == TableType::LsmTable) {
+      table = std::make_unique<LsmTable>(bpm_, lock_manager_, log_manager_);
+    } else {
+      table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
+    }
 
     // Fetch the table OID for the new table
     const auto table_oid = next_table_oid_.fetch_add(1);
@@ -186,12 +222,15 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param index_type The kind of index to create
+   * @param pinned_levels The number of top levels of a B+ tree index whose internal pages stay pinned
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         std::size_t keysize, HashFunction<KeyType> hash_function) {
+                         std::size_t keysize, HashFunction<KeyType> hash_function,
+                         IndexType index_type = IndexType::HashTableIndex, int pinned_levels = 0) {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -207,22 +246,36 @@ class Catalog {
       return NULL_INDEX_INFO;
     }
 
-    // Construct index metdata
-    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
-
-    // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-    auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
-                                                                                               hash_function);
-
-    // Populate the index with all tuples in table heap
+    // Construct the index, the index takes ownership of its metadata
+    auto make_empty_index = [this, index_name, table_name, schema, key_attrs, hash_function, index_type,
+                             pinned_levels]() -> std::unique_ptr<Index> {
+      auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+      if (index_type == IndexType::BPlusTreeIndex || index_type == IndexType::NonUniqueBPlusTreeIndex) {
+        return std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(
+            std::move(meta), bpm_, index_type == IndexType::BPlusTreeIndex, pinned_levels);
+      }
+      if (index_type == IndexType::BLinkTreeIndex) {
+        return std::make_unique<BLinkTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+      }
+      if (index_type == IndexType::BEpsilonTreeIndex) {
+        return std::make_unique<BEpsilonTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+      }
+      if (index_type == IndexType::AdaptiveRadixTreeIndex) {
+        return std::make_unique<AdaptiveRadixTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta));
+      }
+      return std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                           hash_function);
+    };
+    auto index = make_empty_index();
+
+    // Populate the index with all tuples in table heap, as one batch so that a tree index is bulk loaded
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
+    std::vector<std::pair<Tuple, RID>> entries;
     for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+      entries.emplace_back(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid());
     }
+    index->InsertEntries(&entries, txn);
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
@@ -230,6 +283,7 @@ class Catalog {
     // Construct index information; IndexInfo takes ownership of the Index itself
     auto index_info =
         std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    index_info->make_empty_index_ = std::move(make_empty_index);
     auto *tmp = index_info.get();
 
     // Update internal tracking
@@ -322,6 +376,18 @@ class Catalog {
     return indexes;
   }
 
+  /**
+   * Rebuild every index from the current contents of its table. Index pages are not logged, so this is how
+   * indexes are brought back in sync with the tables after a restart or recovery.
+   *
+   * The pages of each table are scanned in parallel, extracting the keys of all of its indexes at once, and the
+   * indexes are then built concurrently from their keys (a B+ tree is built bottom-up from the sorted keys).
+   * No transaction may run while the indexes are rebuilt, and pointers to the old indexes become invalid.
+   * @param txn The transaction in which the indexes are rebuilt
+   * @param num_threads The number of threads that scan tables and build indexes
+   */
+  void RebuildIndexes(Transaction *txn, size_t num_threads = std::thread::hardware_concurrency());
+
  private:
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
@@ -27,6 +27,12 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/**
+ * If ENABLE_ASYNC_COMMIT is true, new transactions commit without waiting for their COMMIT record to reach disk. The
+ * flush thread makes them durable within LOG_TIMEOUT, a crash in between loses them.
+ */
+extern std::atomic<bool> enable_async_commit;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
@@ -34,7 +40,14 @@ static constexpr int HEADER_PAGE_ID = 0;                                      //
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
+static constexpr int LOG_SEGMENT_SIZE = 16 * LOG_BUFFER_SIZE;                 // size of a log segment file in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int BULK_LOAD_RUN_SIZE = 1 << 16;                            // entries sorted in memory per bulk load run
+static constexpr int KEY_SEARCH_SCAN_SIZE = 32;                               // keys left to a SIMD scan by a key search
+static constexpr int INDEX_SCAN_PREFETCH_SIZE = 4;                            // leaves pinned ahead of a range scan
+static constexpr int LSM_MEMTABLE_SIZE = 1 << 20;                             // bytes an lsm table buffers per flush
+static constexpr int LSM_LEVEL0_RUNS = 4;                                     // flushed runs that start a compaction
+static constexpr int LSM_LEVEL_SIZE_RATIO = 10;                               // growth factor between lsm levels
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
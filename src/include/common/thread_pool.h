@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_pool.h
+//
+// Identification: src/include/common/thread_pool.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <queue>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ThreadPool runs submitted tasks on a fixed set of worker threads, in submission order.
+ * Tasks must not block on the completion of other tasks of the same pool.
+ */
+class ThreadPool {
+ public:
+  /**
+   * Creates a new thread pool.
+   * @param num_threads the number of worker threads, at least one worker is always started
+   */
+  explicit ThreadPool(size_t num_threads);
+
+  /** Runs the tasks that are still queued, then joins the workers. */
+  ~ThreadPool();
+
+  DISALLOW_COPY_AND_MOVE(ThreadPool);
+
+  /**
+   * Queues a task for execution.
+   * @param task the task to run
+   * @return a future that becomes ready when the task has finished, and rethrows any exception the task threw
+   */
+  std::future<void> Submit(std::function<void()> task);
+
+  /** @return the number of worker threads */
+  size_t GetNumThreads() const { return workers_.size(); }
+
+ private:
+  /** The loop run by every worker, pops and runs tasks until shutdown. */
+  void RunWorker();
+
+  /** Protects tasks_ and shutdown_. */
+  std::mutex latch_;
+  /** Signalled when a task is queued or the pool shuts down. */
+  std::condition_variable cv_;
+  std::queue<std::packaged_task<void()>> tasks_;
+  bool shutdown_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
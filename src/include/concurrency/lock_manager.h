@@ -15,6 +15,7 @@
 #include <algorithm>
 #include <condition_variable>  // NOLINT
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_map>
@@ -51,6 +52,8 @@ class LockManager {
     std::condition_variable cv_;
     // txn_id of an upgrading transaction (if any)
     txn_id_t upgrading_ = INVALID_TXN_ID;
+    // COMMIT record of the last transaction that released its exclusive lock early, possibly not flushed yet
+    lsn_t released_commit_lsn_ = INVALID_LSN;
   };
 
  public:
@@ -100,15 +103,29 @@ class LockManager {
    * @param txn the transaction releasing the lock, it should actually hold the
    * lock
    * @param rid the RID that is locked by the transaction
+   * @param commit_lsn the COMMIT record of txn when it releases its locks before that record is flushed. Later
+   * transactions that lock rid inherit it as a commit dependency, see Transaction::GetCommitDependencyLSN().
    * @return true if the unlock is successful, false otherwise
    */
-  bool Unlock(Transaction *txn, const RID &rid);
+  bool Unlock(Transaction *txn, const RID &rid, lsn_t commit_lsn = INVALID_LSN);
+
+  /**
+   * Forget the early released commits that are on disk by now, a transaction that locks their rids later has nothing
+   * left to wait for. Keeps the lock table from growing with every rid ever written.
+   * @param persistent_lsn the last log sequence number on disk
+   */
+  void ForgetDurableCommits(lsn_t persistent_lsn);
 
  private:
+  /** Makes txn depend on the commit of whoever released rid early. Must hold latch_. */
+  void InheritCommitDependency(Transaction *txn, const RID &rid);
+
   std::mutex latch_;
 
   /** Lock table for lock requests. */
   std::unordered_map<RID, LockRequestQueue> lock_table_;
+  /** The rids released early, by the COMMIT record they were released with. */
+  std::multimap<lsn_t, RID> released_rids_;
 };
 
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <memory>
@@ -154,6 +155,7 @@ class Transaction {
         thread_id_(std::this_thread::get_id()),
         txn_id_(txn_id),
         prev_lsn_(INVALID_LSN),
+        async_commit_(enable_async_commit),
         shared_lock_set_{new std::unordered_set<RID>},
         exclusive_lock_set_{new std::unordered_set<RID>} {
     // Initialize the sets that will be tracked.
@@ -246,6 +248,26 @@ class Transaction {
    */
   inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
 
+  /** @return true if the commit of this transaction does not wait for the log flush */
+  inline bool IsAsyncCommit() const { return async_commit_; }
+
+  /**
+   * Set whether the commit of this transaction waits for its COMMIT record to be flushed.
+   * @param async_commit true to return from the commit as soon as the COMMIT record is in the log buffer
+   */
+  inline void SetAsyncCommit(bool async_commit) { async_commit_ = async_commit; }
+
+  /** @return the latest COMMIT record of the early-released transactions whose data this transaction has locked */
+  inline lsn_t GetCommitDependencyLSN() const { return commit_dependency_lsn_; }
+
+  /**
+   * Make the commit of this transaction depend on another commit.
+   * @param commit_lsn the COMMIT record that has to be flushed before this transaction's commit is acknowledged
+   */
+  inline void AddCommitDependency(lsn_t commit_lsn) {
+    commit_dependency_lsn_ = std::max(commit_dependency_lsn_, commit_lsn);
+  }
+
  private:
   /** The current transaction state. */
   TransactionState state_;
@@ -262,6 +284,10 @@ class Transaction {
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
   /** The LSN of the last record written by the transaction. */
   lsn_t prev_lsn_;
+  /** True if the commit does not wait for the log flush, defaults to ENABLE_ASYNC_COMMIT. */
+  bool async_commit_;
+  /** The COMMIT record this transaction depends on because of early lock release. */
+  lsn_t commit_dependency_lsn_{INVALID_LSN};
 
   /** Concurrent index: the pages that were latched during index operation. */
   std::shared_ptr<std::deque<Page *>> page_set_;
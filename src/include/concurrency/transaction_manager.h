@@ -44,7 +44,7 @@ class TransactionManager {
   Transaction *Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ);
 
   /**
-   * Commits a transaction.
+   * Commits a transaction. Unless the transaction commits asynchronously, this returns only once the commit is durable.
    * @param txn the transaction to commit
    */
   void Commit(Transaction *txn);
@@ -87,8 +87,9 @@ class TransactionManager {
   /**
    * Releases all the locks held by the given transaction.
    * @param txn the transaction whose locks should be released
+   * @param commit_lsn the COMMIT record of txn if it may not have been flushed yet
    */
-  void ReleaseLocks(Transaction *txn) {
+  void ReleaseLocks(Transaction *txn, lsn_t commit_lsn = INVALID_LSN) {
     std::unordered_set<RID> lock_set;
     for (auto item : *txn->GetExclusiveLockSet()) {
       lock_set.emplace(item);
@@ -97,13 +98,13 @@ class TransactionManager {
       lock_set.emplace(item);
     }
     for (auto locked_rid : lock_set) {
-      lock_manager_->Unlock(txn, locked_rid);
+      lock_manager_->Unlock(txn, locked_rid, commit_lsn);
     }
   }
 
   std::atomic<txn_id_t> next_txn_id_{0};
-  LockManager *lock_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
+  LockManager *lock_manager_;
+  LogManager *log_manager_;
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
@@ -30,6 +30,15 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * Lookups, inserts and removes read latch the directory and latch the page of
+ * their bucket only, so that they run concurrently unless they meet in a
+ * bucket. Splits and merges write latch the directory.
+ *
+ * The directory is a tree of directory pages. Once a directory page is full, a
+ * bucket that needs to split once more is moved into a child directory page,
+ * which takes its slot and indexes by the hash bits above those of the page,
+ * so the global depth is only bounded by the 32 bits of the hash.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class ExtendibleHashTable {
@@ -75,7 +84,13 @@ class ExtendibleHashTable {
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result);
 
   /**
-   * Returns the global depth.  Do not touch.
+   * Deletes every page of the hash table, which must not be used afterwards.
+   */
+  void Destroy();
+
+  /**
+   * Returns the global depth, that is the number of hash bits the deepest directory page and the ones above it index
+   * by.  Do not touch.
    */
   uint32_t GetGlobalDepth();
 
@@ -100,11 +115,12 @@ class ExtendibleHashTable {
    * In Extendible Hashing we map a key to a directory index
    * using the following hash + mask function.
    *
-   * DirectoryIndex = Hash(key) & GLOBAL_DEPTH_MASK
+   * DirectoryIndex = (Hash(key) >> PARENT_DEPTH) & GLOBAL_DEPTH_MASK
    *
    * where GLOBAL_DEPTH_MASK is a mask with exactly GLOBAL_DEPTH 1's from LSB
    * upwards.  For example, global depth 3 corresponds to 0x00000007 in a 32-bit
-   * representation.
+   * representation. PARENT_DEPTH is the number of bits taken by the directory
+   * pages above dir_page.
    *
    * @param key the key to use for lookup
    * @param dir_page to use for lookup of global depth
@@ -128,6 +144,24 @@ class ExtendibleHashTable {
    */
   HashTableDirectoryPage *FetchDirectoryPage();
 
+  /**
+   * Fetches the directory page whose slots hold the bucket of a key, walking down from the root directory page.
+   *
+   * @param key the key for lookup
+   * @param[out] parent_page_id if not null, the page id of the directory page above it, INVALID_PAGE_ID for the root
+   * @return a pointer to the directory page
+   */
+  HashTableDirectoryPage *FetchDirectoryPage(const KeyType &key, page_id_t *parent_page_id = nullptr);
+
+  /**
+   * Calls visit on a directory page and on every directory page below it, while they are pinned.
+   *
+   * @param dir_page_id the page id of the directory page to start from
+   * @param visit the function to call with each directory page
+   */
+  template <typename Visitor>
+  void VisitDirectoryPages(page_id_t dir_page_id, Visitor visit);
+
   /**
    * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
    *
@@ -152,11 +186,15 @@ class ExtendibleHashTable {
    * Optionally merges an empty bucket into it's pair.  This is called by Remove,
    * if Remove makes a bucket empty.
    *
-   * There are three conditions under which we skip the merge:
+   * There are four conditions under which we skip the merge:
    * 1. The bucket is no longer empty.
    * 2. The bucket has local depth 0.
    * 3. The bucket's local depth doesn't match its split image's local depth.
-   * 
+   * 4. The split image is a child directory page.
+   *
+   * A child directory page that is left with a single bucket gives the bucket
+   * back to its parent.
+   *
    * Note: we do not merge recursively.
    *
    * @param transaction a pointer to the current transaction
@@ -164,7 +202,6 @@ class ExtendibleHashTable {
    * @param value the value that was removed
    */
   void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
-  bool MergeMain(page_id_t page_id,uint32_t bucket_index);
 
   // member variables
   page_id_t directory_page_id_;
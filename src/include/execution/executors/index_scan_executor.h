@@ -12,21 +12,31 @@
 
 #pragma once
 
+#include <optional>
 #include <vector>
 
+#include "catalog/catalog.h"
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
  * IndexScanExecutor executes an index scan over a table.
+ *
+ * The scan runs over a B+ tree index of 8 byte keys. A predicate that compares the single key column with a constant
+ * bounds the range of keys that is scanned, any other predicate is only applied to the tuples of a full scan.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
+  using KeyType = GenericKey<8>;
+  using TreeIndex = BPlusTreeIndex<KeyType, RID, GenericComparator<8>>;
+  using TreeIterator = IndexIterator<KeyType, RID, GenericComparator<8>>;
+
  public:
   /**
    * Creates a new index scan executor.
@@ -42,7 +52,22 @@ class IndexScanExecutor : public AbstractExecutor {
   bool Next(Tuple *tuple, RID *rid) override;
 
  private:
+  /** Narrows the scanned range of keys down to the ones that can satisfy predicate. */
+  void NarrowRange(const AbstractExpression *predicate);
+
+  /** @return the index key of a single key column holding value */
+  KeyType KeyOf(const Value &value) const;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** The index scanned and the table its RIDs point into. */
+  IndexInfo *index_info_{nullptr};
+  TableInfo *table_info_{nullptr};
+  /** The bounds of the scanned range, an unset bound is open. */
+  std::optional<KeyType> lower_;
+  bool lower_inclusive_{true};
+  std::optional<KeyType> upper_;
+  bool upper_inclusive_{true};
+  TreeIterator iterator_;
 };
 }  // namespace bustub
@@ -16,6 +16,7 @@
 #include <condition_variable>  // NOLINT
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -28,11 +29,11 @@ namespace bustub {
  */
 class LogManager {
  public:
-  explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
-  }
+  /**
+   * Creates a log manager that continues the log on disk.
+   * @param disk_manager the disk manager that holds the log
+   */
+  explicit LogManager(DiskManager *disk_manager);
 
   ~LogManager() {
     delete[] log_buffer_;
@@ -46,13 +47,33 @@ class LogManager {
 
   lsn_t AppendLogRecord(LogRecord *log_record);
 
+  /**
+   * Blocks until every log record up to and including lsn is on disk, forcing a flush instead of waiting for the
+   * timeout. Used by commits and by the buffer pool before it writes out a page (write-ahead rule).
+   * @param lsn the log sequence number that has to be persistent, clamped to the last appended record
+   */
+  void FlushUntil(lsn_t lsn);
+
+  /**
+   * Recycles the log segments that lie entirely before the end of the flushed log. Only safe once every dirty page has
+   * been written out while no transaction is running, i.e. during a checkpoint.
+   */
+  void TruncateLog();
+
   inline lsn_t GetNextLSN() { return next_lsn_; }
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline char *GetLogBuffer() { return log_buffer_; }
 
  private:
-  // TODO(students): you may add your own member variables
+  /**
+   * Swaps the two buffers and writes out everything appended so far. The latch is released during the disk write so
+   * that appends can continue into the other buffer. Only one thread may flush at a time.
+   * @param lock the held lock on latch_
+   */
+  void FlushBuffer(std::unique_lock<std::mutex> *lock);
+  /** Serializes the log record into the log buffer at offset_, the record must fit. */
+  void SerializeLogRecord(const LogRecord &log_record);
 
   /** The atomic counter which records the next log sequence number. */
   std::atomic<lsn_t> next_lsn_;
@@ -61,14 +82,26 @@ class LogManager {
 
   char *log_buffer_;
   char *flush_buffer_;
+  /** The number of bytes used in log_buffer_. */
+  int offset_{0};
+  /** The position of the end of log_buffer_ within its log segment, records never cross a segment boundary. */
+  int segment_offset_{0};
 
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread *flush_thread_{nullptr};
+  bool flush_thread_running_{false};
+  /** Set when someone waits on a flush, it wakes the flush thread before the timeout. */
+  bool flush_requested_{false};
+  /** True while a flush is writing flush_buffer_ without holding latch_. */
+  bool flushing_{false};
 
+  /** Wakes the flush thread. */
   std::condition_variable cv_;
+  /** Notified after every flush, threads waiting for buffer space or durability wait on it. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <cassert>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/table/tuple.h"
@@ -32,6 +33,8 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** An update that only logs the byte ranges in which the old and the new tuple differ. */
+  DELTAUPDATE,
 };
 
 /**
@@ -57,6 +60,11 @@ enum class LogRecordType {
  *--------------------------
  * | HEADER | prev_page_id |
  *--------------------------
+ * For delta update type log record, every range holds old ^ new over [offset, offset + length), where the shorter
+ * tuple is treated as zero-padded. Applying the ranges to either version of the tuple yields the other one.
+ *----------------------------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | old_size | new_size | range_count | offset | length | xor_data(char[]) | ... |
+ *----------------------------------------------------------------------------------------------------
  */
 class LogRecord {
   friend class LogManager;
@@ -85,17 +93,25 @@ class LogRecord {
     size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
   }
 
-  // constructor for UPDATE type
+  // constructor for UPDATE/DELTAUPDATE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &update_rid,
             const Tuple &old_tuple, const Tuple &new_tuple)
-      : txn_id_(txn_id),
-        prev_lsn_(prev_lsn),
-        log_record_type_(log_record_type),
-        update_rid_(update_rid),
-        old_tuple_(old_tuple),
-        new_tuple_(new_tuple) {
-    // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
+      : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type), update_rid_(update_rid) {
+    if (log_record_type == LogRecordType::UPDATE) {
+      old_tuple_ = old_tuple;
+      new_tuple_ = new_tuple;
+      size_ = FullUpdateSize(old_tuple, new_tuple);
+    } else {
+      assert(log_record_type == LogRecordType::DELTAUPDATE);
+      old_size_ = old_tuple.GetLength();
+      new_size_ = new_tuple.GetLength();
+      ComputeDelta(old_tuple, new_tuple);
+      // calculate log record size
+      size_ = HEADER_SIZE + sizeof(RID) + 3 * sizeof(int32_t);
+      for (const auto &range : delta_ranges_) {
+        size_ += 2 * sizeof(int32_t) + range.data_.size();
+      }
+    }
   }
 
   // constructor for NEWPAGE type
@@ -112,6 +128,11 @@ class LogRecord {
 
   ~LogRecord() = default;
 
+  /** @return the size of an UPDATE record that logs both tuples in full */
+  static int32_t FullUpdateSize(const Tuple &old_tuple, const Tuple &new_tuple) {
+    return HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
+  }
+
   inline Tuple &GetDeleteTuple() { return delete_tuple_; }
 
   inline RID &GetDeleteRID() { return delete_rid_; }
@@ -128,6 +149,13 @@ class LogRecord {
 
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  /**
+   * Applies a DELTAUPDATE record to one version of the updated tuple.
+   * @param tuple the tuple as it is currently stored, either the old or the new version
+   * @return the other version of the tuple, i.e. the new one when given the old one and vice versa
+   */
+  Tuple ApplyDelta(const Tuple &tuple) const;
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -176,6 +204,19 @@ class LogRecord {
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
+
+  // case5: for delta update operation, shares update_rid_ with case3
+  struct DeltaRange {
+    uint32_t offset_;
+    std::string data_;
+  };
+  uint32_t old_size_{0};
+  uint32_t new_size_{0};
+  std::vector<DeltaRange> delta_ranges_;
+
+  /** Fills delta_ranges_ with the XOR of the two tuples over every byte range in which they differ. */
+  void ComputeDelta(const Tuple &old_tuple, const Tuple &new_tuple);
+
   static const int HEADER_SIZE = 20;
 };  // namespace bustub
 
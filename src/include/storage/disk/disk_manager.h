@@ -17,6 +17,7 @@
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
 
@@ -25,6 +26,12 @@ namespace bustub {
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * The log is stored in preallocated, zero-filled segment files <db>.log.<n> of LOG_SEGMENT_SIZE bytes each. Log
+ * offsets are logical and 64 bits wide, since segment numbers keep growing as segments are recycled: offset o lives in
+ * segment o / LOG_SEGMENT_SIZE. Every run of the database starts writing at the
+ * beginning of the segment that follows the last non-empty one, and segments made obsolete by a checkpoint are
+ * recycled as future segments instead of being deleted.
  */
 class DiskManager {
  public:
@@ -63,13 +70,28 @@ class DiskManager {
   void WriteLog(char *log_data, int size);
 
   /**
-   * Read a log entry from the log file.
+   * Read a log entry from the log file. A read never extends past the end of the segment containing offset, the rest
+   * of the output buffer is zero filled.
    * @param[out] log_data output buffer
    * @param size size of the log entry
-   * @param offset offset of the log entry in the file
+   * @param offset logical offset of the log entry
    * @return true if the read was successful, false otherwise
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  bool ReadLog(char *log_data, int size, int64_t offset);
+
+  /** @return the logical offset of the oldest log segment still on disk, recovery starts scanning there */
+  int64_t GetLogStartOffset();
+
+  /** @return the logical offset at which the next log write will land */
+  int64_t GetLogWriteOffset();
+
+  /**
+   * Recycles every log segment that lies entirely before offset. Recycled segments are renamed to become future
+   * segments and zero filled again, so that appending to them later does not change any file metadata. The segment
+   * holding the last record is always kept, the next run continues its LSNs from there.
+   * @param offset logical log offset before which no record is needed anymore
+   */
+  void RecycleLogSegments(int64_t offset);
 
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
@@ -91,9 +113,21 @@ class DiskManager {
 
  private:
   int GetFileSize(const std::string &file_name);
-  // stream to write log file
+  /** @return the file name of the given log segment */
+  std::string GetLogSegmentName(int segment) const;
+  /** @return the numbers of all log segments on disk, in ascending order */
+  std::vector<int> ListLogSegments() const;
+  /** Creates the given log segment, zero filled to LOG_SEGMENT_SIZE bytes. */
+  void PreallocateLogSegment(const std::string &segment_name);
+  // stream to write the current log segment
   std::fstream log_io_;
   std::string log_name_;
+  // the segment log_io_ is open on, -1 if none
+  int log_segment_{-1};
+  // logical offset of the next log write
+  int64_t log_write_offset_{0};
+  // protects the log segment files
+  std::mutex log_io_latch_;
   // stream to write db file
   std::fstream db_io_;
   std::string file_name_;
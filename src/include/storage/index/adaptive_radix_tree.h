@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/adaptive_radix_tree.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rwlatch.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define ADAPTIVERADIXTREE_TYPE AdaptiveRadixTree<KeyType, ValueType, KeyComparator>
+
+// the bytes of a compressed path that a node keeps, the rest of a longer path is read from a leaf below the node
+static constexpr uint32_t ART_PREFIX_SIZE = 8;
+
+/**
+ * Adaptive radix tree, an in-memory index that never touches the buffer pool.
+ *
+ * The tree branches on one byte of the key per level, so KeyType must be binary comparable, as GenericKey is: its
+ * sizeof(KeyType) bytes compare with memcmp as the keys do, and the comparator is not used. An inner node has room for
+ * 4, 16, 48 or 256 children and grows and shrinks between these sizes as children come and go. A path of inner nodes
+ * with a single child each is collapsed into the prefix of the node below it, and a subtree with a single key is a
+ * leaf, so that the height stays below the key size.
+ * (1) We only support unique key
+ * (2) Scans collect their entries in key order, as the tree is not on pages an iterator could hold
+ * (3) Writers hold the tree latch exclusively, readers share it
+ * The tree is lost with the process, the catalog builds it anew from the table at startup.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class AdaptiveRadixTree {
+ public:
+  explicit AdaptiveRadixTree(const KeyComparator &comparator);
+  ~AdaptiveRadixTree();
+
+  DISALLOW_COPY_AND_MOVE(AdaptiveRadixTree);
+
+  // Returns true if this tree has no keys and values.
+  bool IsEmpty();
+
+  // Insert a key-value pair into this tree.
+  bool Insert(const KeyType &key, const ValueType &value);
+
+  // Insert key-value pairs in any order under a single latch, returns the number inserted.
+  int InsertBatch(const std::vector<MappingType> &items);
+
+  // Remove a key and its value from this tree.
+  void Remove(const KeyType &key);
+
+  // return the value associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> *result);
+
+  /**
+   * Append the entries from lower to upper to result, in key order. A bound is included if its flag is set and leaves
+   * its end of the range open if it is null.
+   */
+  void ScanRange(const KeyType *lower, bool lower_inclusive, const KeyType *upper, bool upper_inclusive,
+                 std::vector<MappingType> *result);
+
+ private:
+  enum class NodeType : uint8_t { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+  struct Node {
+    explicit Node(NodeType type) : type_(type) {}
+    NodeType type_;
+    uint16_t num_children_{0};
+    // the length of the compressed path above the children, of which the first ART_PREFIX_SIZE bytes are kept
+    uint32_t prefix_size_{0};
+    uint8_t prefix_[ART_PREFIX_SIZE];
+  };
+
+  struct Leaf : Node {
+    Leaf(const KeyType &key, const ValueType &value) : Node(NodeType::LEAF), key_(key), value_(value) {}
+    KeyType key_;
+    ValueType value_;
+  };
+
+  // the key bytes of the children of a Node4 and a Node16 are sorted
+  struct Node4 : Node {
+    Node4() : Node(NodeType::NODE4) {}
+    uint8_t keys_[4];
+    Node *children_[4];
+  };
+
+  struct Node16 : Node {
+    Node16() : Node(NodeType::NODE16) {}
+    uint8_t keys_[16];
+    Node *children_[16];
+  };
+
+  // a Node48 maps a key byte to one plus the index of its child, 0 for none
+  struct Node48 : Node {
+    Node48() : Node(NodeType::NODE48) {}
+    uint8_t child_index_[256]{};
+    Node *children_[48]{};
+  };
+
+  struct Node256 : Node {
+    Node256() : Node(NodeType::NODE256) {}
+    Node *children_[256]{};
+  };
+
+  static constexpr uint32_t KEY_SIZE = sizeof(KeyType);
+
+  static const uint8_t *Bytes(const KeyType &key) { return reinterpret_cast<const uint8_t *>(&key); }
+
+  static void FreeNode(Node *node);
+
+  static Node **FindChild(Node *node, uint8_t byte);
+
+  static Leaf *Minimum(Node *node);
+
+  // copies the prefix and the number of children into a node of another size
+  static void CopyHeader(Node *to, const Node *from);
+
+  // adds child at byte, growing the node at *ref into the next size when it is full
+  static void AddChild(Node **ref, uint8_t byte, Node *child);
+
+  // removes the child at *child_ref, shrinking the node at *ref when few enough children are left
+  static void RemoveChild(Node **ref, uint8_t byte, Node **child_ref);
+
+  // the number of bytes the prefix of node shares with key from depth on
+  static uint32_t PrefixMismatch(Node *node, const uint8_t *key, uint32_t depth);
+
+  bool InsertAt(Node **ref, const KeyType &key, const ValueType &value, uint32_t depth);
+
+  bool RemoveAt(Node **ref, const KeyType &key, uint32_t depth);
+
+  // scans the subtree, the bounds are only looked at while the path to node equals their first depth bytes
+  void ScanBelow(Node *node, uint32_t depth, const uint8_t *lower, bool lower_inclusive, const uint8_t *upper,
+                 bool upper_inclusive, std::vector<MappingType> *result) const;
+
+  // member variable
+  Node *root_{nullptr};
+  // taken shared by point queries and scans and exclusively by writers
+  ReaderWriterLatch latch_;
+  KeyComparator comparator_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/adaptive_radix_tree_index.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/index/adaptive_radix_tree.h"
+#include "storage/index/index.h"
+
+namespace bustub {
+
+#define ADAPTIVERADIXTREE_INDEX_TYPE AdaptiveRadixTreeIndex<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class AdaptiveRadixTreeIndex : public Index {
+ public:
+  explicit AdaptiveRadixTreeIndex(std::unique_ptr<IndexMetadata> &&metadata);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  void InsertEntries(std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) override;
+
+  // range scan from lower to upper, a null bound leaves its end open
+  void ScanRange(const KeyType *lower, bool lower_inclusive, const KeyType *upper, bool upper_inclusive,
+                 std::vector<RID> *result);
+
+ protected:
+  // comparator for key
+  KeyComparator comparator_;
+  // container
+  AdaptiveRadixTree<KeyType, ValueType, KeyComparator> container_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,163 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/b_epsilon_tree.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/rwlatch.h"
+#include "concurrency/transaction.h"
+#include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+
+namespace bustub {
+
+#define BEPSILONTREE_TYPE BEpsilonTree<KeyType, ValueType, KeyComparator>
+
+/**
+ * A pending insert or delete of a key, buffered in an internal page until it is flushed to the leaf of the key.
+ */
+template <typename KeyType, typename ValueType>
+struct BEpsilonMessage {
+  KeyType key_;
+  // the value to put, meaningless for a delete
+  ValueType value_;
+  bool is_insert_;
+};
+
+// half of an internal page goes to the message buffer, which starts with its size, the pivots take the other half
+// whatever their keys
+#define BEPSILON_BUFFER_SIZE \
+  (((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / 2 - sizeof(int)) / sizeof(BEpsilonMessage<KeyType, ValueType>))
+#define BEPSILON_INTERNAL_PAGE_SIZE \
+  ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / 2 / (sizeof(uint16_t) + sizeof(KeyType) + sizeof(page_id_t)))
+
+/**
+ * B-epsilon tree, a write optimized alternative to BPlusTree on the same page layouts.
+ *
+ * Each internal page keeps the back of the page as a buffer of messages, sorted by key with at most one message per
+ * key. Inserts and deletes are put into the buffer of the root as messages, and once a buffer is full the messages
+ * headed to its busiest child move down in a batch, into the buffer of an internal child or onto a leaf. A write thus
+ * costs a fraction of a page write, and the leaves are written once per batch. Since the messages higher up are the
+ * newer ones, a point query takes the first message for its key it finds on the way down. A scan reads one leaf at a
+ * time and merges the messages for its keys from the buffers on the way down into the entries of the leaf.
+ * (1) We only support unique key, an insert of a key that is already there fails, which costs it a point query
+ * (2) Nodes are not merged, a leaf emptied by deletes stays in the tree
+ * (3) Writers hold the tree latch exclusively, readers share it, a scan for as long as it reads a leaf
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BEpsilonTree {
+  using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  using Message = BEpsilonMessage<KeyType, ValueType>;
+
+ public:
+  /**
+   * A scan over the entries of the tree in key order, which holds a copy of the entries of one leaf at a time, with the
+   * buffered messages for them applied. The tree must outlive it.
+   */
+  class Iterator {
+   public:
+    bool IsEnd() const { return index_ == items_.size() && !has_next_; }
+
+    const MappingType &operator*() const { return items_[index_]; }
+
+    Iterator &operator++();
+
+   private:
+    friend class BEpsilonTree;
+
+    // moves on to the next leaf that has entries, if the iterator is past the entries of the current one
+    void SkipExhaustedLeaves();
+
+    BEpsilonTree *tree_{nullptr};
+    // the entries of the current leaf, and the first key of the leaf after it if there is one
+    std::vector<MappingType> items_;
+    size_t index_{0};
+    bool has_next_{false};
+    KeyType next_key_;
+  };
+
+  explicit BEpsilonTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                        int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = BEPSILON_INTERNAL_PAGE_SIZE,
+                        int buffer_size = BEPSILON_BUFFER_SIZE);
+
+  // Returns true if no key was ever inserted into this B-epsilon tree.
+  bool IsEmpty();
+
+  // Insert a key-value pair into this B-epsilon tree, unless the key is there already.
+  bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Remove a key and its value from this B-epsilon tree.
+  void Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // Delete every page of this B-epsilon tree, which is left empty.
+  void Clear();
+
+  // return the value associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
+
+  // Move every buffered message down to the leaves.
+  void Flush();
+
+  // scan from the first key, resp. from the first key not below key
+  Iterator Begin();
+  Iterator Begin(const KeyType &key);
+
+ private:
+  // the number of messages in the buffer of an internal page, and the messages themselves
+  int &BufferSize(Page *page) const;
+  Message *Messages(Page *page) const;
+  // the bytes at the back of an internal page that its buffer takes, with its size
+  int BufferBytes() const;
+
+  // the index of the first message of page whose key is not below key
+  int MessageIndex(Page *page, const KeyType &key) const;
+
+  void Put(const Message &message);
+
+  void PutInto(Page *page, const Message &message);
+
+  void FlushOnce(Page *page);
+
+  int ApplyToLeaf(InternalPage *parent, Page *leaf_page, const Message *messages, int count);
+
+  bool LeafIsFull(LeafPage *leaf, const Message &message) const;
+
+  void FlushAll();
+
+  Page *GrowRoot(Page *root_page);
+
+  void SplitChild(InternalPage *parent, Page *page);
+
+  bool Lookup(const KeyType &key, ValueType *value);
+
+  // copies the entries from key on of the leaf that covers key into items and tells where the next leaf starts
+  bool ReadLeaf(const KeyType &key, bool left_most, std::vector<MappingType> *items, KeyType *next_key);
+
+  void StartNewTree(const KeyType &key, const ValueType &value);
+
+  void UpdateRootPageId(int insert_record = 0);
+
+  // member variable
+  std::string index_name_;
+  page_id_t root_page_id_;
+  // taken shared by point queries and exclusively by writers and flushes
+  ReaderWriterLatch latch_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  int leaf_max_size_;
+  int internal_max_size_;
+  int buffer_size_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/b_epsilon_tree_index.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/index/b_epsilon_tree.h"
+#include "storage/index/index.h"
+
+namespace bustub {
+
+#define BEPSILONTREE_INDEX_TYPE BEpsilonTreeIndex<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class BEpsilonTreeIndex : public Index {
+ public:
+  BEpsilonTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  void Destroy(Transaction *transaction) override;
+
+  typename BEpsilonTree<KeyType, ValueType, KeyComparator>::Iterator GetBeginIterator();
+
+  typename BEpsilonTree<KeyType, ValueType, KeyComparator>::Iterator GetBeginIterator(const KeyType &key);
+
+ protected:
+  // comparator for key
+  KeyComparator comparator_;
+  // container
+  BEpsilonTree<KeyType, ValueType, KeyComparator> container_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/b_link_tree.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "concurrency/transaction.h"
+#include "storage/index/index_iterator.h"
+#include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+
+namespace bustub {
+
+#define BLINKTREE_TYPE BLinkTree<KeyType, ValueType, KeyComparator>
+
+/**
+ * The B-link fields of a node. They are kept at the end of the page, behind the entries of the usual B+ tree leaf or
+ * internal page layout. A leaf leaves them out of its room, the max size of an internal page is lowered for them.
+ */
+template <typename KeyType>
+struct BLinkTrailer {
+  // exclusive upper bound of the keys that belong to the node, meaningless if has_high_key_ is false
+  KeyType high_key_;
+  // next node on the same level, INVALID_PAGE_ID for the right most node
+  page_id_t right_page_id_;
+  // height of the node above the leaves, 0 for a leaf
+  int level_;
+  // false for the right most node of a level, whose keys are unbounded
+  bool has_high_key_;
+};
+
+// the most entries an internal page holds, reached when its keys are empty, less the one beyond its max size that it
+// takes until it is split
+#define BLINK_INTERNAL_PAGE_SIZE \
+  ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - sizeof(BLinkTrailer<KeyType>)) / (sizeof(uint16_t) + sizeof(page_id_t)) - 1)
+
+/**
+ * B-link tree (Lehman and Yao), a concurrent alternative to BPlusTree on the same page layouts.
+ *
+ * Every node carries a high key and a link to its right sibling. A node split moves the upper half of the node to a
+ * new right sibling before the parent learns about it, so a search that lands on a node whose high key is not above
+ * its key simply follows the right link. Readers therefore hold a single latch at a time and never wait for a split to
+ * reach the parent. Writers latch the leaf alone, and a split latches the parent before releasing the split node.
+ * (1) We only support unique key
+ * (2) Nodes are not merged: a leaf emptied by removals stays in the tree, as in Lehman and Yao's design
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BLinkTree {
+  using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  using Trailer = BLinkTrailer<KeyType>;
+
+ public:
+  explicit BLinkTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = BLINK_INTERNAL_PAGE_SIZE);
+
+  // Returns true if no key was ever inserted into this B-link tree.
+  bool IsEmpty();
+
+  // Insert a key-value pair into this B-link tree.
+  bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Remove a key and its value from this B-link tree.
+  void Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // Delete every page of this B-link tree, which is left empty.
+  void Clear();
+
+  // return the value associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
+
+  // index iterator
+  INDEXITERATOR_TYPE Begin();
+  INDEXITERATOR_TYPE Begin(const KeyType &key);
+  INDEXITERATOR_TYPE End();
+
+ private:
+  Trailer *GetTrailer(Page *page) const;
+
+  page_id_t GetRootPageId();
+
+  void StartNewTree(const KeyType &key, const ValueType &value);
+
+  Page *FetchAndLatch(page_id_t page_id, int level, bool exclusive);
+
+  Page *MoveRight(Page *page, const KeyType &key, bool write_latched);
+
+  Page *FindNode(const KeyType &key, bool left_most, int level, bool exclusive, std::vector<page_id_t> *path);
+
+  Page *FindParentPage(const KeyType &key, int level, std::vector<page_id_t> *path);
+
+  void Split(Page *page, std::vector<page_id_t> *path);
+
+  void UpdateRootPageId(int insert_record = 0);
+
+  // member variable
+  std::string index_name_;
+  page_id_t root_page_id_;
+  // protects root_page_id_, only held while the root id is read or replaced
+  std::mutex root_latch_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  int leaf_max_size_;
+  int internal_max_size_;
+};
+
+}  // namespace bustub
@@ -10,11 +10,24 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <queue>
+#include <shared_mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
+#include "storage/index/b_plus_tree_snapshot.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
@@ -32,6 +45,7 @@ namespace bustub {
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) Support concurrent readers and writers through latch crabbing
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -40,7 +54,10 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE - 1);
+
+  // Unpins the pages kept pinned by PinUpperLevels, the tree must go away before its buffer pool.
+  ~BPlusTree();
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -51,14 +68,98 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
+  /**
+   * Remove the keys from lower, included, to upper, excluded. The leaves and subtrees that fall in the range are
+   * dropped whole, and the pages on the paths to the two bounds are brought back to their min size once at the end.
+   * Returns the number of keys removed.
+   */
+  int RemoveRange(const KeyType &lower, const KeyType &upper, Transaction *transaction = nullptr);
+
+  // Delete every page of this B+ tree, which is left empty.
+  void Clear(Transaction *transaction = nullptr);
+
+  /**
+   * Pack the sparse pages of this B+ tree together, which may lower it, and move the leaves to consecutive pages in key
+   * order. Runs one leaf at a time while the tree serves reads and writes, each step latching the pages it may change
+   * the way a delete does.
+   */
+  void Compact(Transaction *transaction = nullptr);
+
+  /**
+   * Compact this B+ tree in a background thread, a leaf every interval, starting over from the first leaf after the
+   * last one. Does nothing if it runs already. The thread runs until StopCompaction or the destruction of the tree.
+   */
+  void StartCompaction(std::chrono::milliseconds interval);
+
+  // Stop the background compaction, waiting for the step in progress.
+  void StopCompaction();
+
+  /**
+   * Build this empty B+ tree bottom-up from the key-value pairs in [first, last), in any order. The pairs are sorted in
+   * runs of run_size, which are spilled to temporary files and merged when there is more than one. The first pair of a
+   * duplicate key wins, as with Insert. Leaves and internal pages are filled to fill_factor of their capacity, but
+   * never below their min size.
+   */
+  template <typename InputIterator>
+  void BulkLoad(InputIterator first, InputIterator last, double fill_factor = 1.0, Transaction *transaction = nullptr,
+                size_t run_size = BULK_LOAD_RUN_SIZE) {
+    std::vector<MappingType> run;
+    std::vector<RunFile> spilled_runs;
+    for (; first != last; ++first) {
+      run.emplace_back(*first);
+      if (run.size() >= run_size) {
+        spilled_runs.emplace_back(SpillRun(&run));
+      }
+    }
+    BulkLoadRuns(&run, &spilled_runs, fill_factor, transaction);
+  }
+
+  /**
+   * Insert the key-value pairs of items, sorted by key. A run of keys that falls into one leaf is inserted with a
+   * single descent. Returns the number of pairs inserted, pairs whose key exists are skipped as with Insert.
+   */
+  int InsertBatch(const std::vector<MappingType> &items, Transaction *transaction = nullptr);
+
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  /**
+   * Look up each key of keys, sorted, and store the values of keys[i] in (*results)[i]. A run of keys that falls into
+   * one leaf is looked up with a single descent.
+   */
+  void GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                 Transaction *transaction = nullptr);
+
   // index iterator
   INDEXITERATOR_TYPE Begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE End();
 
+  /**
+   * Range scan over the keys from lower to upper, each bound included if its flag is set or left open if it is null.
+   * The iterator keeps prefetch_size leaves pinned ahead of the one it is on.
+   */
+  INDEXITERATOR_TYPE BeginRange(const KeyType *lower, bool lower_inclusive, const KeyType *upper, bool upper_inclusive,
+                                int prefetch_size = INDEX_SCAN_PREFETCH_SIZE);
+
+  // descending index iterator, from the greatest key, resp. the greatest one not above key
+  INDEXITERATOR_TYPE RBegin();
+  INDEXITERATOR_TYPE RBegin(const KeyType &key);
+
+  /**
+   * Take a read-only snapshot of this B+ tree as it is once the writes in progress are done. The tree goes on serving
+   * reads and writes, and a page that changes while the snapshot is around is copied for it first. The snapshot must
+   * be released before the tree goes away.
+   */
+  std::shared_ptr<BPLUSTREE_SNAPSHOT_TYPE> Snapshot();
+
+  /**
+   * Keep the internal pages of the top levels of the tree pinned, as far as they take at most half of the buffer pool,
+   * so that descents reach them without going through the buffer pool. The pinned pages follow the tree as it grows
+   * and shrinks. Pass 0 to unpin them, as Clear and the destructor do.
+   */
+  void PinUpperLevels(int levels);
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -80,10 +181,57 @@ class BPlusTree {
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
 
  private:
+  /** The operation a descent is made for, it decides which latches are taken and how long they are held. */
+  enum class Operation { FIND, INSERT, DELETE, COMPACT };
+
+  Page *FindLeafPage(const KeyType &key, bool left_most, Operation op, bool optimistic, Transaction *transaction);
+
+  void LatchForDescent(Page *page, Operation op);
+
+  bool IsSafe(BPlusTreePage *node, Operation op, const KeyType &key) const;
+
+  void ReleaseLatches(Transaction *transaction, bool is_dirty);
+
+  Page *FetchNode(page_id_t page_id, bool *pinned);
+
+  void MarkUpperLevelsChanged();
+
+  void RepinUpperLevels();
+
+  void UnpinUpperLevels();
+
+  void RepinIfChanged();
+
+  bool LeafCovers(LeafPage *leaf_page, const KeyType &key) const;
+
+  Page *FindLeafAfter(const KeyType &key, bool inclusive, int *index);
+
+  Page *FindLeafBefore(const KeyType *key, bool inclusive, int *index);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
+  // a sorted run of a bulk load spilled to a temporary file
+  using RunFile = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
+
+  void SortRun(std::vector<MappingType> *run);
+
+  RunFile SpillRun(std::vector<MappingType> *run);
+
+  void BulkLoadRuns(std::vector<MappingType> *run, std::vector<RunFile> *spilled_runs, double fill_factor,
+                    Transaction *transaction);
+
+  std::vector<std::pair<KeyType, page_id_t>> BuildLeafLevel(const std::function<bool(MappingType *)> &next_entry,
+                                                            double fill_factor);
+
+  std::vector<std::pair<KeyType, page_id_t>> BuildInternalLevel(
+      const std::vector<std::pair<KeyType, page_id_t>> &children, double fill_factor);
+
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
+  void SplitLeaf(LeafPage *leaf_page, Transaction *transaction);
+
+  void SplitInternal(InternalPage *internal_page, Transaction *transaction);
+
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
@@ -98,10 +246,34 @@ class BPlusTree {
                 int index, Transaction *transaction = nullptr);
 
   template <typename N>
-  void Redistribute(N *neighbor_node, N *node, int index);
+  void Redistribute(N *neighbor_node, N *node, int index, Transaction *transaction = nullptr);
 
   bool AdjustRoot(BPlusTreePage *node);
 
+  int RemoveRangeBelow(Page *page, const KeyType *lower, const KeyType *upper, std::vector<Page *> *lower_path,
+                       std::vector<Page *> *upper_path, Transaction *transaction);
+
+  int DropSubtree(page_id_t page_id, Transaction *transaction);
+
+  bool HoldsLatch(page_id_t page_id, Transaction *transaction) const;
+
+  bool HoldsParentLatch(InternalPage *node, Transaction *transaction) const;
+
+  Page *LatchOnce(page_id_t page_id, Transaction *transaction);
+
+  bool CompactStep(KeyType *key, bool *left_most, page_id_t *last_page_id, Transaction *transaction);
+
+  bool CompactLeaf(page_id_t *last_page_id, KeyType *key, Transaction *transaction);
+
+  template <typename N>
+  bool FillFromSiblings(N *node, InternalPage *parent, Transaction *transaction);
+
+  Page *FindPreviousLeaf(Transaction *transaction);
+
+  void PreserveForSnapshots(Page *page);
+
+  void MarkNewPage(page_id_t page_id);
+
   void UpdateRootPageId(int insert_record = 0);
 
   /* Debug Routines for FREE!! */
@@ -116,6 +288,22 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  // protects root_page_id_ and pinned_pages_, held ahead of the root page latch
+  ReaderWriterLatch root_latch_;
+  std::atomic<int> pinned_levels_{0};
+  // the pinned internal pages of the top pinned_levels_ levels by page id, each pinned once by the tree
+  std::unordered_map<page_id_t, Page *> pinned_pages_;
+  // set when the root or an internal page changed, so that the pinned pages are collected anew
+  std::atomic<bool> upper_levels_changed_{false};
+  // held shared by each write for as long as it changes pages, and exclusively to take a snapshot in between
+  std::shared_mutex snapshot_latch_;
+  // the snapshots taken, the ones released are dropped as the next one is taken
+  std::vector<std::weak_ptr<BPLUSTREE_SNAPSHOT_TYPE>> snapshots_;
+  // the background compaction, woken to stop between its steps
+  std::mutex compaction_latch_;
+  std::condition_variable compaction_cv_;
+  bool stop_compaction_{false};
+  std::thread compaction_thread_;
 };
 
 }  // namespace bustub
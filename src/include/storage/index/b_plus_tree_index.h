@@ -14,6 +14,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "storage/index/b_plus_tree.h"
@@ -26,7 +27,14 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  /**
+   * Creates a B+ tree index. A non-unique index holds any number of entries per key: it appends the RID of an entry to
+   * its key, in the last KEY_RID_SIZE bytes of KeyType, so that the keys of the tree stay unique and an entry can be
+   * deleted by its key and RID. Its key schema must fit into the bytes before them, a key is never cut short. The
+   * internal pages of the top pinned_levels levels of the tree stay pinned, see BPlusTree::PinUpperLevels.
+   */
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 bool unique = true, int pinned_levels = 0);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
@@ -34,13 +42,42 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  void InsertEntries(std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) override;
+
+  void Destroy(Transaction *transaction) override;
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  // range scan from lower to upper, a null bound leaves its end open; the bounds of a non-unique index cover every RID
+  INDEXITERATOR_TYPE GetRangeIterator(const KeyType *lower, bool lower_inclusive, const KeyType *upper,
+                                      bool upper_inclusive);
+
+  // descending scan from the greatest key, resp. the greatest one not above key
+  INDEXITERATOR_TYPE GetReverseBeginIterator();
+
+  INDEXITERATOR_TYPE GetReverseBeginIterator(const KeyType &key);
+
+  bool IsUnique() const { return unique_; }
+
  protected:
+  // the bytes of KeyType that the key columns are encoded into, those before the RID in a non-unique index
+  uint32_t KeySize() const;
+
+  // the index key of key, followed by rid in a non-unique index
+  KeyType MakeKey(const Tuple &key, const RID &rid) const;
+
+  // the lowest, resp. the highest tree key of a non-unique index that holds key
+  KeyType RidBound(const KeyType &key, bool highest) const;
+
+  // whether each key has at most one entry
+  bool unique_;
   // comparator for key
   KeyComparator comparator_;
   // container
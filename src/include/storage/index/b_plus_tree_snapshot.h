@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/b_plus_tree_snapshot.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+
+namespace bustub {
+
+#define BPLUSTREE_SNAPSHOT_TYPE BPlusTreeSnapshot<KeyType, ValueType, KeyComparator>
+
+/**
+ * A copy of a tree page as it was before a writer first changed it, kept in a page of its own. The page is deleted
+ * once the last snapshot that reads it goes away.
+ */
+class SnapshotPage {
+ public:
+  SnapshotPage(BufferPoolManager *buffer_pool_manager, Page *page);
+  ~SnapshotPage();
+  SnapshotPage(const SnapshotPage &) = delete;
+  SnapshotPage &operator=(const SnapshotPage &) = delete;
+
+  page_id_t GetPageId() const { return page_id_; }
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+  page_id_t page_id_;
+};
+
+/**
+ * A read-only view of a BPlusTree as of the moment BPlusTree::Snapshot took it.
+ *
+ * The tree pages are not copied up front. A writer that is about to change a page the snapshot still reads hands it
+ * a copy first, so the snapshot reads each page from its copy once there is one and from the tree otherwise. A page
+ * of the tree is only read latched for as long as its entries are read, and a copy is not latched at all, so long
+ * scans of a snapshot neither hold latches nor keep writers waiting. The copies go away with the snapshot, which the
+ * tree hands out as a shared pointer. The snapshot must not outlive the tree, nor an iterator the snapshot.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeSnapshot {
+  using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
+ public:
+  /** A scan over the entries of the snapshot in key order, which holds a copy of the entries of one leaf at a time. */
+  class Iterator {
+   public:
+    bool IsEnd() const { return index_ == items_.size() && next_page_id_ == INVALID_PAGE_ID; }
+
+    const MappingType &operator*() const { return items_[index_]; }
+
+    Iterator &operator++();
+
+   private:
+    friend class BPlusTreeSnapshot;
+
+    // moves on to the next leaf that has entries, if the iterator is past the entries of the current one
+    void SkipExhaustedLeaves();
+
+    const BPlusTreeSnapshot *snapshot_{nullptr};
+    // the entries of the current leaf, and the page id of the leaf after it
+    std::vector<MappingType> items_;
+    size_t index_{0};
+    page_id_t next_page_id_{INVALID_PAGE_ID};
+  };
+
+  BPlusTreeSnapshot(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator, page_id_t root_page_id);
+
+  // Returns true if the tree had no keys when the snapshot was taken.
+  bool IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
+
+  // return the value associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> *result) const;
+
+  // scan from the first key, resp. from the first key not below key
+  Iterator Begin() const;
+  Iterator Begin(const KeyType &key) const;
+
+  /**
+   * Called by the tree, with page write latched, before the page changes. Unless the snapshot has a copy of page
+   * already, or page came after the snapshot, it takes *copy, which is made from page first if it is null.
+   */
+  void Preserve(Page *page, std::shared_ptr<SnapshotPage> *copy);
+
+  /** Called by the tree for a page it allocated, which the snapshot does not read. */
+  void AddNewPage(page_id_t page_id);
+
+ private:
+  // fetches the page of the snapshot for page_id, read latched if it is a page of the tree, and tells which
+  Page *FetchPage(page_id_t page_id, bool *latched) const;
+
+  void ReleasePage(Page *page, bool latched) const;
+
+  Page *FindLeafPage(const KeyType &key, bool left_most, bool *latched) const;
+
+  // copies the entries of the leaf into items, from index on, and returns the page id of the next leaf
+  page_id_t ReadLeaf(Page *page, int index, std::vector<MappingType> *items) const;
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  page_id_t root_page_id_;
+  // protects copies_ and new_pages_
+  mutable std::mutex latch_;
+  // the copies of the tree pages that changed since the snapshot was taken, by page id of the tree page
+  std::unordered_map<page_id_t, std::shared_ptr<SnapshotPage>> copies_;
+  // the pages the tree allocated since the snapshot was taken
+  std::unordered_set<page_id_t> new_pages_;
+};
+
+}  // namespace bustub
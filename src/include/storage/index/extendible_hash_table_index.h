@@ -39,6 +39,8 @@ class ExtendibleHashTableIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void Destroy(Transaction *transaction) override;
+
  protected:
   // comparator for key
   KeyComparator comparator_;
@@ -12,55 +12,92 @@
 
 #pragma once
 
+#include <cassert>
 #include <cstring>
 
+#include "common/rid.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
 namespace bustub {
 
+/**
+ * Appends the binary comparable encoding of value to data, at *offset, and advances *offset past it. Bytes beyond
+ * size are cut off. Integers, booleans and timestamps are written big endian with the sign bit flipped, decimals
+ * with all bits flipped if negative, so that memcmp orders them as numbers; the NULL of each of these types sorts
+ * first. Strings start with 0x00 if NULL and 0x01 otherwise, escape each 0x00 byte as 0x00 0xFF and end with 0x00
+ * 0x00.
+ */
+void EncodeKeyValue(const Value &value, char *data, uint32_t size, uint32_t *offset);
+
+/**
+ * The most bytes that EncodeKeyValue writes for the columns of key_schema, a VARCHAR column taking up to its length
+ * in characters, each of them escaped.
+ */
+uint32_t MaxEncodedKeySize(const Schema *key_schema);
+
+/** Reads back a BIGINT, or an INTEGER if size is less than 8 bytes, as encoded by EncodeKeyValue. */
+int64_t DecodeKeyInteger(const char *data, uint32_t size);
+
+/** Bytes that the RID suffix of a key in a non-unique index takes up. */
+static constexpr uint32_t KEY_RID_SIZE = 8;
+
+/** Writes the binary comparable encoding of rid, page id then slot number, to the KEY_RID_SIZE bytes at data. */
+void EncodeKeyRid(const RID &rid, char *data);
+
+/** Reads back a RID as encoded by EncodeKeyRid. */
+RID DecodeKeyRid(const char *data);
+
 /**
  * Generic key is used for indexing with opaque data.
  *
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
- * with a template argument.
+ * with a template argument. The columns of the key are stored one after
+ * the other in the binary comparable encoding of EncodeKeyValue, so keys
+ * compare with memcmp. A key longer than KeySize is truncated.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
+  // encode the columns into the first size bytes, the others are zeroed
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema, uint32_t size = KeySize) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      EncodeKeyValue(tuple.GetValue(key_schema, i), data_, size, &offset);
+    }
+  }
+
+  // overwrite the last KEY_RID_SIZE bytes of the key with rid, which makes the keys of a non-unique index unique and
+  // orders the entries of one key by RID; the key itself goes into the bytes before them
+  inline void SetRid(const RID &rid) {
+    assert(KeySize > KEY_RID_SIZE);
+    EncodeKeyRid(rid, data_ + KeySize - KEY_RID_SIZE);
   }
 
+  // the RID written by SetRid
+  inline RID GetRid() const { return DecodeKeyRid(data_ + KeySize - KEY_RID_SIZE); }
+
   // NOTE: for test purpose only
+  // encode key as a BIGINT column, or as an INTEGER column if it does not fit
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
-  }
-
-  inline Value ToValue(Schema *schema, uint32_t column_idx) const {
-    const char *data_ptr;
-    const auto &col = schema->GetColumn(column_idx);
-    const TypeId column_type = col.GetType();
-    const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
-      data_ptr = (data_ + col.GetOffset());
+    uint32_t offset = 0;
+    if (KeySize < sizeof(int64_t)) {
+      EncodeKeyValue(Value(TypeId::INTEGER, static_cast<int32_t>(key)), data_, KeySize, &offset);
     } else {
-      int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
-      data_ptr = (data_ + offset);
+      EncodeKeyValue(Value(TypeId::BIGINT, key), data_, KeySize, &offset);
     }
-    return Value::DeserializeFrom(data_ptr, column_type);
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline int64_t ToString() const { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // decode the integer written by SetFromInteger
+  inline int64_t ToString() const { return DecodeKeyInteger(data_, KeySize); }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
+  // decode the integer written by SetFromInteger
   friend std::ostream &operator<<(std::ostream &os, const GenericKey &key) {
     os << key.ToString();
     return os;
@@ -72,35 +109,21 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * Keys are binary comparable, so their order is the order of their bytes.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
-      }
-    }
-    // equals
-    return 0;
+    int cmp = memcmp(lhs.data_, rhs.data_, KeySize);
+    return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
-
-  // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  GenericComparator(const GenericComparator &other) = default;
 
- private:
-  Schema *key_schema_;
+  // constructor, keys of any schema compare alike
+  explicit GenericComparator(Schema *key_schema) {}
 };
 
 }  // namespace bustub
@@ -175,6 +175,40 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Search the index for each of the provided keys, e.g. the probe keys of an index nested loop join.
+   * The default searches the keys one at a time, indexes that answer a sorted batch faster override it.
+   * @param keys The index keys, in no particular order
+   * @param results Populated with the RIDs of keys[i] in (*results)[i]
+   * @param transaction The transaction context
+   */
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                        Transaction *transaction) {
+    results->assign(keys.size(), std::vector<RID>());
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+  }
+
+  /**
+   * Insert a batch of entries, e.g. every entry of a table while the index is rebuilt.
+   * The default inserts the entries one at a time, indexes that build faster from a whole batch override it.
+   * @param entries The index keys and their RIDs, in no particular order; the index may reorder or consume them
+   * @param transaction The transaction context
+   */
+  virtual void InsertEntries(std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) {
+    for (const auto &[key, rid] : *entries) {
+      InsertEntry(key, rid, transaction);
+    }
+  }
+
+  /**
+   * Delete the pages that hold the index, which must not be used afterwards, e.g. before it is rebuilt anew.
+   * The default does nothing, for indexes that hold no pages.
+   * @param transaction The transaction context
+   */
+  virtual void Destroy(Transaction *transaction) {}
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
@@ -13,6 +13,10 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <deque>
+#include <functional>
+
+#include "buffer/buffer_pool_manager.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -22,8 +26,36 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
-  // you may define your own constructor based on your member variables
+  /** Creates the end iterator. */
   IndexIterator();
+  /**
+   * Creates an iterator positioned at entry index of the leaf held by page.
+   * The iterator takes over the pin and the read latch on page and releases them when it moves past the leaf or is
+   * destroyed.
+   */
+  IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index);
+  /**
+   * Creates a range scan iterator positioned at entry index of the leaf held by page, as above. It ends before the
+   * first key above upper, or at upper itself unless upper_inclusive is set; a null upper leaves the range open. The
+   * next prefetch_size leaves are kept pinned ahead of the current one so that their I/O is done before they are
+   * reached. When the next leaf cannot be latched right away, the scan lets go of its leaf and resumes after the last
+   * key it passed, at the read latched leaf and index that resume returns for that key. comparator must outlive the
+   * iterator.
+   */
+  IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index, const KeyComparator *comparator,
+                const KeyType *upper, bool upper_inclusive, int prefetch_size,
+                std::function<Page *(const KeyType &, int *)> resume);
+  /**
+   * Creates a descending iterator positioned at entry index of the leaf held by page, as above. Leaves are not linked
+   * backwards, so once it is past the first entry of a leaf the iterator lets go of the leaf and continues at the read
+   * latched leaf and index that resume_before returns for the greatest key below the first one of the leaf.
+   */
+  IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index,
+                std::function<Page *(const KeyType &, int *)> resume_before);
+  IndexIterator(IndexIterator &&other) noexcept;
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+  IndexIterator(const IndexIterator &) = delete;
+  IndexIterator &operator=(const IndexIterator &) = delete;
   ~IndexIterator();
 
   bool IsEnd();
@@ -32,12 +64,46 @@ class IndexIterator {
 
   IndexIterator &operator++();
 
-  bool operator==(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator==(const IndexIterator &itr) const { return page_id_ == itr.page_id_ && index_ == itr.index_; }
 
-  bool operator!=(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator!=(const IndexIterator &itr) const { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
+  /**
+   * Skips over exhausted leaves, in scan order, so that the iterator either points at an entry or is the end iterator,
+   * and ends the iterator once its entry lies past the upper bound.
+   */
+  void SkipExhaustedLeaves();
+  /** @return the pinned page next_page_id, taken from the prefetched leaves when they are still on the way */
+  Page *TakeNextPage(page_id_t next_page_id);
+  /** Pins leaves ahead of the current one until prefetch_size_ are pinned, or one of them is latched by a writer. */
+  void Prefetch();
+  /** Unpins the current leaf, if any. */
+  void Release();
+  /** Unpins the prefetched leaves. */
+  void ReleasePrefetched();
+
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  Page *page_{nullptr};
+  LeafPage *leaf_{nullptr};
+  page_id_t page_id_{INVALID_PAGE_ID};
+  int index_{0};
+  /** The entry last returned by operator*, decoded from the compressed leaf. */
+  MappingType item_;
+  /** The upper bound of a range scan, only meaningful if has_upper_ is set. */
+  const KeyComparator *comparator_{nullptr};
+  bool has_upper_{false};
+  bool upper_inclusive_{false};
+  KeyType upper_;
+  /** Leaves pinned, but not latched, ahead of the current one in next page id order, as last seen. */
+  int prefetch_size_{0};
+  std::deque<Page *> prefetched_;
+  /** Whether the iterator runs from the greatest key down. */
+  bool reverse_{false};
+  /** Finds the read latched leaf and the index of the entry that follows a key in scan order, to go on from there. */
+  std::function<Page *(const KeyType &, int *)> resume_;
 };
 
 }  // namespace bustub
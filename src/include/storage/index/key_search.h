@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.h
+//
+// Identification: src/include/storage/index/key_search.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+/**
+ * Number of the n integers at keys that are less than key, resp. not greater than key if inclusive is true. Uses
+ * AVX2 or SSE4.2 compares when the build targets them, a scalar loop otherwise.
+ */
+int CountIntegersBelow(const int64_t *keys, int n, int64_t key, bool inclusive);
+
+/**
+ * KeySearch finds where a key belongs among the sorted keys [begin, end) of an index page, which key_at(i) returns.
+ * The primary template runs a binary search with the comparator of the tree. Specializations on KeyType and
+ * KeyComparator may search the keys through their layout instead.
+ */
+template <typename KeyType, typename KeyComparator>
+class KeySearch {
+ public:
+  // first index whose key is not less than key
+  template <typename KeyAt>
+  static int LowerBound(const KeyType &key, int begin, int end, const KeyAt &key_at, const KeyComparator &comparator) {
+    return Search(key, begin, end, key_at, comparator, false);
+  }
+
+  // first index whose key is greater than key
+  template <typename KeyAt>
+  static int UpperBound(const KeyType &key, int begin, int end, const KeyAt &key_at, const KeyComparator &comparator) {
+    return Search(key, begin, end, key_at, comparator, true);
+  }
+
+ private:
+  template <typename KeyAt>
+  static int Search(const KeyType &key, int begin, int end, const KeyAt &key_at, const KeyComparator &comparator,
+                    bool inclusive) {
+    while (begin < end) {
+      int mid = (begin + end) >> 1;
+      int cmp = comparator(key_at(mid), key);
+      if (cmp < 0 || (inclusive && cmp == 0)) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin;
+  }
+};
+
+/**
+ * Generic keys are binary comparable, so they are searched by their first 8 bytes as an integer: a binary search
+ * narrows the keys down to KEY_SEARCH_SCAN_SIZE, whose prefixes are copied into a compact array and counted with SIMD
+ * compares. Keys that share the prefix of the search key are then told apart with the comparator.
+ */
+template <size_t KeySize>
+class KeySearch<GenericKey<KeySize>, GenericComparator<KeySize>> {
+  using KeyType = GenericKey<KeySize>;
+  using KeyComparator = GenericComparator<KeySize>;
+
+ public:
+  template <typename KeyAt>
+  static int LowerBound(const KeyType &key, int begin, int end, const KeyAt &key_at, const KeyComparator &comparator) {
+    return Search(key, begin, end, key_at, comparator, false);
+  }
+
+  template <typename KeyAt>
+  static int UpperBound(const KeyType &key, int begin, int end, const KeyAt &key_at, const KeyComparator &comparator) {
+    return Search(key, begin, end, key_at, comparator, true);
+  }
+
+ private:
+  // the first 8 bytes of key, big endian and with the sign bit flipped, so that they order as a signed integer
+  static int64_t PrefixOf(const KeyType &key) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(bits); i++) {
+      bits = (bits << 8) | (i < KeySize ? static_cast<uint8_t>(key.data_[i]) : 0);
+    }
+    return static_cast<int64_t>(bits ^ (uint64_t{1} << 63));
+  }
+
+  template <typename KeyAt>
+  static int Search(const KeyType &key, int begin, int end, const KeyAt &key_at, const KeyComparator &comparator,
+                    bool inclusive) {
+    const int64_t prefix = PrefixOf(key);
+    // whether other, whose prefix is the one of key, comes before the searched position
+    auto before = [&](const KeyType &other) {
+      int cmp = comparator(other, key);
+      return cmp < 0 || (inclusive && cmp == 0);
+    };
+    while (end - begin > KEY_SEARCH_SCAN_SIZE) {
+      int mid = (begin + end) >> 1;
+      const KeyType &mid_key = key_at(mid);
+      int64_t mid_prefix = PrefixOf(mid_key);
+      if (mid_prefix < prefix || (mid_prefix == prefix && before(mid_key))) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    int64_t prefixes[KEY_SEARCH_SCAN_SIZE];
+    for (int i = begin; i < end; i++) {
+      prefixes[i - begin] = PrefixOf(key_at(i));
+    }
+    int index = begin + CountIntegersBelow(prefixes, end - begin, prefix, false);
+    while (index < end && prefixes[index - begin] == prefix && before(key_at(index))) {
+      index++;
+    }
+    return index;
+  }
+};
+
+}  // namespace bustub
@@ -17,8 +17,9 @@
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE 32
+// the most entries an internal page holds, reached when its keys are empty
+#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(uint16_t) + sizeof(page_id_t)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -27,26 +28,62 @@ namespace bustub {
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
  *
+ * Keys are variable length: each cell keeps the bytes of its key up to the
+ * last non-zero one, then the page id. The separators that leaf splits push up
+ * are the shortest keys between the two leaves, so they take few bytes
+ * whatever the key size. The offsets of the cells come in key order after the
+ * header, the cells are packed from the end of the page down, the first one
+ * last, as in a leaf page.
+ *
+ * The max size of the page is its size plus the number of entries that would
+ * still fit if each took the room of a full key, less one, so a page within
+ * max size always has room for one more entry of any key, which the page
+ * takes before it splits.
+ *
  * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ *  ------------------------------------------------------------------
+ * | HEADER | OFFSET(0) ... OFFSET(n) | FREE | CELL(n) ... CELL(0) |
+ *  ------------------------------------------------------------------
+ *
+ *  Cell format: | KEY BYTES (variable) | PAGE_ID (4) |
+ *
+ *  Header format (size in byte, 32 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  ---------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | SizeLimit (4) | HeapOffset (2) | TailSize (2) |
+ *  ---------------------------------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
-  // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  // must call initialize method after "create" a new node. The last tail_size
+  // bytes of the page are left to the caller.
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            int tail_size = 0);
 
   KeyType KeyAt(int index) const;
   void SetKeyAt(int index, const KeyType &key);
   int ValueIndex(const ValueType &value) const;
   ValueType ValueAt(int index) const;
+  void SetValueAt(int index, const ValueType &value);
+
+  // max size of the page once it also holds key, once key replaces the key at index, resp. once it also holds the
+  // entries of other, whose first key is middle_key
+  int MaxSizeFor(const KeyType &key) const;
+  int MaxSizeWithKeyAt(int index, const KeyType &key) const;
+  int MaxSizeWith(const BPlusTreeInternalPage &other, const KeyType &middle_key) const;
+
+  // the shortest key above lower and not above upper, for keys that compare as their bytes do
+  static KeyType ShortestSeparator(const KeyType &lower, const KeyType &upper);
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+  int LookupIndex(const KeyType &key, const KeyComparator &comparator) const;
+  int LookupIndexBefore(const KeyType &key, const KeyComparator &comparator) const;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
-  void Remove(int index);
+  void Remove(int index, int count = 1);
   ValueType RemoveAndReturnOnlyChild();
 
   // Split and Merge utility methods
@@ -57,10 +94,31 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                          BufferPoolManager *buffer_pool_manager);
 
+  // Bulk load utility method, appends size entries and adopts their child pages
+  void CopyNFrom(const MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  MappingType array_[0];
+  void Adopt(const ValueType &value, BufferPoolManager *buffer_pool_manager);
+
+  // cell helpers, cell index spans [offsets_[index], CellEnd(index)) of the heap
+  char *Heap();
+  const char *Heap() const;
+  int CellEnd(int index) const;
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+  void RemoveAt(int index, int count = 1);
+
+  // size helpers
+  int Room() const;
+  int CellSize(const KeyType &key) const;
+  int UsedBytes() const;
+  int MaxSizeOf(int size, int used_bytes) const;
+  void UpdateMaxSize();
+
+  int size_limit_;
+  uint16_t heap_offset_;
+  uint16_t tail_size_;
+  uint16_t offsets_[0];
 };
 }  // namespace bustub
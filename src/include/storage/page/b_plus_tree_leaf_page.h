@@ -18,44 +18,70 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 40
+// the most entries a leaf holds, reached when its keys share all of their bytes
+#define LEAF_PAGE_SIZE \
+  ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(KeyType)) / (sizeof(uint16_t) + sizeof(ValueType)))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
  * page. Only support unique key.
  *
+ * Keys are variable length: the leading bytes that every key of the page shares
+ * are stored once, in SHARED KEY, and each cell only keeps the bytes that follow
+ * up to the last non-zero one, then the RID. Short keys thus take little room
+ * whatever the key size. The offsets of the cells come in key order after the
+ * header, the cells are packed from the end of the page down, the first one
+ * last, so that each cell ends where the one before it starts.
+ *
+ * The max size of the page is its size plus the number of entries that would
+ * still fit if each took the room of a key that shares no bytes, so an
+ * underflowing page always has room for any key.
+ *
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ * | HEADER | SHARED KEY | OFFSET(1) ... OFFSET(n) | FREE | CELL(n) ... CELL(1) |
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Cell format: | KEY BYTES (variable) | RID (8) |
+ *
+ *  Header format (size in byte, 40 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
  *  -----------------------------------------------
  * | ParentPageId (4) | PageId (4) | NextPageId (4)
  *  -----------------------------------------------
+ *  ---------------------------------------------------------------------
+ * | SizeLimit (4) | PrefixSize (2) | HeapOffset (2) | TailSize (4) |
+ *  ---------------------------------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
-  // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  // method to set default values. The last tail_size bytes of the page are
+  // left to the caller.
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE,
+            int tail_size = 0);
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
   KeyType KeyAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
 
-  // insert and delete methods
+  // max size of the page once it also holds key, resp. the entries of other
+  int MaxSizeFor(const KeyType &key) const;
+  int MaxSizeWith(const BPlusTreeLeafPage &other) const;
+
+  // insert and delete methods, an inserted key must leave the page within max size
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
   bool Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
   int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
+  // removes the keys from lower, included, to upper, excluded, either null when unbounded, returns how many
+  int RemoveRange(const KeyType *lower, const KeyType *upper, const KeyComparator &comparator);
 
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
@@ -63,11 +89,37 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
+  // Bulk load utility method, appends size entries
+  void CopyNFrom(const MappingType *items, int size);
+
  private:
-  void CopyNFrom(MappingType *items, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
+
+  ValueType ValueAt(int index) const;
+  // cell helpers, cell index spans [offsets_[index], CellEnd(index)) of the heap
+  char *Heap();
+  const char *Heap() const;
+  int CellEnd(int index) const;
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+  void RemoveAt(int index, int count = 1);
+
+  // layout helpers, a layout is the number of shared leading key bytes
+  int Room() const;
+  int CellSize(const KeyType &key, int prefix_size) const;
+  int UsedBytes(int prefix_size) const;
+  int MaxSizeOf(int size, int used_bytes) const;
+  int NarrowPrefix(const KeyType &key, int prefix_size) const;
+  void Relayout(int prefix_size, const KeyType &shared_key);
+  void Widen(const KeyType &key);
+  void Tighten();
+
   page_id_t next_page_id_;
-  MappingType array_[0];
+  int size_limit_;
+  uint16_t prefix_size_;
+  uint16_t heap_offset_;
+  int tail_size_;
+  KeyType shared_key_;
+  uint16_t offsets_[0];
 };
 }  // namespace bustub
@@ -28,8 +28,15 @@ namespace bustub {
  *
  * Directory format (size in byte):
  * --------------------------------------------------------------------------------------------
- * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1524)
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | ParentDepth(4)
  * --------------------------------------------------------------------------------------------
+ * | ChildDirectories(64) | Free(1456)
+ * --------------------------------------------------------------------------------------------
+ *
+ * The directory of a hash table is a tree of directory pages. A slot whose bucket can split no further because the
+ * page is full holds a child directory page instead, which indexes the keys of that slot by the hash bits above the
+ * ones its parents index by. The parent depth of a page is the number of those bits, a multiple of
+ * DIRECTORY_MAX_DEPTH.
  */
 class HashTableDirectoryPage {
  public:
@@ -73,6 +80,32 @@ class HashTableDirectoryPage {
    */
   void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id);
 
+  /**
+   * @param bucket_idx the directory index to lookup
+   * @return true if the slot at bucket_idx holds a child directory page rather than a bucket page
+   */
+  bool IsChildDirectory(uint32_t bucket_idx);
+
+  /**
+   * Marks whether the slot at bucket_idx holds a child directory page
+   *
+   * @param bucket_idx the directory index to update
+   * @param is_child_directory whether the page id at bucket_idx is that of a directory page
+   */
+  void SetChildDirectory(uint32_t bucket_idx, bool is_child_directory);
+
+  /**
+   * @return the number of low hash bits that the directory pages above this one index by
+   */
+  uint32_t GetParentDepth();
+
+  /**
+   * Sets the number of low hash bits that the directory pages above this one index by
+   *
+   * @param parent_depth the parent depth of this page
+   */
+  void SetParentDepth(uint32_t parent_depth);
+
   /**
    * Gets the split image of an index
    *
@@ -192,6 +225,8 @@ class HashTableDirectoryPage {
   uint32_t global_depth_{0};
   uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
   page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+  uint32_t parent_depth_{0};
+  char child_directories_[(DIRECTORY_ARRAY_SIZE - 1) / 8 + 1];
 };
 
 }  // namespace bustub
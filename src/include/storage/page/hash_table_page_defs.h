@@ -33,6 +33,8 @@
  */
 #define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
 #define DIRECTORY_ARRAY_SIZE 512
+/** DIRECTORY_MAX_DEPTH is the global depth at which a directory page is full, log2 of DIRECTORY_ARRAY_SIZE. */
+#define DIRECTORY_MAX_DEPTH 9
 
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hashing bucket page.
@@ -122,6 +122,15 @@ class TablePage : public Page {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
 
+  /**
+   * Read a tuple from a table without taking locks. Only safe while no transaction can modify the page,
+   * e.g. while the indexes are rebuilt at startup.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple the tuple that was read
+   * @return true if the read is successful (i.e. the tuple exists)
+   */
+  bool GetTupleUnlocked(const RID &rid, Tuple *tuple);
+
   /** @return the rid of the first tuple in this page */
 
   /**
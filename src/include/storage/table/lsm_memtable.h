@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_memtable.h
+//
+// Identification: src/include/storage/table/lsm_memtable.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rwlatch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/** What an entry of an LsmTable says about its row. */
+enum class LsmEntryKind : uint32_t {
+  /** The row holds the tuple. */
+  VALUE,
+  /** The row holds the tuple, but a transaction that has not finished yet deleted it. */
+  DELETE_MARKED,
+  /** The row was deleted. */
+  TOMBSTONE
+};
+
+/** The latest write to a row of an LsmTable, as kept by a memtable or a sorted run. */
+struct LsmEntry {
+  uint64_t row_{0};
+  LsmEntryKind kind_{LsmEntryKind::TOMBSTONE};
+  /** The tuple of the row, empty for a tombstone. */
+  Tuple tuple_;
+};
+
+/**
+ * LsmMemTable buffers the writes to an LsmTable in memory, in a skip list ordered by row. It keeps the latest entry of
+ * each row only. Writers hold the latch of the memtable exclusively and readers share it; a memtable that is being
+ * flushed is no longer written to.
+ */
+class LsmMemTable {
+ public:
+  LsmMemTable();
+  ~LsmMemTable();
+
+  DISALLOW_COPY_AND_MOVE(LsmMemTable);
+
+  /**
+   * Write the entry of a row, replacing the one the row has.
+   * @param row the row to write
+   * @param kind what the entry says about the row
+   * @param tuple the tuple of the row, ignored for a tombstone
+   */
+  void Put(uint64_t row, LsmEntryKind kind, const Tuple &tuple);
+
+  /**
+   * Read the entry of a row.
+   * @param row the row to read
+   * @param[out] entry the entry of the row
+   * @return true iff the memtable has an entry for the row
+   */
+  bool Get(uint64_t row, LsmEntry *entry);
+
+  /**
+   * Read the entry of the first row that is not below row.
+   * @param row the row to start from
+   * @param[out] entry the entry found
+   * @return true iff there is such an entry
+   */
+  bool LowerBound(uint64_t row, LsmEntry *entry);
+
+  /** Call visit on every entry, in row order. */
+  void ForEach(const std::function<void(const LsmEntry &)> &visit);
+
+  /** @return the number of entries */
+  size_t GetNumEntries() const { return num_entries_; }
+
+  /** @return the number of bytes the entries take, roughly */
+  size_t GetSize() const { return size_; }
+
+ private:
+  static constexpr int MAX_HEIGHT = 12;
+
+  struct Node {
+    LsmEntry entry_;
+    std::vector<Node *> next_;
+  };
+
+  // the first node whose row is not below row, prev gets the last node before it on each level unless it is null
+  Node *FindGreaterOrEqual(uint64_t row, Node **prev);
+
+  static size_t EntrySize(const LsmEntry &entry) { return sizeof(Node) + entry.tuple_.GetLength(); }
+
+  Node head_;
+  int height_{1};
+  std::atomic<size_t> num_entries_{0};
+  std::atomic<size_t> size_{0};
+  // the height of a new node, drawn by writers only
+  std::mt19937 random_;
+  ReaderWriterLatch latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_run.h
+//
+// Identification: src/include/storage/table/lsm_run.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/table/lsm_memtable.h"
+
+namespace bustub {
+
+/**
+ * A bloom filter over the rows of a sorted run, which rules out most of the runs a point read would otherwise search.
+ */
+class LsmBloomFilter {
+ public:
+  /** @param num_rows the number of rows the filter is sized for */
+  explicit LsmBloomFilter(size_t num_rows);
+
+  void Add(uint64_t row);
+
+  /** @return false if row was never added, true if it may have been */
+  bool MayContain(uint64_t row) const;
+
+ private:
+  // about one percent of false positives
+  static constexpr size_t BITS_PER_ROW = 10;
+  static constexpr size_t NUM_PROBES = 7;
+
+  // the two hashes of row that the probes are derived from
+  static std::pair<uint64_t, uint64_t> Hash(uint64_t row);
+
+  std::vector<uint64_t> bits_;
+  size_t num_bits_;
+};
+
+/**
+ * LsmRun is an immutable run of LsmTable entries sorted by row, with one entry per row, written to pages of the
+ * buffer pool.
+ *
+ * Run page format:
+ *  ----------------------------------------------------------------
+ * | NumEntries (4) | Entry 1 | Entry 2 | ... | Entry n | free space |
+ *  ----------------------------------------------------------------
+ *  Entry format:
+ *  ------------------------------------------------------
+ * | Row (8) | Kind (4) | TupleSize (4) | Tuple (TupleSize) |
+ *  ------------------------------------------------------
+ *
+ * The first row of every page, the bloom filter and the bounds of the run stay in memory, so that a point read fetches
+ * at most one page of the run. The pages are deleted with the run.
+ */
+class LsmRun {
+ public:
+  /** Reads the entries of a run in row order, a page at a time. */
+  class Cursor {
+   public:
+    explicit Cursor(const LsmRun *run) : run_(run) { Load(); }
+
+    bool IsEnd() const { return index_ == entries_.size(); }
+
+    const LsmEntry &Entry() const { return entries_[index_]; }
+
+    void Next();
+
+   private:
+    // reads the entries of the page at page_index_, if there is one
+    void Load();
+
+    const LsmRun *run_;
+    size_t page_index_{0};
+    std::vector<LsmEntry> entries_;
+    size_t index_{0};
+  };
+
+  /**
+   * Start a run, which takes entries with Append until Finish is called.
+   * @param buffer_pool_manager the buffer pool manager the pages of the run are allocated from
+   * @param max_entries the number of entries the run will take at most, for the size of the bloom filter
+   */
+  LsmRun(BufferPoolManager *buffer_pool_manager, size_t max_entries);
+  ~LsmRun();
+
+  DISALLOW_COPY_AND_MOVE(LsmRun);
+
+  /** Add an entry, whose row must be above the row of the entry added before it. */
+  void Append(const LsmEntry &entry);
+
+  /** Write out the last page. */
+  void Finish();
+
+  /**
+   * Read the entry of a row.
+   * @param row the row to read
+   * @param[out] entry the entry of the row
+   * @return true iff the run has an entry for the row
+   */
+  bool Get(uint64_t row, LsmEntry *entry) const;
+
+  /**
+   * Read the entry of the first row that is not below row.
+   * @param row the row to start from
+   * @param[out] entry the entry found
+   * @return true iff there is such an entry
+   */
+  bool LowerBound(uint64_t row, LsmEntry *entry) const;
+
+  /** @return the number of entries */
+  size_t GetNumEntries() const { return num_entries_; }
+
+  /** @return the number of bytes the pages of the run take */
+  size_t GetSize() const { return pages_.size() * PAGE_SIZE; }
+
+ private:
+  static constexpr size_t PAGE_HEADER_SIZE = sizeof(uint32_t);
+  static constexpr size_t ENTRY_HEADER_SIZE = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint32_t);
+
+  // the index of the page whose rows row falls among, -1 if row is below the first row of the run
+  int PageIndex(uint64_t row) const;
+
+  // reads the entry at offset of data into entry and returns the offset of the next entry
+  static size_t ReadEntry(const char *data, size_t offset, LsmEntry *entry);
+
+  // the offset of the entry after the one at offset of data
+  static size_t NextEntry(const char *data, size_t offset);
+
+  // writes the page being filled to the buffer pool
+  void WritePage();
+
+  BufferPoolManager *buffer_pool_manager_;
+  // the first row and the page id of every page, in row order
+  std::vector<std::pair<uint64_t, page_id_t>> pages_;
+  uint64_t last_row_{0};
+  size_t num_entries_{0};
+  LsmBloomFilter bloom_filter_;
+  // the page being filled by Append, and the bytes of it in use
+  std::vector<char> page_;
+  size_t page_size_{PAGE_HEADER_SIZE};
+};
+
+}  // namespace bustub
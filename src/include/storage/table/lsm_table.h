@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_table.h
+//
+// Identification: src/include/storage/table/lsm_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "storage/table/lsm_memtable.h"
+#include "storage/table/lsm_run.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/**
+ * LsmTable is a table stored as a log-structured merge tree, for append heavy tables such as event logs.
+ *
+ * Every tuple is a row, numbered in the order of the inserts. Its RID is a page the table owns, which sets the RIDs
+ * of the table apart from those of any other table, with the row number as the slot number. The writes go to a
+ * memtable; a full memtable is handed to a background thread, which writes it out as a sorted run in level 0 and
+ * starts a new one. Once level 0 has level0_runs runs, the background thread merges them into level 1. Every level
+ * from 1 on is a single sorted run that is level_size_ratio times larger than the one above it may be, and is merged
+ * into the level below it when it grows past that. A read looks at the memtables and then at the runs from the newest
+ * to the oldest and takes the first entry of its row it finds; the bloom filter of a run skips most of the runs that
+ * do not have the row.
+ * (1) Deletes are marked as in TableHeap, and the mark is written as an entry of its own
+ * (2) A scan looks up every next row in all runs, as TableIterator only holds the tuple it is on
+ * (3) The table is not persistent: it is not logged, and the pages, bloom filters and fences of its runs and its levels
+ *     are kept in memory only, so an LsmTable cannot be reopened. Its pages are deleted along with it
+ * (4) A table holds at most 2^32 rows, one per slot number of its RIDs
+ */
+class LsmTable : public TableHeap {
+ public:
+  /**
+   * Create an empty LSM table.
+   * @param buffer_pool_manager the buffer pool manager
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @param memtable_size the number of bytes a memtable takes before it is flushed
+   * @param level0_runs the number of runs in level 0 that are merged into level 1
+   * @param level_size_ratio how many times larger a level may be than the one above it
+   */
+  LsmTable(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
+           size_t memtable_size = LSM_MEMTABLE_SIZE, size_t level0_runs = LSM_LEVEL0_RUNS,
+           size_t level_size_ratio = LSM_LEVEL_SIZE_RATIO);
+
+  ~LsmTable() override;
+
+  DISALLOW_COPY_AND_MOVE(LsmTable);
+
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) override;
+
+  bool MarkDelete(const RID &rid, Transaction *txn) override;
+
+  bool UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) override;
+
+  void ApplyDelete(const RID &rid, Transaction *txn) override;
+
+  void RollbackDelete(const RID &rid, Transaction *txn) override;
+
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) override;
+
+  TableIterator Begin(Transaction *txn) override;
+
+  /** Flush the memtable and wait until the background thread has no flush or compaction left to do. */
+  void Flush();
+
+  /** @return the number of runs in a level */
+  size_t GetNumRuns(size_t level);
+
+ protected:
+  void NextTuple(Tuple *tuple, Transaction *txn) override;
+
+ private:
+  /** The memtables and runs of the table at some moment, from the newest to the oldest. */
+  struct Version {
+    std::shared_ptr<LsmMemTable> memtable_;
+    std::shared_ptr<LsmMemTable> immutable_;
+    std::vector<std::shared_ptr<LsmRun>> runs_;
+  };
+
+  RID RidOf(uint64_t row) const { return RID(rid_page_id_, static_cast<uint32_t>(row)); }
+
+  static uint64_t RowOf(const RID &rid) { return rid.GetSlotNum(); }
+
+  // the current version, with latch_ held
+  Version CurrentVersion() const;
+
+  Version GetVersion();
+
+  // the newest entry of row
+  static bool Find(const Version &version, uint64_t row, LsmEntry *entry);
+
+  // reads the first row not below row that holds a tuple into tuple, with its rid
+  bool Seek(const Version &version, uint64_t row, Tuple *tuple) const;
+
+  // hands the memtable to the background thread if it is full, with latch_ held by lock
+  void MakeRoom(std::unique_lock<std::mutex> *lock);
+
+  // whether the background thread has a compaction to do, and the level to merge into the one below it if so
+  bool NeedsCompaction(size_t *level) const;
+
+  // the number of bytes a level from 1 on may take
+  size_t LevelCapacity(size_t level) const;
+
+  void RunBackgroundThread();
+
+  void Compact(size_t level, std::unique_lock<std::mutex> *lock);
+
+  size_t memtable_size_;
+  size_t level0_runs_;
+  size_t level_size_ratio_;
+  // the page of the RIDs of the table, allocated for it alone
+  page_id_t rid_page_id_;
+
+  // protects the members below, and is held by writers while they write to the memtable
+  std::mutex latch_;
+  // signals the background thread, and the threads that wait for it
+  std::condition_variable cv_;
+  // the row of the next insert, so that the rows go into the memtable in order
+  uint64_t next_row_{0};
+  std::shared_ptr<LsmMemTable> memtable_;
+  // the memtable that is being flushed, if any
+  std::shared_ptr<LsmMemTable> immutable_;
+  // the runs of level 0 from the newest to the oldest
+  std::vector<std::shared_ptr<LsmRun>> level0_;
+  // the run of level i + 1 at levels_[i], null if the level is empty
+  std::vector<std::shared_ptr<LsmRun>> levels_;
+  // whether the background thread is writing runs with latch_ released
+  bool busy_{false};
+  bool stop_{false};
+  std::thread background_thread_;
+};
+
+}  // namespace bustub
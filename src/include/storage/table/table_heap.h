@@ -22,13 +22,14 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages. A subclass may store the table otherwise, as LsmTable does, behind the
+ * same interface.
  */
 class TableHeap {
   friend class TableIterator;
 
  public:
-  ~TableHeap() = default;
+  virtual ~TableHeap() = default;
 
   /**
    * Create a table heap without a transaction. (open table)
@@ -57,7 +58,7 @@ class TableHeap {
    * @param txn the transaction performing the insert
    * @return true iff the insert is successful
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+  virtual bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -65,7 +66,7 @@ class TableHeap {
    * @param txn transaction performing the delete
    * @return true iff the delete is successful (i.e the tuple exists)
    */
-  bool MarkDelete(const RID &rid, Transaction *txn);  // for delete
+  virtual bool MarkDelete(const RID &rid, Transaction *txn);  // for delete
 
   /**
    * if the new tuple is too large to fit in the old page, return false (will delete and insert)
@@ -74,21 +75,21 @@ class TableHeap {
    * @param txn transaction performing the update
    * @return true is update is successful.
    */
-  bool UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn);
+  virtual bool UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn);
 
   /**
    * Called on Commit/Abort to actually delete a tuple or rollback an insert.
    * @param rid rid of the tuple to delete
    * @param txn transaction performing the delete.
    */
-  void ApplyDelete(const RID &rid, Transaction *txn);
+  virtual void ApplyDelete(const RID &rid, Transaction *txn);
 
   /**
    * Called on abort to rollback a delete.
    * @param rid rid of the deleted tuple.
    * @param txn transaction performing the rollback
    */
-  void RollbackDelete(const RID &rid, Transaction *txn);
+  virtual void RollbackDelete(const RID &rid, Transaction *txn);
 
   /**
    * Read a tuple from the table.
@@ -97,10 +98,10 @@ class TableHeap {
    * @param txn transaction performing the read
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+  virtual bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
   /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  virtual TableIterator Begin(Transaction *txn);
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -108,7 +109,14 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
- private:
+ protected:
+  /**
+   * Move the tuple an iterator is on to the next tuple of the table, or to the end of the table.
+   * @param[in,out] tuple the tuple of the iterator
+   * @param txn the transaction performing the scan
+   */
+  virtual void NextTuple(Tuple *tuple, Transaction *txn);
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
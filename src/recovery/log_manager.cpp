@@ -12,7 +12,51 @@
 
 #include "recovery/log_manager.h"
 
+#include <cstring>
+#include <utility>
+
+#include "common/macros.h"
+
 namespace bustub {
+/*
+ * LSNs continue after the last record on disk. Otherwise redo would take the
+ * records of this run for ones that the pages already reflect, as their LSNs
+ * would start over below the page LSNs. Records never cross a segment boundary,
+ * so the last one is in the last segment written, which is read record by
+ * record up to its zero filled tail.
+ */
+LogManager::LogManager(DiskManager *disk_manager)
+    : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
+  log_buffer_ = new char[LOG_BUFFER_SIZE];
+  flush_buffer_ = new char[LOG_BUFFER_SIZE];
+
+  int64_t write_offset = disk_manager_->GetLogWriteOffset();
+  if (write_offset == disk_manager_->GetLogStartOffset()) {
+    return;
+  }
+  int64_t offset = (write_offset - 1) / LOG_SEGMENT_SIZE * LOG_SEGMENT_SIZE;
+  while (offset < write_offset && disk_manager_->ReadLog(flush_buffer_, LOG_BUFFER_SIZE, offset)) {
+    int pos = 0;
+    while (pos + LogRecord::HEADER_SIZE <= LOG_BUFFER_SIZE) {
+      int32_t size;
+      lsn_t lsn;
+      memcpy(&size, flush_buffer_ + pos, sizeof(int32_t));
+      memcpy(&lsn, flush_buffer_ + pos + sizeof(int32_t), sizeof(lsn_t));
+      if (size < LogRecord::HEADER_SIZE || pos + size > LOG_BUFFER_SIZE) {
+        break;
+      }
+      next_lsn_ = lsn + 1;
+      pos += size;
+    }
+    if (pos == 0) {
+      break;
+    }
+    // the record cut off by the end of the buffer is read again with the next batch
+    offset += pos;
+  }
+  persistent_lsn_ = next_lsn_ - 1;
+}
+
 /*
  * set enable_logging = true
  * Start a separate thread to execute flush to disk operation periodically
@@ -22,33 +66,169 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock lock(latch_);
+  if (flush_thread_running_) {
+    return;
+  }
+  enable_logging = true;
+  flush_thread_running_ = true;
+  segment_offset_ = static_cast<int>((disk_manager_->GetLogWriteOffset() + offset_) % LOG_SEGMENT_SIZE);
+  flush_thread_ = new std::thread([this] {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (flush_thread_running_) {
+      cv_.wait_for(lock, log_timeout, [this] { return flush_requested_ || !flush_thread_running_; });
+      FlushBuffer(&lock);
+    }
+  });
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  {
+    std::scoped_lock lock(latch_);
+    if (!flush_thread_running_) {
+      return;
+    }
+    flush_thread_running_ = false;
+    enable_logging = false;
+  }
+  // the thread flushes whatever is left in the log buffer before it exits
+  cv_.notify_one();
+  flush_thread_->join();
+  delete flush_thread_;
+  flush_thread_ = nullptr;
+}
+
+void LogManager::FlushBuffer(std::unique_lock<std::mutex> *lock) {
+  std::swap(log_buffer_, flush_buffer_);
+  int size = offset_;
+  lsn_t last_lsn = next_lsn_ - 1;
+  offset_ = 0;
+  flush_requested_ = false;
+  flushing_ = true;
+  // appenders may fill up the other buffer in the meantime
+  lock->unlock();
+  disk_manager_->WriteLog(flush_buffer_, size);
+  lock->lock();
+  flushing_ = false;
+  persistent_lsn_ = last_lsn;
+  flushed_cv_.notify_all();
+}
+
+void LogManager::FlushUntil(lsn_t lsn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  lsn = std::min(lsn, next_lsn_ - 1);
+  while (persistent_lsn_ < lsn) {
+    if (flush_thread_running_) {
+      flush_requested_ = true;
+      cv_.notify_one();
+      flushed_cv_.wait(lock);
+    } else if (flushing_) {
+      flushed_cv_.wait(lock);
+    } else {
+      FlushBuffer(&lock);
+    }
+  }
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  BUSTUB_ASSERT(log_record->size_ <= LOG_BUFFER_SIZE, "Log record does not fit into the log buffer.");
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    // a record that does not fit into the current segment starts the next one, the rest is zero padded
+    int padding = segment_offset_ + log_record->size_ > LOG_SEGMENT_SIZE ? LOG_SEGMENT_SIZE - segment_offset_ : 0;
+    if (padding > 0 && offset_ + padding <= LOG_BUFFER_SIZE) {
+      memset(log_buffer_ + offset_, 0, padding);
+      offset_ += padding;
+      segment_offset_ = 0;
+      continue;
+    }
+    if (padding == 0 && offset_ + log_record->size_ <= LOG_BUFFER_SIZE) {
+      break;
+    }
+    // the log buffer is full, wait for the flush thread to swap in the other one
+    if (flush_thread_running_) {
+      flush_requested_ = true;
+      cv_.notify_one();
+      flushed_cv_.wait(lock);
+    } else if (flushing_) {
+      flushed_cv_.wait(lock);
+    } else {
+      FlushBuffer(&lock);
+    }
+  }
+  log_record->lsn_ = next_lsn_++;
+  SerializeLogRecord(*log_record);
+  offset_ += log_record->size_;
+  segment_offset_ = (segment_offset_ + log_record->size_) % LOG_SEGMENT_SIZE;
+  return log_record->lsn_;
+}
+
+void LogManager::TruncateLog() {
+  FlushUntil(next_lsn_ - 1);
+  disk_manager_->RecycleLogSegments(disk_manager_->GetLogWriteOffset());
+}
+
+void LogManager::SerializeLogRecord(const LogRecord &log_record) {
+  char *pos = log_buffer_ + offset_;
+  auto write = [&pos](const void *src, size_t size) {
+    memcpy(pos, src, size);
+    pos += size;
+  };
+  // First, serialize the must have fields(20 bytes in total)
+  write(&log_record.size_, sizeof(int32_t));
+  write(&log_record.lsn_, sizeof(lsn_t));
+  write(&log_record.txn_id_, sizeof(txn_id_t));
+  write(&log_record.prev_lsn_, sizeof(lsn_t));
+  write(&log_record.log_record_type_, sizeof(LogRecordType));
+
+  switch (log_record.log_record_type_) {
+    case LogRecordType::INSERT:
+      write(&log_record.insert_rid_, sizeof(RID));
+      log_record.insert_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      write(&log_record.delete_rid_, sizeof(RID));
+      log_record.delete_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::UPDATE:
+      write(&log_record.update_rid_, sizeof(RID));
+      log_record.old_tuple_.SerializeTo(pos);
+      pos += sizeof(int32_t) + log_record.old_tuple_.GetLength();
+      log_record.new_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::DELTAUPDATE: {
+      write(&log_record.update_rid_, sizeof(RID));
+      write(&log_record.old_size_, sizeof(uint32_t));
+      write(&log_record.new_size_, sizeof(uint32_t));
+      auto range_count = static_cast<uint32_t>(log_record.delta_ranges_.size());
+      write(&range_count, sizeof(uint32_t));
+      for (const auto &range : log_record.delta_ranges_) {
+        auto length = static_cast<uint32_t>(range.data_.size());
+        write(&range.offset_, sizeof(uint32_t));
+        write(&length, sizeof(uint32_t));
+        write(range.data_.data(), length);
+      }
+      break;
+    }
+    case LogRecordType::NEWPAGE:
+      write(&log_record.prev_page_id_, sizeof(page_id_t));
+      write(&log_record.page_id_, sizeof(page_id_t));
+      break;
+    default:
+      // BEGIN/COMMIT/ABORT only carry the header
+      break;
+  }
+}
 
 }  // namespace bustub
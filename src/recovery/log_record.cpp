@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_record.cpp
+//
+// Identification: src/recovery/log_record.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_record.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+/** Returns the byte at offset i of the tuple, treating the tuple as zero-padded past its end. */
+inline char PaddedByteAt(const char *data, uint32_t size, uint32_t i) { return i < size ? data[i] : 0; }
+}  // namespace
+
+void LogRecord::ComputeDelta(const Tuple &old_tuple, const Tuple &new_tuple) {
+  // Two ranges separated by fewer equal bytes than a range header are cheaper to log as one range.
+  const uint32_t merge_gap = 2 * sizeof(int32_t);
+  const char *old_data = old_tuple.GetData();
+  const char *new_data = new_tuple.GetData();
+  const uint32_t length = std::max(old_size_, new_size_);
+  auto differs = [&](uint32_t i) {
+    return PaddedByteAt(old_data, old_size_, i) != PaddedByteAt(new_data, new_size_, i);
+  };
+
+  delta_ranges_.clear();
+  uint32_t i = 0;
+  while (i < length) {
+    if (!differs(i)) {
+      i++;
+      continue;
+    }
+    uint32_t start = i;
+    uint32_t end = i + 1;
+    for (uint32_t j = end; j < length && j - end < merge_gap; j++) {
+      if (differs(j)) {
+        end = j + 1;
+      }
+    }
+    DeltaRange range{start, std::string(end - start, '\0')};
+    for (uint32_t k = start; k < end; k++) {
+      range.data_[k - start] =
+          static_cast<char>(PaddedByteAt(old_data, old_size_, k) ^ PaddedByteAt(new_data, new_size_, k));
+    }
+    delta_ranges_.emplace_back(std::move(range));
+    i = end;
+  }
+}
+
+Tuple LogRecord::ApplyDelta(const Tuple &tuple) const {
+  assert(log_record_type_ == LogRecordType::DELTAUPDATE);
+  assert(tuple.GetLength() == old_size_ || tuple.GetLength() == new_size_);
+  const uint32_t target_size = tuple.GetLength() == old_size_ ? new_size_ : old_size_;
+  std::string buffer(std::max(old_size_, new_size_), '\0');
+  memcpy(buffer.data(), tuple.GetData(), tuple.GetLength());
+  for (const auto &range : delta_ranges_) {
+    for (uint32_t k = 0; k < range.data_.size(); k++) {
+      buffer[range.offset_ + k] = static_cast<char>(buffer[range.offset_ + k] ^ range.data_[k]);
+    }
+  }
+
+  Tuple result(tuple.GetRid());
+  result.size_ = target_size;
+  result.data_ = new char[target_size];
+  memcpy(result.data_, buffer.data(), target_size);
+  result.allocated_ = true;
+  return result;
+}
+
+}  // namespace bustub
@@ -12,6 +12,10 @@
 
 #include "recovery/log_recovery.h"
 
+#include <cstring>
+#include <string>
+
+#include "common/macros.h"
 #include "storage/page/table_page.h"
 
 namespace bustub {
@@ -20,7 +24,68 @@ namespace bustub {
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
-bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) { return false; }
+bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) {
+  const char *pos = data;
+  auto read = [&pos](void *dst, size_t size) {
+    memcpy(dst, pos, size);
+    pos += size;
+  };
+  // must have fields(20 bytes in total)
+  read(&log_record->size_, sizeof(int32_t));
+  read(&log_record->lsn_, sizeof(lsn_t));
+  read(&log_record->txn_id_, sizeof(txn_id_t));
+  read(&log_record->prev_lsn_, sizeof(lsn_t));
+  read(&log_record->log_record_type_, sizeof(LogRecordType));
+  // the tail of the log is zero filled, an invalid header marks its end
+  if (log_record->size_ < LogRecord::HEADER_SIZE || log_record->lsn_ == INVALID_LSN ||
+      log_record->log_record_type_ == LogRecordType::INVALID ||
+      log_record->log_record_type_ > LogRecordType::DELTAUPDATE) {
+    return false;
+  }
+
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      read(&log_record->insert_rid_, sizeof(RID));
+      log_record->insert_tuple_.DeserializeFrom(pos);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      read(&log_record->delete_rid_, sizeof(RID));
+      log_record->delete_tuple_.DeserializeFrom(pos);
+      break;
+    case LogRecordType::UPDATE:
+      read(&log_record->update_rid_, sizeof(RID));
+      log_record->old_tuple_.DeserializeFrom(pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.DeserializeFrom(pos);
+      break;
+    case LogRecordType::DELTAUPDATE: {
+      read(&log_record->update_rid_, sizeof(RID));
+      read(&log_record->old_size_, sizeof(uint32_t));
+      read(&log_record->new_size_, sizeof(uint32_t));
+      uint32_t range_count;
+      read(&range_count, sizeof(uint32_t));
+      log_record->delta_ranges_.clear();
+      for (uint32_t i = 0; i < range_count; i++) {
+        uint32_t offset;
+        uint32_t length;
+        read(&offset, sizeof(uint32_t));
+        read(&length, sizeof(uint32_t));
+        log_record->delta_ranges_.push_back({offset, std::string(pos, length)});
+        pos += length;
+      }
+      break;
+    }
+    case LogRecordType::NEWPAGE:
+      read(&log_record->prev_page_id_, sizeof(page_id_t));
+      read(&log_record->page_id_, sizeof(page_id_t));
+      break;
+    default:
+      break;
+  }
+  return true;
+}
 
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
@@ -29,12 +94,202 @@ bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record)
  *LSN with log_record's sequence number, and also build active_txn_ table &
  *lsn_mapping_ table
  */
-void LogRecovery::Redo() {}
+void LogRecovery::Redo() {
+  BUSTUB_ASSERT(!enable_logging, "Recovery must run with logging disabled.");
+  active_txn_.clear();
+  lsn_mapping_.clear();
+  // segments before the last checkpoint have been recycled, there is nothing to replay in them
+  offset_ = disk_manager_->GetLogStartOffset();
+  while (disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, offset_)) {
+    int pos = 0;
+    bool end_of_segment = false;
+    while (pos + LogRecord::HEADER_SIZE <= LOG_BUFFER_SIZE) {
+      // only deserialize records that are entirely in the buffer, the rest is read again with the next batch
+      int32_t size = *reinterpret_cast<int32_t *>(log_buffer_ + pos);
+      if (size > 0 && pos + size > LOG_BUFFER_SIZE) {
+        break;
+      }
+      LogRecord log_record;
+      if (size <= 0 || !DeserializeLogRecord(log_buffer_ + pos, &log_record)) {
+        // the zero padded rest of the segment
+        end_of_segment = true;
+        break;
+      }
+      lsn_mapping_[log_record.GetLSN()] = offset_ + pos;
+      if (log_record.GetLogRecordType() == LogRecordType::COMMIT ||
+          log_record.GetLogRecordType() == LogRecordType::ABORT) {
+        active_txn_.erase(log_record.GetTxnId());
+      } else {
+        active_txn_[log_record.GetTxnId()] = log_record.GetLSN();
+      }
+      RedoLogRecord(&log_record);
+      pos += size;
+    }
+    if (!end_of_segment) {
+      offset_ += pos;
+      continue;
+    }
+    if (pos == 0 && offset_ % LOG_SEGMENT_SIZE == 0) {
+      // a segment without records, the log ends here
+      break;
+    }
+    // the log continues at the start of the next segment
+    offset_ = (offset_ + pos + LOG_SEGMENT_SIZE - 1) / LOG_SEGMENT_SIZE * LOG_SEGMENT_SIZE;
+  }
+}
+
+void LogRecovery::RedoLogRecord(LogRecord *log_record) {
+  RID rid;
+  switch (log_record->GetLogRecordType()) {
+    case LogRecordType::INSERT:
+      rid = log_record->GetInsertRID();
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      rid = log_record->GetDeleteRID();
+      break;
+    case LogRecordType::UPDATE:
+    case LogRecordType::DELTAUPDATE:
+      rid = log_record->GetUpdateRID();
+      break;
+    case LogRecordType::NEWPAGE:
+      rid.Set(log_record->page_id_, 0);
+      break;
+    default:
+      return;
+  }
+
+  auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  BUSTUB_ASSERT(page != nullptr, "Buffer pool is out of frames during redo.");
+  if (page->GetLSN() >= log_record->GetLSN() && log_record->GetLogRecordType() != LogRecordType::NEWPAGE) {
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+    return;
+  }
+
+  Tuple old_tuple;
+  switch (log_record->GetLogRecordType()) {
+    case LogRecordType::INSERT: {
+      RID new_rid;
+      page->InsertTuple(log_record->GetInsertTuple(), &new_rid, nullptr, nullptr, nullptr);
+      BUSTUB_ASSERT(new_rid == rid, "Redo must place the tuple into its original slot.");
+      break;
+    }
+    case LogRecordType::MARKDELETE:
+      page->MarkDelete(rid, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE:
+      page->ApplyDelete(rid, nullptr, nullptr);
+      break;
+    case LogRecordType::ROLLBACKDELETE:
+      page->RollbackDelete(rid, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE:
+      page->UpdateTuple(log_record->GetUpdateTuple(), &old_tuple, rid, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::DELTAUPDATE: {
+      Tuple current;
+      page->GetTuple(rid, &current, nullptr, nullptr);
+      page->UpdateTuple(log_record->ApplyDelta(current), &old_tuple, rid, nullptr, nullptr, nullptr);
+      break;
+    }
+    case LogRecordType::NEWPAGE: {
+      if (page->GetLSN() < log_record->GetLSN()) {
+        page->Init(rid.GetPageId(), PAGE_SIZE, log_record->GetNewPageRecord(), nullptr, nullptr);
+      }
+      // the link from the previous page is not logged on its own, restore it along with the new page
+      page_id_t prev_page_id = log_record->GetNewPageRecord();
+      if (prev_page_id != INVALID_PAGE_ID) {
+        auto *prev_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(prev_page_id));
+        bool relink = prev_page->GetNextPageId() != rid.GetPageId();
+        if (relink) {
+          prev_page->SetNextPageId(rid.GetPageId());
+        }
+        buffer_pool_manager_->UnpinPage(prev_page_id, relink);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  page->SetLSN(std::max(page->GetLSN(), log_record->GetLSN()));
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
  *iterate through active txn map and undo each operation
  */
-void LogRecovery::Undo() {}
+void LogRecovery::Undo() {
+  BUSTUB_ASSERT(!enable_logging, "Recovery must run with logging disabled.");
+  for (const auto &[txn_id, last_lsn] : active_txn_) {
+    lsn_t lsn = last_lsn;
+    while (lsn != INVALID_LSN) {
+      auto it = lsn_mapping_.find(lsn);
+      BUSTUB_ASSERT(it != lsn_mapping_.end(), "Every lsn of an active transaction must have been seen by redo.");
+      disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, it->second);
+      LogRecord log_record;
+      bool success = DeserializeLogRecord(log_buffer_, &log_record);
+      BUSTUB_ASSERT(success, "Failed to read back a log record seen by redo.");
+      UndoLogRecord(&log_record);
+      lsn = log_record.GetPrevLSN();
+    }
+  }
+  active_txn_.clear();
+  lsn_mapping_.clear();
+}
+
+void LogRecovery::UndoLogRecord(LogRecord *log_record) {
+  RID rid;
+  switch (log_record->GetLogRecordType()) {
+    case LogRecordType::INSERT:
+      rid = log_record->GetInsertRID();
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      rid = log_record->GetDeleteRID();
+      break;
+    case LogRecordType::UPDATE:
+    case LogRecordType::DELTAUPDATE:
+      rid = log_record->GetUpdateRID();
+      break;
+    default:
+      // BEGIN and NEWPAGE leave nothing to undo, an empty page in the table heap is harmless
+      return;
+  }
+
+  auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  BUSTUB_ASSERT(page != nullptr, "Buffer pool is out of frames during undo.");
+  Tuple old_tuple;
+  switch (log_record->GetLogRecordType()) {
+    case LogRecordType::INSERT:
+      page->ApplyDelete(rid, nullptr, nullptr);
+      break;
+    case LogRecordType::MARKDELETE:
+      page->RollbackDelete(rid, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE: {
+      RID new_rid;
+      page->InsertTuple(log_record->GetDeleteTuple(), &new_rid, nullptr, nullptr, nullptr);
+      break;
+    }
+    case LogRecordType::ROLLBACKDELETE:
+      page->MarkDelete(rid, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE:
+      page->UpdateTuple(log_record->GetOriginalTuple(), &old_tuple, rid, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::DELTAUPDATE: {
+      Tuple current;
+      page->GetTuple(rid, &current, nullptr, nullptr);
+      page->UpdateTuple(log_record->ApplyDelta(current), &old_tuple, rid, nullptr, nullptr, nullptr);
+      break;
+    }
+    default:
+      break;
+  }
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+}
 
 }  // namespace bustub
@@ -11,8 +11,11 @@
 //===----------------------------------------------------------------------===//
 
 #include <sys/stat.h>
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <mutex>  // NOLINT
 #include <string>
@@ -26,8 +29,11 @@ namespace bustub {
 
 static char *buffer_used;
 
+/** Recycled log segments beyond this number are deleted instead. */
+static constexpr int MAX_SPARE_LOG_SEGMENTS = 4;
+
 /**
- * Constructor: open/create a single database file & log file
+ * Constructor: open/create a single database file, locate the log segments
  * @input db_file: database file name
  */
 DiskManager::DiskManager(const std::string &db_file)
@@ -39,17 +45,17 @@ DiskManager::DiskManager(const std::string &db_file)
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
+  // Continue the log at the segment following the last one that holds records, log segments are created lazily.
+  std::vector<int> segments = ListLogSegments();
+  if (!segments.empty()) {
+    log_write_offset_ = static_cast<int64_t>(segments.front()) * LOG_SEGMENT_SIZE;
+  }
+  for (int segment : segments) {
+    int32_t first_record_size = 0;
+    std::ifstream segment_io(GetLogSegmentName(segment), std::ios::binary);
+    segment_io.read(reinterpret_cast<char *>(&first_record_size), sizeof(first_record_size));
+    if (first_record_size != 0) {
+      log_write_offset_ = static_cast<int64_t>(segment + 1) * LOG_SEGMENT_SIZE;
     }
   }
 
@@ -149,17 +155,39 @@ void DiskManager::WriteLog(char *log_data, int size) {
     assert(flush_log_f_->wait_for(std::chrono::seconds(10)) == std::future_status::ready);
   }
 
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
+  // sequence write, switching to the next segment at every segment boundary
+  while (size > 0) {
+    auto segment = static_cast<int>(log_write_offset_ / LOG_SEGMENT_SIZE);
+    if (segment != log_segment_) {
+      log_io_.close();
+      std::string segment_name = GetLogSegmentName(segment);
+      if (GetFileSize(segment_name) != LOG_SEGMENT_SIZE) {
+        PreallocateLogSegment(segment_name);
+      }
+      log_io_.open(segment_name, std::ios::binary | std::ios::in | std::ios::out);
+      if (!log_io_.is_open()) {
+        throw Exception("can't open log segment file");
+      }
+      log_segment_ = segment;
+    }
+    auto segment_offset = static_cast<int>(log_write_offset_ % LOG_SEGMENT_SIZE);
+    int write_size = std::min(size, LOG_SEGMENT_SIZE - segment_offset);
+    log_io_.seekp(segment_offset);
+    log_io_.write(log_data, write_size);
 
-  // check for I/O error
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
-    return;
+    // check for I/O error
+    if (log_io_.bad()) {
+      LOG_DEBUG("I/O error while writing log");
+      return;
+    }
+    // needs to flush to keep disk file in sync
+    log_io_.flush();
+    log_data += write_size;
+    size -= write_size;
+    log_write_offset_ += write_size;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
   flush_log_ = false;
 }
 
@@ -168,29 +196,80 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * Always read from the beginning and perform sequence read
  * @return: false means already reach the end
  */
-bool DiskManager::ReadLog(char *log_data, int size, int offset) {
-  if (offset >= GetFileSize(log_name_)) {
+bool DiskManager::ReadLog(char *log_data, int size, int64_t offset) {
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
+  std::ifstream segment_io(GetLogSegmentName(static_cast<int>(offset / LOG_SEGMENT_SIZE)), std::ios::binary);
+  if (!segment_io.is_open()) {
     // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
+  auto segment_offset = static_cast<int>(offset % LOG_SEGMENT_SIZE);
+  int read_size = std::min(size, LOG_SEGMENT_SIZE - segment_offset);
+  segment_io.seekg(segment_offset);
+  segment_io.read(log_data, read_size);
 
-  if (log_io_.bad()) {
+  if (segment_io.bad()) {
     LOG_DEBUG("I/O error while reading log");
     return false;
   }
-  // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
+  // if the segment ends before reading "size"
+  int read_count = segment_io.gcount();
   if (read_count < size) {
-    log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
   }
 
   return true;
 }
 
+int64_t DiskManager::GetLogStartOffset() {
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
+  std::vector<int> segments = ListLogSegments();
+  return segments.empty() ? log_write_offset_ : static_cast<int64_t>(segments.front()) * LOG_SEGMENT_SIZE;
+}
+
+int64_t DiskManager::GetLogWriteOffset() {
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
+  return log_write_offset_;
+}
+
+void DiskManager::RecycleLogSegments(int64_t offset) {
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
+  std::vector<int> segments = ListLogSegments();
+  if (segments.empty()) {
+    return;
+  }
+  auto write_segment = static_cast<int>(log_write_offset_ / LOG_SEGMENT_SIZE);
+  int next_spare = std::max(segments.back(), write_segment) + 1;
+  int spares = 0;
+  for (int segment : segments) {
+    if (segment > write_segment) {
+      spares++;
+    }
+  }
+  for (int segment : segments) {
+    // the segment of the last record stays, even when nothing was written since the database started
+    int64_t segment_end = static_cast<int64_t>(segment + 1) * LOG_SEGMENT_SIZE;
+    if (segment_end > offset || segment_end >= log_write_offset_ || segment == log_segment_) {
+      break;
+    }
+    std::string segment_name = GetLogSegmentName(segment);
+    if (spares >= MAX_SPARE_LOG_SEGMENTS) {
+      std::remove(segment_name.c_str());
+      continue;
+    }
+    // Reuse the file as a future segment. It is zero filled again because recovery stops at the first empty record.
+    std::string spare_name = GetLogSegmentName(next_spare++);
+    std::rename(segment_name.c_str(), spare_name.c_str());
+    std::fstream spare_io(spare_name, std::ios::binary | std::ios::in | std::ios::out);
+    std::vector<char> zeros(PAGE_SIZE, 0);
+    for (int written = 0; written < LOG_SEGMENT_SIZE; written += PAGE_SIZE) {
+      spare_io.write(zeros.data(), std::min(PAGE_SIZE, LOG_SEGMENT_SIZE - written));
+    }
+    spare_io.flush();
+    spares++;
+  }
+}
+
 /**
  * Returns number of flushes made so far
  */
@@ -206,6 +285,34 @@ int DiskManager::GetNumWrites() const { return num_writes_; }
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
+std::string DiskManager::GetLogSegmentName(int segment) const { return log_name_ + "." + std::to_string(segment); }
+
+std::vector<int> DiskManager::ListLogSegments() const {
+  std::vector<int> segments;
+  std::filesystem::path log_path(log_name_);
+  std::filesystem::path directory = log_path.has_parent_path() ? log_path.parent_path() : ".";
+  std::string prefix = log_path.filename().string() + ".";
+  std::error_code error;
+  for (const auto &entry : std::filesystem::directory_iterator(directory, error)) {
+    std::string name = entry.path().filename().string();
+    if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+        name.find_first_not_of("0123456789", prefix.size()) == std::string::npos) {
+      segments.push_back(std::stoi(name.substr(prefix.size())));
+    }
+  }
+  std::sort(segments.begin(), segments.end());
+  return segments;
+}
+
+void DiskManager::PreallocateLogSegment(const std::string &segment_name) {
+  std::ofstream segment_io(segment_name, std::ios::binary | std::ios::trunc);
+  std::vector<char> zeros(PAGE_SIZE, 0);
+  for (int written = 0; written < LOG_SEGMENT_SIZE; written += PAGE_SIZE) {
+    segment_io.write(zeros.data(), std::min(PAGE_SIZE, LOG_SEGMENT_SIZE - written));
+  }
+  segment_io.flush();
+}
+
 /**
  * Private helper function to get disk file size
  */
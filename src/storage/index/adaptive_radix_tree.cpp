@@ -0,0 +1,688 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/adaptive_radix_tree.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/adaptive_radix_tree.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+namespace {
+/* Insert byte and child into the sorted keys and children of a Node4 or a Node16 with room for them */
+template <typename NodePtr>
+void InsertSorted(uint8_t *keys, NodePtr *children, int size, uint8_t byte, NodePtr child) {
+  int index = 0;
+  while (index < size && keys[index] < byte) {
+    index++;
+  }
+  memmove(keys + index + 1, keys + index, size - index);
+  memmove(children + index + 1, children + index, (size - index) * sizeof(NodePtr));
+  keys[index] = byte;
+  children[index] = child;
+}
+
+/* Remove the child at index from the keys and children of a Node4 or a Node16 */
+template <typename NodePtr>
+void RemoveSorted(uint8_t *keys, NodePtr *children, int size, int index) {
+  memmove(keys + index, keys + index + 1, size - index - 1);
+  memmove(children + index, children + index + 1, (size - index - 1) * sizeof(NodePtr));
+}
+}  // namespace
+
+INDEX_TEMPLATE_ARGUMENTS
+ADAPTIVERADIXTREE_TYPE::AdaptiveRadixTree(const KeyComparator &comparator) : comparator_(comparator) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+ADAPTIVERADIXTREE_TYPE::~AdaptiveRadixTree() {
+  if (root_ != nullptr) {
+    FreeNode(root_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool ADAPTIVERADIXTREE_TYPE::IsEmpty() {
+  latch_.RLock();
+  bool empty = root_ == nullptr;
+  latch_.RUnlock();
+  return empty;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Return the only value that associated with input key. The prefixes on the
+ * way down are compared as far as they are kept in the nodes, the leaf reached
+ * is then compared in full.
+ * @return : true means key exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool ADAPTIVERADIXTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) {
+  latch_.RLock();
+  const uint8_t *bytes = Bytes(key);
+  Node *node = root_;
+  uint32_t depth = 0;
+  while (node != nullptr && node->type_ != NodeType::LEAF) {
+    if (memcmp(node->prefix_, bytes + depth, std::min(node->prefix_size_, ART_PREFIX_SIZE)) != 0) {
+      node = nullptr;
+      break;
+    }
+    depth += node->prefix_size_;
+    Node **child = FindChild(node, bytes[depth]);
+    node = child == nullptr ? nullptr : *child;
+    depth++;
+  }
+  bool found = node != nullptr && memcmp(Bytes(static_cast<Leaf *>(node)->key_), bytes, KEY_SIZE) == 0;
+  if (found) {
+    result->emplace_back(static_cast<Leaf *>(node)->value_);
+  }
+  latch_.RUnlock();
+  return found;
+}
+
+/*
+ * Append the entries from lower to upper to result, in key order
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void ADAPTIVERADIXTREE_TYPE::ScanRange(const KeyType *lower, bool lower_inclusive, const KeyType *upper,
+                                       bool upper_inclusive, std::vector<MappingType> *result) {
+  latch_.RLock();
+  if (root_ != nullptr) {
+    ScanBelow(root_, 0, lower == nullptr ? nullptr : Bytes(*lower), lower_inclusive,
+              upper == nullptr ? nullptr : Bytes(*upper), upper_inclusive, result);
+  }
+  latch_.RUnlock();
+}
+
+/*
+ * Visit the children of node in the order of their key bytes. A bound is only
+ * passed on to the child on its path, the children between the bounds take
+ * every key below them and the ones outside are skipped.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void ADAPTIVERADIXTREE_TYPE::ScanBelow(Node *node, uint32_t depth, const uint8_t *lower, bool lower_inclusive,
+                                       const uint8_t *upper, bool upper_inclusive,
+                                       std::vector<MappingType> *result) const {
+  if (node->type_ == NodeType::LEAF) {
+    auto *leaf = static_cast<Leaf *>(node);
+    const uint8_t *key = Bytes(leaf->key_);
+    if (lower != nullptr) {
+      int cmp = memcmp(key, lower, KEY_SIZE);
+      if (cmp < 0 || (cmp == 0 && !lower_inclusive)) {
+        return;
+      }
+    }
+    if (upper != nullptr) {
+      int cmp = memcmp(key, upper, KEY_SIZE);
+      if (cmp > 0 || (cmp == 0 && !upper_inclusive)) {
+        return;
+      }
+    }
+    result->emplace_back(leaf->key_, leaf->value_);
+    return;
+  }
+
+  if (node->prefix_size_ > 0 && (lower != nullptr || upper != nullptr)) {
+    // every key below node has the whole prefix, which a leaf holds when the node does not
+    const uint8_t *prefix =
+        node->prefix_size_ <= ART_PREFIX_SIZE ? node->prefix_ : Bytes(Minimum(node)->key_) + depth;
+    if (lower != nullptr) {
+      int cmp = memcmp(prefix, lower + depth, node->prefix_size_);
+      if (cmp < 0) {
+        return;
+      }
+      lower = cmp == 0 ? lower : nullptr;
+    }
+    if (upper != nullptr) {
+      int cmp = memcmp(prefix, upper + depth, node->prefix_size_);
+      if (cmp > 0) {
+        return;
+      }
+      upper = cmp == 0 ? upper : nullptr;
+    }
+  }
+  depth += node->prefix_size_;
+
+  // returns false once the children are past the upper bound
+  auto visit = [&](uint8_t byte, Node *child) {
+    if (upper != nullptr && byte > upper[depth]) {
+      return false;
+    }
+    if (lower == nullptr || byte >= lower[depth]) {
+      ScanBelow(child, depth + 1, lower != nullptr && byte == lower[depth] ? lower : nullptr, lower_inclusive,
+                upper != nullptr && byte == upper[depth] ? upper : nullptr, upper_inclusive, result);
+    }
+    return true;
+  };
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *inner = static_cast<Node4 *>(node);
+      for (int i = 0; i < inner->num_children_ && visit(inner->keys_[i], inner->children_[i]); i++) {
+      }
+      break;
+    }
+    case NodeType::NODE16: {
+      auto *inner = static_cast<Node16 *>(node);
+      for (int i = 0; i < inner->num_children_ && visit(inner->keys_[i], inner->children_[i]); i++) {
+      }
+      break;
+    }
+    case NodeType::NODE48: {
+      auto *inner = static_cast<Node48 *>(node);
+      for (int byte = 0; byte < 256; byte++) {
+        if (inner->child_index_[byte] != 0 && !visit(byte, inner->children_[inner->child_index_[byte] - 1])) {
+          break;
+        }
+      }
+      break;
+    }
+    case NodeType::NODE256: {
+      auto *inner = static_cast<Node256 *>(node);
+      for (int byte = 0; byte < 256; byte++) {
+        if (inner->children_[byte] != nullptr && !visit(byte, inner->children_[byte])) {
+          break;
+        }
+      }
+      break;
+    }
+    case NodeType::LEAF:
+      break;
+  }
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert constant key & value pair into the tree
+ * @return: since we only support unique key, if user try to insert duplicate
+ * keys return false, otherwise return true.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool ADAPTIVERADIXTREE_TYPE::Insert(const KeyType &key, const ValueType &value) {
+  latch_.WLock();
+  bool inserted = InsertAt(&root_, key, value, 0);
+  latch_.WUnlock();
+  return inserted;
+}
+
+/*
+ * Insert the key & value pairs of items with the tree latched once
+ * @return: the number of pairs inserted, pairs with an existing key are skipped
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int ADAPTIVERADIXTREE_TYPE::InsertBatch(const std::vector<MappingType> &items) {
+  int inserted = 0;
+  latch_.WLock();
+  for (const auto &[key, value] : items) {
+    inserted += InsertAt(&root_, key, value, 0) ? 1 : 0;
+  }
+  latch_.WUnlock();
+  return inserted;
+}
+
+/*
+ * Insert key into the subtree at *ref, whose first depth key bytes are the
+ * ones of key. A leaf in the way is split into a Node4 over the two leaves, a
+ * prefix that key leaves early is split into a Node4 over the node and the new
+ * leaf.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool ADAPTIVERADIXTREE_TYPE::InsertAt(Node **ref, const KeyType &key, const ValueType &value, uint32_t depth) {
+  Node *node = *ref;
+  const uint8_t *bytes = Bytes(key);
+  if (node == nullptr) {
+    *ref = new Leaf(key, value);
+    return true;
+  }
+
+  if (node->type_ == NodeType::LEAF) {
+    const uint8_t *leaf_bytes = Bytes(static_cast<Leaf *>(node)->key_);
+    if (memcmp(leaf_bytes, bytes, KEY_SIZE) == 0) {
+      return false;
+    }
+    // the keys have the same size, so they differ in a byte after depth
+    uint32_t common = 0;
+    while (leaf_bytes[depth + common] == bytes[depth + common]) {
+      common++;
+    }
+    Node *split = new Node4();
+    split->prefix_size_ = common;
+    memcpy(split->prefix_, bytes + depth, std::min(common, ART_PREFIX_SIZE));
+    AddChild(&split, leaf_bytes[depth + common], node);
+    AddChild(&split, bytes[depth + common], new Leaf(key, value));
+    *ref = split;
+    return true;
+  }
+
+  if (node->prefix_size_ > 0) {
+    uint32_t common = PrefixMismatch(node, bytes, depth);
+    if (common < node->prefix_size_) {
+      Node *split = new Node4();
+      split->prefix_size_ = common;
+      memcpy(split->prefix_, node->prefix_, std::min(common, ART_PREFIX_SIZE));
+      // node keeps the part of its prefix after the byte it is found at in split
+      if (node->prefix_size_ <= ART_PREFIX_SIZE) {
+        AddChild(&split, node->prefix_[common], node);
+        node->prefix_size_ -= common + 1;
+        memmove(node->prefix_, node->prefix_ + common + 1, node->prefix_size_);
+      } else {
+        node->prefix_size_ -= common + 1;
+        const uint8_t *leaf_bytes = Bytes(Minimum(node)->key_);
+        AddChild(&split, leaf_bytes[depth + common], node);
+        memcpy(node->prefix_, leaf_bytes + depth + common + 1, std::min(node->prefix_size_, ART_PREFIX_SIZE));
+      }
+      AddChild(&split, bytes[depth + common], new Leaf(key, value));
+      *ref = split;
+      return true;
+    }
+    depth += node->prefix_size_;
+  }
+
+  Node **child = FindChild(node, bytes[depth]);
+  if (child != nullptr) {
+    return InsertAt(child, key, value, depth + 1);
+  }
+  AddChild(ref, bytes[depth], new Leaf(key, value));
+  return true;
+}
+
+/*
+ * Add child at byte to the inner node at *ref, which has no child there. A
+ * full node is replaced by one of the next size first.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void ADAPTIVERADIXTREE_TYPE::AddChild(Node **ref, uint8_t byte, Node *child) {
+  Node *node = *ref;
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *inner = static_cast<Node4 *>(node);
+      if (inner->num_children_ < 4) {
+        InsertSorted(inner->keys_, inner->children_, inner->num_children_, byte, child);
+        inner->num_children_++;
+        return;
+      }
+      auto *grown = new Node16();
+      CopyHeader(grown, inner);
+      memcpy(grown->keys_, inner->keys_, sizeof(inner->keys_));
+      memcpy(grown->children_, inner->children_, sizeof(inner->children_));
+      *ref = grown;
+      delete inner;
+      break;
+    }
+    case NodeType::NODE16: {
+      auto *inner = static_cast<Node16 *>(node);
+      if (inner->num_children_ < 16) {
+        InsertSorted(inner->keys_, inner->children_, inner->num_children_, byte, child);
+        inner->num_children_++;
+        return;
+      }
+      auto *grown = new Node48();
+      CopyHeader(grown, inner);
+      for (int i = 0; i < 16; i++) {
+        grown->children_[i] = inner->children_[i];
+        grown->child_index_[inner->keys_[i]] = i + 1;
+      }
+      *ref = grown;
+      delete inner;
+      break;
+    }
+    case NodeType::NODE48: {
+      auto *inner = static_cast<Node48 *>(node);
+      if (inner->num_children_ < 48) {
+        // removes leave holes, so the first free slot is looked for
+        int index = 0;
+        while (inner->children_[index] != nullptr) {
+          index++;
+        }
+        inner->children_[index] = child;
+        inner->child_index_[byte] = index + 1;
+        inner->num_children_++;
+        return;
+      }
+      auto *grown = new Node256();
+      CopyHeader(grown, inner);
+      for (int i = 0; i < 256; i++) {
+        if (inner->child_index_[i] != 0) {
+          grown->children_[i] = inner->children_[inner->child_index_[i] - 1];
+        }
+      }
+      *ref = grown;
+      delete inner;
+      break;
+    }
+    case NodeType::NODE256: {
+      auto *inner = static_cast<Node256 *>(node);
+      inner->children_[byte] = child;
+      inner->num_children_++;
+      return;
+    }
+    case NodeType::LEAF:
+      return;
+  }
+  AddChild(ref, byte, child);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Delete key & value pair associated with input key
+ * If current tree is empty, return immdiately.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void ADAPTIVERADIXTREE_TYPE::Remove(const KeyType &key) {
+  latch_.WLock();
+  RemoveAt(&root_, key, 0);
+  latch_.WUnlock();
+}
+
+/*
+ * Remove key from the subtree at *ref, whose first depth key bytes are the
+ * ones of key
+ * @return : whether the key was found
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool ADAPTIVERADIXTREE_TYPE::RemoveAt(Node **ref, const KeyType &key, uint32_t depth) {
+  Node *node = *ref;
+  const uint8_t *bytes = Bytes(key);
+  if (node == nullptr) {
+    return false;
+  }
+  if (node->type_ == NodeType::LEAF) {
+    // only the root can be a leaf here, a leaf below an inner node is removed from its parent
+    if (memcmp(Bytes(static_cast<Leaf *>(node)->key_), bytes, KEY_SIZE) != 0) {
+      return false;
+    }
+    delete static_cast<Leaf *>(node);
+    *ref = nullptr;
+    return true;
+  }
+  if (memcmp(node->prefix_, bytes + depth, std::min(node->prefix_size_, ART_PREFIX_SIZE)) != 0) {
+    return false;
+  }
+  depth += node->prefix_size_;
+  Node **child = FindChild(node, bytes[depth]);
+  if (child == nullptr) {
+    return false;
+  }
+  if ((*child)->type_ != NodeType::LEAF) {
+    return RemoveAt(child, key, depth + 1);
+  }
+  auto *leaf = static_cast<Leaf *>(*child);
+  if (memcmp(Bytes(leaf->key_), bytes, KEY_SIZE) != 0) {
+    return false;
+  }
+  RemoveChild(ref, bytes[depth], child);
+  delete leaf;
+  return true;
+}
+
+/*
+ * Remove the child at *child_ref, found at byte, from the inner node at *ref.
+ * A node left with few enough children is replaced by one of the next smaller
+ * size, and a Node4 left with a single child by that child, which takes the
+ * prefix of the node and the byte it was found at in front of its own prefix.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void ADAPTIVERADIXTREE_TYPE::RemoveChild(Node **ref, uint8_t byte, Node **child_ref) {
+  Node *node = *ref;
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *inner = static_cast<Node4 *>(node);
+      RemoveSorted(inner->keys_, inner->children_, inner->num_children_, child_ref - inner->children_);
+      inner->num_children_--;
+      if (inner->num_children_ > 1) {
+        return;
+      }
+      Node *child = inner->children_[0];
+      if (child->type_ != NodeType::LEAF) {
+        uint32_t prefix_size = inner->prefix_size_;
+        if (prefix_size < ART_PREFIX_SIZE) {
+          inner->prefix_[prefix_size] = inner->keys_[0];
+        }
+        prefix_size++;
+        if (prefix_size < ART_PREFIX_SIZE) {
+          uint32_t copied = std::min(child->prefix_size_, ART_PREFIX_SIZE - prefix_size);
+          memcpy(inner->prefix_ + prefix_size, child->prefix_, copied);
+          prefix_size += copied;
+        }
+        memcpy(child->prefix_, inner->prefix_, std::min(prefix_size, ART_PREFIX_SIZE));
+        child->prefix_size_ += inner->prefix_size_ + 1;
+      }
+      *ref = child;
+      delete inner;
+      return;
+    }
+    case NodeType::NODE16: {
+      auto *inner = static_cast<Node16 *>(node);
+      RemoveSorted(inner->keys_, inner->children_, inner->num_children_, child_ref - inner->children_);
+      inner->num_children_--;
+      if (inner->num_children_ > 3) {
+        return;
+      }
+      auto *shrunk = new Node4();
+      CopyHeader(shrunk, inner);
+      memcpy(shrunk->keys_, inner->keys_, inner->num_children_);
+      memcpy(shrunk->children_, inner->children_, inner->num_children_ * sizeof(Node *));
+      *ref = shrunk;
+      delete inner;
+      return;
+    }
+    case NodeType::NODE48: {
+      auto *inner = static_cast<Node48 *>(node);
+      inner->children_[inner->child_index_[byte] - 1] = nullptr;
+      inner->child_index_[byte] = 0;
+      inner->num_children_--;
+      if (inner->num_children_ > 12) {
+        return;
+      }
+      auto *shrunk = new Node16();
+      CopyHeader(shrunk, inner);
+      int index = 0;
+      for (int i = 0; i < 256; i++) {
+        if (inner->child_index_[i] != 0) {
+          shrunk->keys_[index] = i;
+          shrunk->children_[index++] = inner->children_[inner->child_index_[i] - 1];
+        }
+      }
+      *ref = shrunk;
+      delete inner;
+      return;
+    }
+    case NodeType::NODE256: {
+      auto *inner = static_cast<Node256 *>(node);
+      inner->children_[byte] = nullptr;
+      inner->num_children_--;
+      if (inner->num_children_ > 37) {
+        return;
+      }
+      auto *shrunk = new Node48();
+      CopyHeader(shrunk, inner);
+      int index = 0;
+      for (int i = 0; i < 256; i++) {
+        if (inner->children_[i] != nullptr) {
+          shrunk->children_[index++] = inner->children_[i];
+          shrunk->child_index_[i] = index;
+        }
+      }
+      *ref = shrunk;
+      delete inner;
+      return;
+    }
+    case NodeType::LEAF:
+      return;
+  }
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void ADAPTIVERADIXTREE_TYPE::FreeNode(Node *node) {
+  switch (node->type_) {
+    case NodeType::LEAF:
+      delete static_cast<Leaf *>(node);
+      return;
+    case NodeType::NODE4: {
+      auto *inner = static_cast<Node4 *>(node);
+      for (int i = 0; i < inner->num_children_; i++) {
+        FreeNode(inner->children_[i]);
+      }
+      delete inner;
+      return;
+    }
+    case NodeType::NODE16: {
+      auto *inner = static_cast<Node16 *>(node);
+      for (int i = 0; i < inner->num_children_; i++) {
+        FreeNode(inner->children_[i]);
+      }
+      delete inner;
+      return;
+    }
+    case NodeType::NODE48: {
+      auto *inner = static_cast<Node48 *>(node);
+      for (Node *child : inner->children_) {
+        if (child != nullptr) {
+          FreeNode(child);
+        }
+      }
+      delete inner;
+      return;
+    }
+    case NodeType::NODE256: {
+      auto *inner = static_cast<Node256 *>(node);
+      for (Node *child : inner->children_) {
+        if (child != nullptr) {
+          FreeNode(child);
+        }
+      }
+      delete inner;
+      return;
+    }
+  }
+}
+
+/*
+ * The slot of the child of an inner node at byte, nullptr if there is none
+ */
+INDEX_TEMPLATE_ARGUMENTS
+typename ADAPTIVERADIXTREE_TYPE::Node **ADAPTIVERADIXTREE_TYPE::FindChild(Node *node, uint8_t byte) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *inner = static_cast<Node4 *>(node);
+      for (int i = 0; i < inner->num_children_; i++) {
+        if (inner->keys_[i] == byte) {
+          return &inner->children_[i];
+        }
+      }
+      return nullptr;
+    }
+    case NodeType::NODE16: {
+      auto *inner = static_cast<Node16 *>(node);
+      for (int i = 0; i < inner->num_children_; i++) {
+        if (inner->keys_[i] == byte) {
+          return &inner->children_[i];
+        }
+      }
+      return nullptr;
+    }
+    case NodeType::NODE48: {
+      auto *inner = static_cast<Node48 *>(node);
+      return inner->child_index_[byte] == 0 ? nullptr : &inner->children_[inner->child_index_[byte] - 1];
+    }
+    case NodeType::NODE256: {
+      auto *inner = static_cast<Node256 *>(node);
+      return inner->children_[byte] == nullptr ? nullptr : &inner->children_[byte];
+    }
+    case NodeType::LEAF:
+      break;
+  }
+  return nullptr;
+}
+
+/*
+ * The leaf of the smallest key below node
+ */
+INDEX_TEMPLATE_ARGUMENTS
+typename ADAPTIVERADIXTREE_TYPE::Leaf *ADAPTIVERADIXTREE_TYPE::Minimum(Node *node) {
+  while (node->type_ != NodeType::LEAF) {
+    switch (node->type_) {
+      case NodeType::NODE4:
+        node = static_cast<Node4 *>(node)->children_[0];
+        break;
+      case NodeType::NODE16:
+        node = static_cast<Node16 *>(node)->children_[0];
+        break;
+      case NodeType::NODE48: {
+        auto *inner = static_cast<Node48 *>(node);
+        int byte = 0;
+        while (inner->child_index_[byte] == 0) {
+          byte++;
+        }
+        node = inner->children_[inner->child_index_[byte] - 1];
+        break;
+      }
+      case NodeType::NODE256: {
+        auto *inner = static_cast<Node256 *>(node);
+        int byte = 0;
+        while (inner->children_[byte] == nullptr) {
+          byte++;
+        }
+        node = inner->children_[byte];
+        break;
+      }
+      case NodeType::LEAF:
+        break;
+    }
+  }
+  return static_cast<Leaf *>(node);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ADAPTIVERADIXTREE_TYPE::CopyHeader(Node *to, const Node *from) {
+  to->num_children_ = from->num_children_;
+  to->prefix_size_ = from->prefix_size_;
+  memcpy(to->prefix_, from->prefix_, std::min(from->prefix_size_, ART_PREFIX_SIZE));
+}
+
+/*
+ * The number of bytes of the prefix of node that key has from depth on. The
+ * part of a long prefix that the node does not keep is read from a leaf.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t ADAPTIVERADIXTREE_TYPE::PrefixMismatch(Node *node, const uint8_t *key, uint32_t depth) {
+  uint32_t kept = std::min(node->prefix_size_, ART_PREFIX_SIZE);
+  uint32_t index = 0;
+  while (index < kept && node->prefix_[index] == key[depth + index]) {
+    index++;
+  }
+  if (index < kept || node->prefix_size_ <= ART_PREFIX_SIZE) {
+    return index;
+  }
+  const uint8_t *leaf_key = Bytes(Minimum(node)->key_);
+  while (index < node->prefix_size_ && leaf_key[depth + index] == key[depth + index]) {
+    index++;
+  }
+  return index;
+}
+
+template class AdaptiveRadixTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class AdaptiveRadixTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class AdaptiveRadixTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class AdaptiveRadixTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class AdaptiveRadixTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
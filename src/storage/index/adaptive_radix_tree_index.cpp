@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/adaptive_radix_tree_index.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/adaptive_radix_tree_index.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ADAPTIVERADIXTREE_INDEX_TYPE::AdaptiveRadixTreeIndex(std::unique_ptr<IndexMetadata> &&metadata)
+    : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()), container_(comparator_) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ADAPTIVERADIXTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // construct insert index key
+  KeyType index_key;
+  index_key.SetFromKey(key, GetKeySchema());
+
+  container_.Insert(index_key, rid);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ADAPTIVERADIXTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // construct delete index key
+  KeyType index_key;
+  index_key.SetFromKey(key, GetKeySchema());
+
+  container_.Remove(index_key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ADAPTIVERADIXTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  // construct scan index key
+  KeyType index_key;
+  index_key.SetFromKey(key, GetKeySchema());
+
+  container_.GetValue(index_key, result);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ADAPTIVERADIXTREE_INDEX_TYPE::InsertEntries(std::vector<std::pair<Tuple, RID>> *entries,
+                                                 Transaction *transaction) {
+  // the whole batch goes in under one latch, in the order of the entries so that the first entry of a key is kept
+  std::vector<std::pair<KeyType, ValueType>> pairs(entries->size());
+  for (size_t i = 0; i < entries->size(); i++) {
+    pairs[i].first.SetFromKey((*entries)[i].first, GetKeySchema());
+    pairs[i].second = (*entries)[i].second;
+  }
+  container_.InsertBatch(pairs);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ADAPTIVERADIXTREE_INDEX_TYPE::ScanRange(const KeyType *lower, bool lower_inclusive, const KeyType *upper,
+                                             bool upper_inclusive, std::vector<RID> *result) {
+  std::vector<std::pair<KeyType, ValueType>> entries;
+  container_.ScanRange(lower, lower_inclusive, upper, upper_inclusive, &entries);
+  for (const auto &entry : entries) {
+    result->emplace_back(entry.second);
+  }
+}
+
+template class AdaptiveRadixTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
+template class AdaptiveRadixTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class AdaptiveRadixTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class AdaptiveRadixTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class AdaptiveRadixTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
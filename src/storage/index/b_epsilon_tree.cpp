@@ -0,0 +1,628 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/b_epsilon_tree.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/b_epsilon_tree.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/key_search.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+INDEX_TEMPLATE_ARGUMENTS
+BEPSILONTREE_TYPE::BEpsilonTree(std::string name, BufferPoolManager *buffer_pool_manager,
+                                const KeyComparator &comparator, int leaf_max_size, int internal_max_size,
+                                int buffer_size)
+    : index_name_(std::move(name)),
+      root_page_id_(INVALID_PAGE_ID),
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      leaf_max_size_(leaf_max_size),
+      internal_max_size_(internal_max_size),
+      buffer_size_(buffer_size) {
+  if (internal_max_size < 3 || buffer_size < 1 ||
+      INTERNAL_PAGE_HEADER_SIZE + internal_max_size * (sizeof(uint16_t) + sizeof(KeyType) + sizeof(page_id_t)) +
+              sizeof(int) + buffer_size * sizeof(Message) >
+          PAGE_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "the pivots and the message buffer do not fit in an internal page");
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BEPSILONTREE_TYPE::IsEmpty() {
+  latch_.RLock();
+  bool empty = root_page_id_ == INVALID_PAGE_ID;
+  latch_.RUnlock();
+  return empty;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Return the only value that associated with input key.
+ * @return : true means key exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BEPSILONTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
+  latch_.RLock();
+  ValueType value;
+  bool found = Lookup(key, &value);
+  latch_.RUnlock();
+  if (found) {
+    result->emplace_back(value);
+  }
+  return found;
+}
+
+/*
+ * Find the value of key, with the tree latch held. The first message for the
+ * key on the way down is the newest one and decides, otherwise the leaf.
+ * value may be null.
+ * @return : true means key exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BEPSILONTREE_TYPE::Lookup(const KeyType &key, ValueType *value) {
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  while (!reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    int index = MessageIndex(page, key);
+    if (index < BufferSize(page) && comparator_(Messages(page)[index].key_, key) == 0) {
+      // the message is read before the page is unpinned, as a concurrent reader may evict it then
+      bool is_insert = Messages(page)[index].is_insert_;
+      if (is_insert && value != nullptr) {
+        *value = Messages(page)[index].value_;
+      }
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return is_insert;
+    }
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(page->GetData())->Lookup(key, comparator_);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = buffer_pool_manager_->FetchPage(child_page_id);
+  }
+  bool found = reinterpret_cast<LeafPage *>(page->GetData())->Lookup(key, value, comparator_);
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert constant key & value pair as a message into the root buffer, after a
+ * point query for the key, which reads the leaf unless a message for the key
+ * is buffered on the way.
+ * @return: since we only support unique key, if user try to insert duplicate
+ * keys return false, otherwise return true.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BEPSILONTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  latch_.WLock();
+  bool exists = Lookup(key, nullptr);
+  if (!exists) {
+    Put(Message{key, value, true});
+  }
+  latch_.WUnlock();
+  return !exists;
+}
+
+/*
+ * Put message into the buffer of the root, flushing the buffer first if it has
+ * no room. A tree that is a lone leaf takes the message right away.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BEPSILONTREE_TYPE::Put(const Message &message) {
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    if (message.is_insert_) {
+      StartNewTree(message.key_, message.value_);
+    }
+    return;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    if (!LeafIsFull(reinterpret_cast<LeafPage *>(page->GetData()), message)) {
+      ApplyToLeaf(nullptr, page, &message, 1);
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      return;
+    }
+    // the leaf splits below a new root, whose buffer then takes the message
+    Page *root_page = GrowRoot(page);
+    SplitChild(reinterpret_cast<InternalPage *>(root_page->GetData()), page);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    page = root_page;
+  }
+  while (BufferSize(page) == buffer_size_) {
+    int index = MessageIndex(page, message.key_);
+    if (index < BufferSize(page) && comparator_(Messages(page)[index].key_, message.key_) == 0) {
+      break;
+    }
+    auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+    if (node->GetSize() >= node->GetMaxSize()) {
+      Page *root_page = GrowRoot(page);
+      SplitChild(reinterpret_cast<InternalPage *>(root_page->GetData()), page);
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      page = root_page;
+    } else {
+      FlushOnce(page);
+    }
+  }
+  PutInto(page, message);
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+}
+
+/*
+ * Put message into the buffer of the internal page, over the message for the
+ * same key if there is one, which is older. The buffer must have room for it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BEPSILONTREE_TYPE::PutInto(Page *page, const Message &message) {
+  Message *messages = Messages(page);
+  int &size = BufferSize(page);
+  int index = MessageIndex(page, message.key_);
+  if (index < size && comparator_(messages[index].key_, message.key_) == 0) {
+    messages[index] = message;
+    return;
+  }
+  BUSTUB_ASSERT(size < buffer_size_, "the buffer has room for the message");
+  std::copy_backward(messages + index, messages + size, messages + size + 1);
+  messages[index] = message;
+  size++;
+}
+
+/*
+ * Create the root leaf holding the first entry
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BEPSILONTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new root page");
+  }
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf_page->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  leaf_page->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+/*****************************************************************************
+ * FLUSH
+ *****************************************************************************/
+/*
+ * Move the messages of the internal page headed to the child that has the most
+ * of them down a level. A leaf child applies them until it splits, an internal
+ * child takes as many as its buffer holds after it was flushed itself if it was
+ * full. A full internal child is split instead, so at most one entry is added to
+ * the page, which must have room for it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BEPSILONTREE_TYPE::FlushOnce(Page *page) {
+  auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+  Message *messages = Messages(page);
+  const int size = BufferSize(page);
+  int batch_begin = 0;
+  int batch_end = 0;
+  int batch_child = 0;
+  for (int begin = 0; begin < size;) {
+    int child = node->LookupIndex(messages[begin].key_, comparator_);
+    int end = child + 1 < node->GetSize() ? MessageIndex(page, node->KeyAt(child + 1)) : size;
+    if (end - begin > batch_end - batch_begin) {
+      batch_begin = begin;
+      batch_end = end;
+      batch_child = child;
+    }
+    begin = end;
+  }
+
+  Page *child_page = buffer_pool_manager_->FetchPage(node->ValueAt(batch_child));
+  auto *child_node = reinterpret_cast<InternalPage *>(child_page->GetData());
+  int moved = 0;
+  if (child_node->IsLeafPage()) {
+    moved = ApplyToLeaf(node, child_page, messages + batch_begin, batch_end - batch_begin);
+  } else if (child_node->GetSize() >= child_node->GetMaxSize()) {
+    SplitChild(node, child_page);
+  } else {
+    if (BufferSize(child_page) == buffer_size_) {
+      FlushOnce(child_page);
+    }
+    while (batch_begin + moved < batch_end) {
+      const Message &message = messages[batch_begin + moved];
+      if (BufferSize(child_page) == buffer_size_) {
+        int index = MessageIndex(child_page, message.key_);
+        if (index == buffer_size_ || comparator_(Messages(child_page)[index].key_, message.key_) != 0) {
+          break;
+        }
+      }
+      PutInto(child_page, message);
+      moved++;
+    }
+  }
+  std::copy(messages + batch_begin + moved, messages + size, messages + batch_begin);
+  BufferSize(page) -= moved;
+  buffer_pool_manager_->UnpinPage(child_page->GetPageId(), true);
+}
+
+/*
+ * Apply count messages, in key order, to the leaf held by leaf_page, up to the
+ * first insert that would fill the leaf. The leaf is then split into parent and
+ * the rest of the messages is left for later. parent may only be null if the
+ * leaf is known to take every message.
+ * @return the number of messages applied
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BEPSILONTREE_TYPE::ApplyToLeaf(InternalPage *parent, Page *leaf_page, const Message *messages, int count) {
+  auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  int applied = 0;
+  for (; applied < count && !LeafIsFull(leaf, messages[applied]); applied++) {
+    leaf->RemoveAndDeleteRecord(messages[applied].key_, comparator_);
+    if (messages[applied].is_insert_) {
+      leaf->Insert(messages[applied].key_, messages[applied].value_, comparator_);
+    }
+  }
+  if (applied < count) {
+    SplitChild(parent, leaf_page);
+  }
+  return applied;
+}
+
+/*
+ * Whether message inserts a new key that would fill the leaf
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BEPSILONTREE_TYPE::LeafIsFull(LeafPage *leaf, const Message &message) const {
+  return message.is_insert_ && leaf->GetSize() + 1 >= leaf->MaxSizeFor(message.key_) &&
+         !leaf->Lookup(message.key_, nullptr, comparator_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BEPSILONTREE_TYPE::Flush() {
+  latch_.WLock();
+  FlushAll();
+  latch_.WUnlock();
+}
+
+/*
+ * Flush every buffer down to the leaves. The leaves are visited in key order,
+ * each one once every buffer on its path is empty, flushing the first buffer
+ * on the path that is not. Nothing is flushed towards a leaf that was passed,
+ * since its messages can only be on its path.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BEPSILONTREE_TYPE::FlushAll() {
+  bool left_most = true;
+  KeyType key;
+  while (root_page_id_ != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+    auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+    if (!node->IsLeafPage() && node->GetSize() >= node->GetMaxSize()) {
+      Page *root_page = GrowRoot(page);
+      SplitChild(reinterpret_cast<InternalPage *>(root_page->GetData()), page);
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      page = root_page;
+      node = reinterpret_cast<InternalPage *>(page->GetData());
+    }
+    // the upper bound of the keys below page, the tightest one met so far
+    bool has_upper = false;
+    KeyType upper;
+    bool flushed = false;
+    while (!node->IsLeafPage()) {
+      if (BufferSize(page) > 0) {
+        FlushOnce(page);
+        flushed = true;
+        break;
+      }
+      int index = left_most ? 0 : node->LookupIndex(key, comparator_);
+      if (index + 1 < node->GetSize()) {
+        upper = node->KeyAt(index + 1);
+        has_upper = true;
+      }
+      Page *child_page = buffer_pool_manager_->FetchPage(node->ValueAt(index));
+      auto *child = reinterpret_cast<InternalPage *>(child_page->GetData());
+      if (!child->IsLeafPage() && child->GetSize() >= child->GetMaxSize()) {
+        // split it first, so that it has room for what its flushes add
+        SplitChild(node, child_page);
+        buffer_pool_manager_->UnpinPage(child_page->GetPageId(), true);
+        flushed = true;
+        break;
+      }
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      page = child_page;
+      node = child;
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    if (flushed) {
+      continue;
+    }
+    if (!has_upper) {
+      return;
+    }
+    key = upper;
+    left_most = false;
+  }
+}
+
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+/*
+ * Make a new internal root over the pinned root page, with an empty buffer and
+ * the old root as its only child, to split the old root into.
+ * @return the pinned new root page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BEPSILONTREE_TYPE::GrowRoot(Page *root_page) {
+  page_id_t new_root_id;
+  Page *page = buffer_pool_manager_->NewPage(&new_root_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new root page");
+  }
+  auto *new_root = reinterpret_cast<InternalPage *>(page->GetData());
+  new_root->Init(new_root_id, INVALID_PAGE_ID, internal_max_size_, BufferBytes());
+  // the key of the first child is never looked at
+  std::pair<KeyType, page_id_t> child(KeyType(), root_page->GetPageId());
+  new_root->CopyNFrom(&child, 1, buffer_pool_manager_);
+  BufferSize(page) = 0;
+  root_page_id_ = new_root_id;
+  UpdateRootPageId(0);
+  return page;
+}
+
+/*
+ * Split the full node held by page into a new right sibling, which takes the
+ * upper half of its entries and the messages headed to them, and add the
+ * sibling to parent, which must have room for it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BEPSILONTREE_TYPE::SplitChild(InternalPage *parent, Page *page) {
+  page_id_t new_page_id;
+  Page *new_page = buffer_pool_manager_->NewPage(&new_page_id);
+  if (new_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page for split");
+  }
+  KeyType separator;
+  if (reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    auto *new_leaf = reinterpret_cast<LeafPage *>(new_page->GetData());
+    new_leaf->Init(new_page_id, parent->GetPageId(), leaf_max_size_);
+    leaf->MoveHalfTo(new_leaf);
+    new_leaf->SetNextPageId(leaf->GetNextPageId());
+    leaf->SetNextPageId(new_page_id);
+    separator = InternalPage::ShortestSeparator(leaf->KeyAt(leaf->GetSize() - 1), new_leaf->KeyAt(0));
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+    auto *new_internal = reinterpret_cast<InternalPage *>(new_page->GetData());
+    new_internal->Init(new_page_id, parent->GetPageId(), internal_max_size_, BufferBytes());
+    internal->MoveHalfTo(new_internal, buffer_pool_manager_);
+    separator = new_internal->KeyAt(0);
+    int from = MessageIndex(page, separator);
+    std::copy(Messages(page) + from, Messages(page) + BufferSize(page), Messages(new_page));
+    BufferSize(new_page) = BufferSize(page) - from;
+    BufferSize(page) = from;
+  }
+  parent->InsertNodeAfter(page->GetPageId(), separator, new_page_id);
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Delete key & value pair associated with input key, as a message into the
+ * root buffer.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BEPSILONTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  latch_.WLock();
+  Put(Message{key, ValueType(), false});
+  latch_.WUnlock();
+}
+
+/*
+ * Delete every page of the tree, with the messages still buffered in it, and
+ * leave it empty.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BEPSILONTREE_TYPE::Clear() {
+  latch_.WLock();
+  std::vector<page_id_t> pages;
+  if (root_page_id_ != INVALID_PAGE_ID) {
+    pages.push_back(root_page_id_);
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(0);
+  }
+  while (!pages.empty()) {
+    page_id_t page_id = pages.back();
+    pages.pop_back();
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (!node->IsLeafPage()) {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      for (int i = 0; i < internal->GetSize(); i++) {
+        pages.push_back(internal->ValueAt(i));
+      }
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  latch_.WUnlock();
+}
+
+/*****************************************************************************
+ * INDEX ITERATOR
+ *****************************************************************************/
+/*
+ * The iterators read one leaf at a time with the tree latch shared, so that
+ * writers only wait for them while they read a leaf and the messages for it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+typename BEPSILONTREE_TYPE::Iterator BEPSILONTREE_TYPE::Begin() {
+  Iterator iterator;
+  iterator.tree_ = this;
+  iterator.has_next_ = ReadLeaf(KeyType(), true, &iterator.items_, &iterator.next_key_);
+  iterator.SkipExhaustedLeaves();
+  return iterator;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename BEPSILONTREE_TYPE::Iterator BEPSILONTREE_TYPE::Begin(const KeyType &key) {
+  Iterator iterator;
+  iterator.tree_ = this;
+  iterator.has_next_ = ReadLeaf(key, false, &iterator.items_, &iterator.next_key_);
+  iterator.SkipExhaustedLeaves();
+  return iterator;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename BEPSILONTREE_TYPE::Iterator &BEPSILONTREE_TYPE::Iterator::operator++() {
+  index_++;
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BEPSILONTREE_TYPE::Iterator::SkipExhaustedLeaves() {
+  while (index_ == items_.size() && has_next_) {
+    items_.clear();
+    index_ = 0;
+    KeyType key = next_key_;
+    has_next_ = tree_->ReadLeaf(key, false, &items_, &next_key_);
+  }
+}
+
+/*
+ * Copy the entries of the leaf that covers key, the left most one if
+ * left_most is set, from key on into items. The messages for them in the
+ * buffers on the way down are applied, the one higher up first for a key as it
+ * is the newest one. Sets next_key to the first key the next leaf covers.
+ * @return : false when the leaf is the last one
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BEPSILONTREE_TYPE::ReadLeaf(const KeyType &key, bool left_most, std::vector<MappingType> *items,
+                                 KeyType *next_key) {
+  latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    latch_.RUnlock();
+    return false;
+  }
+  // the messages from key on, level by level, and the upper bound of the keys below page, the tightest one met so far
+  std::vector<Message> messages;
+  bool has_upper = false;
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  while (!reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+    int begin = left_most ? 0 : MessageIndex(page, key);
+    int end = BufferSize(page);
+    if (has_upper) {
+      end = MessageIndex(page, *next_key);
+    }
+    messages.insert(messages.end(), Messages(page) + begin, Messages(page) + end);
+    int index = left_most ? 0 : node->LookupIndex(key, comparator_);
+    if (index + 1 < node->GetSize()) {
+      *next_key = node->KeyAt(index + 1);
+      has_upper = true;
+    }
+    page_id_t child_page_id = node->ValueAt(index);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = buffer_pool_manager_->FetchPage(child_page_id);
+  }
+  if (has_upper) {
+    messages.erase(std::remove_if(messages.begin(), messages.end(),
+                                  [&](const Message &message) { return comparator_(message.key_, *next_key) >= 0; }),
+                   messages.end());
+  }
+  // sorted by key, the newest message for a key first
+  std::stable_sort(messages.begin(), messages.end(), [&](const Message &left, const Message &right) {
+    return comparator_(left.key_, right.key_) < 0;
+  });
+
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = left_most ? 0 : leaf->KeyIndex(key, comparator_);
+  size_t next = 0;
+  while (index < leaf->GetSize() || next < messages.size()) {
+    int order = index == leaf->GetSize()   ? 1
+                : next == messages.size() ? -1
+                                          : comparator_(leaf->KeyAt(index), messages[next].key_);
+    if (order < 0) {
+      items->emplace_back(leaf->GetItem(index++));
+      continue;
+    }
+    const Message &message = messages[next];
+    if (message.is_insert_) {
+      items->emplace_back(message.key_, message.value_);
+    }
+    // skip the older messages for the key, and its entry in the leaf
+    while (next < messages.size() && comparator_(messages[next].key_, message.key_) == 0) {
+      next++;
+    }
+    if (order == 0) {
+      index++;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  latch_.RUnlock();
+  return has_upper;
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+typename BEPSILONTREE_TYPE::Message *BEPSILONTREE_TYPE::Messages(Page *page) const {
+  return reinterpret_cast<Message *>(page->GetData() + PAGE_SIZE - buffer_size_ * sizeof(Message));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BEPSILONTREE_TYPE::BufferBytes() const {
+  return sizeof(int) + buffer_size_ * sizeof(Message);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int &BEPSILONTREE_TYPE::BufferSize(Page *page) const {
+  return *reinterpret_cast<int *>(reinterpret_cast<char *>(Messages(page)) - sizeof(int));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BEPSILONTREE_TYPE::MessageIndex(Page *page, const KeyType &key) const {
+  const Message *messages = Messages(page);
+  return KeySearch<KeyType, KeyComparator>::LowerBound(
+      key, 0, BufferSize(page), [messages](int i) -> const KeyType & { return messages[i].key_; }, comparator_);
+}
+
+/*
+ * Update/Insert root page id in header page, see BPlusTree::UpdateRootPageId
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BEPSILONTREE_TYPE::UpdateRootPageId(int insert_record) {
+  auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  header_page->WLatch();
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
+    header_page->UpdateRecord(index_name_, root_page_id_);
+  }
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+template class BEpsilonTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class BEpsilonTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class BEpsilonTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class BEpsilonTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class BEpsilonTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
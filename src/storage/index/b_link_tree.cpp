@@ -0,0 +1,402 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/b_link_tree.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/b_link_tree.h"
+
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+INDEX_TEMPLATE_ARGUMENTS
+BLINKTREE_TYPE::BLinkTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                          int leaf_max_size, int internal_max_size)
+    : index_name_(std::move(name)),
+      root_page_id_(INVALID_PAGE_ID),
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      leaf_max_size_(leaf_max_size),
+      internal_max_size_(internal_max_size) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BLINKTREE_TYPE::IsEmpty() { return GetRootPageId() == INVALID_PAGE_ID; }
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Return the only value that associated with input key
+ * @return : true means key exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BLINKTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
+  Page *page = FindNode(key, false, 0, false, nullptr);
+  if (page == nullptr) {
+    return false;
+  }
+  ValueType value;
+  bool found = reinterpret_cast<LeafPage *>(page->GetData())->Lookup(key, &value, comparator_);
+  if (found) {
+    result->emplace_back(value);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert constant key & value pair into the leaf that covers the key, then
+ * split it if it is full.
+ * @return: since we only support unique key, if user try to insert duplicate
+ * keys return false, otherwise return true.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BLINKTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  std::vector<page_id_t> path;
+  Page *page = FindNode(key, false, 0, true, &path);
+  while (page == nullptr) {
+    {
+      std::scoped_lock latch(root_latch_);
+      if (root_page_id_ == INVALID_PAGE_ID) {
+        StartNewTree(key, value);
+        return true;
+      }
+    }
+    page = FindNode(key, false, 0, true, &path);
+  }
+
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  if (leaf_page->Lookup(key, nullptr, comparator_)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+  if (leaf_page->GetSize() >= leaf_page->MaxSizeFor(key)) {
+    // the key is too long, or shares too few bytes with the keys of the leaf, to fit in, split it and try again
+    Split(page, &path);
+    return Insert(key, value, transaction);
+  }
+  leaf_page->Insert(key, value, comparator_);
+  if (leaf_page->GetSize() < leaf_page->GetMaxSize()) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    return true;
+  }
+  Split(page, &path);
+  return true;
+}
+
+/*
+ * Create the root leaf holding the first entry, with root_latch_ held
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new root page");
+  }
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf_page->Init(page_id, INVALID_PAGE_ID, leaf_max_size_, sizeof(Trailer));
+  *GetTrailer(page) = Trailer{KeyType(), INVALID_PAGE_ID, 0, false};
+  leaf_page->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+/*
+ * Split the write latched, full node held by page, then insert the separator
+ * into the parent, splitting upwards as long as nodes overflow.
+ * The upper half of a node moves to a new right sibling that inherits its high
+ * key and right link, so the sibling is reachable through the right link before
+ * the parent knows about it. The parent is latched before the split node is
+ * released. path holds the internal pages met on the way down, root first.
+ * The separator of two leaves is the shortest key between them.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::Split(Page *page, std::vector<page_id_t> *path) {
+  while (true) {
+    page_id_t new_page_id;
+    Page *new_page = buffer_pool_manager_->NewPage(&new_page_id);
+    if (new_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page for split");
+    }
+    KeyType separator;
+    if (reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+      auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      auto *new_leaf = reinterpret_cast<LeafPage *>(new_page->GetData());
+      new_leaf->Init(new_page_id, INVALID_PAGE_ID, leaf_max_size_, sizeof(Trailer));
+      leaf->MoveHalfTo(new_leaf);
+      new_leaf->SetNextPageId(leaf->GetNextPageId());
+      leaf->SetNextPageId(new_page_id);
+      separator = InternalPage::ShortestSeparator(leaf->KeyAt(leaf->GetSize() - 1), new_leaf->KeyAt(0));
+    } else {
+      auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+      auto *new_internal = reinterpret_cast<InternalPage *>(new_page->GetData());
+      new_internal->Init(new_page_id, INVALID_PAGE_ID, internal_max_size_, sizeof(Trailer));
+      internal->MoveHalfTo(new_internal, buffer_pool_manager_);
+      separator = new_internal->KeyAt(0);
+    }
+    Trailer *trailer = GetTrailer(page);
+    *GetTrailer(new_page) = *trailer;
+    trailer->high_key_ = separator;
+    trailer->has_high_key_ = true;
+    trailer->right_page_id_ = new_page_id;
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+
+    const int level = trailer->level_;
+    {
+      std::scoped_lock latch(root_latch_);
+      if (root_page_id_ == page->GetPageId()) {
+        page_id_t new_root_id;
+        Page *root_page = buffer_pool_manager_->NewPage(&new_root_id);
+        if (root_page == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new root page");
+        }
+        auto *new_root = reinterpret_cast<InternalPage *>(root_page->GetData());
+        new_root->Init(new_root_id, INVALID_PAGE_ID, internal_max_size_, sizeof(Trailer));
+        new_root->PopulateNewRoot(page->GetPageId(), separator, new_page_id);
+        *GetTrailer(root_page) = Trailer{KeyType(), INVALID_PAGE_ID, level + 1, false};
+        root_page_id_ = new_root_id;
+        UpdateRootPageId(0);
+        buffer_pool_manager_->UnpinPage(new_root_id, true);
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+        return;
+      }
+    }
+
+    Page *parent_page = FindParentPage(separator, level + 1, path);
+    page_id_t page_id = page->GetPageId();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+    BUSTUB_ASSERT(parent->ValueIndex(page_id) != -1, "the node covering the separator points to the split node");
+    parent->InsertNodeAfter(page_id, separator, new_page_id);
+    if (parent->GetSize() <= parent->GetMaxSize()) {
+      parent_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+      return;
+    }
+    page = parent_page;
+  }
+}
+
+/*
+ * Write latch the node at level that covers key, the parent of a node split at
+ * key. It is found from the path of the descent, moving right past the splits
+ * that happened since, or from the root when the tree has grown above the path.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BLINKTREE_TYPE::FindParentPage(const KeyType &key, int level, std::vector<page_id_t> *path) {
+  if (path->empty()) {
+    return FindNode(key, false, level, true, nullptr);
+  }
+  Page *page = buffer_pool_manager_->FetchPage(path->back());
+  path->pop_back();
+  page->WLatch();
+  return MoveRight(page, key, true);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Delete key & value pair associated with input key from the leaf that covers
+ * it. Leaves are not merged, so no other node is touched.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  Page *page = FindNode(key, false, 0, true, nullptr);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  int old_size = leaf_page->GetSize();
+  bool removed = leaf_page->RemoveAndDeleteRecord(key, comparator_) != old_size;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+}
+
+/*
+ * Delete every page of the tree, which is left empty. Each level is walked
+ * along the right links from its left most node, the first child of the left
+ * most node above. No other operation may run on the tree meanwhile.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::Clear() {
+  std::scoped_lock latch(root_latch_);
+  page_id_t left_most_id = root_page_id_;
+  while (left_most_id != INVALID_PAGE_ID) {
+    page_id_t page_id = left_most_id;
+    left_most_id = INVALID_PAGE_ID;
+    while (page_id != INVALID_PAGE_ID) {
+      Page *page = buffer_pool_manager_->FetchPage(page_id);
+      Trailer *trailer = GetTrailer(page);
+      if (left_most_id == INVALID_PAGE_ID && trailer->level_ > 0) {
+        left_most_id = reinterpret_cast<InternalPage *>(page->GetData())->ValueAt(0);
+      }
+      page_id_t right_page_id = trailer->right_page_id_;
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      page_id = right_page_id;
+    }
+  }
+  if (root_page_id_ != INVALID_PAGE_ID) {
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(0);
+  }
+}
+
+/*****************************************************************************
+ * INDEX ITERATOR
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BLINKTREE_TYPE::Begin() {
+  Page *page = FindNode(KeyType(), true, 0, false, nullptr);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BLINKTREE_TYPE::Begin(const KeyType &key) {
+  Page *page = FindNode(key, false, 0, false, nullptr);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, leaf_page->KeyIndex(key, comparator_));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BLINKTREE_TYPE::End() { return INDEXITERATOR_TYPE(); }
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+typename BLINKTREE_TYPE::Trailer *BLINKTREE_TYPE::GetTrailer(Page *page) const {
+  return reinterpret_cast<Trailer *>(page->GetData() + PAGE_SIZE - sizeof(Trailer));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BLINKTREE_TYPE::GetRootPageId() {
+  std::scoped_lock latch(root_latch_);
+  return root_page_id_;
+}
+
+/*
+ * Fetch a page and latch it, exclusively if it is at level and exclusive is
+ * set. A node never changes level, and a split in between the read and the
+ * write latch is caught by moving right afterwards.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BLINKTREE_TYPE::FetchAndLatch(page_id_t page_id, int level, bool exclusive) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  page->RLatch();
+  if (exclusive && GetTrailer(page)->level_ == level) {
+    page->RUnlatch();
+    page->WLatch();
+  }
+  return page;
+}
+
+/*
+ * Follow right links from the latched page until reaching the node that
+ * covers key, holding one latch at a time. Nodes are never deleted, so a right
+ * sibling stays valid after the latch on its left neighbor is dropped.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BLINKTREE_TYPE::MoveRight(Page *page, const KeyType &key, bool write_latched) {
+  Trailer *trailer = GetTrailer(page);
+  while (trailer->has_high_key_ && comparator_(key, trailer->high_key_) >= 0) {
+    page_id_t right_page_id = trailer->right_page_id_;
+    if (write_latched) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = buffer_pool_manager_->FetchPage(right_page_id);
+    if (write_latched) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    trailer = GetTrailer(page);
+  }
+  return page;
+}
+
+/*
+ * Descend to the node at level that covers key (the left most node of the
+ * level if left_most is set), holding a single read latch at a time. The node
+ * is returned write latched if exclusive is set and read latched otherwise.
+ * The internal pages passed on the way are appended to path, if given.
+ * Returns nullptr if the tree is empty.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BLINKTREE_TYPE::FindNode(const KeyType &key, bool left_most, int level, bool exclusive,
+                               std::vector<page_id_t> *path) {
+  page_id_t root_page_id = GetRootPageId();
+  if (root_page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = FetchAndLatch(root_page_id, level, exclusive);
+  while (true) {
+    bool at_level = GetTrailer(page)->level_ == level;
+    if (!left_most) {
+      page = MoveRight(page, key, at_level && exclusive);
+    }
+    if (at_level) {
+      return page;
+    }
+    auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+    page_id_t child_page_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+    if (path != nullptr) {
+      path->push_back(page->GetPageId());
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = FetchAndLatch(child_page_id, level, exclusive);
+  }
+}
+
+/*
+ * Update/Insert root page id in header page, see BPlusTree::UpdateRootPageId
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::UpdateRootPageId(int insert_record) {
+  auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  header_page->WLatch();
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
+    header_page->UpdateRecord(index_name_, root_page_id_);
+  }
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+template class BLinkTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class BLinkTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class BLinkTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class BLinkTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class BLinkTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -9,7 +9,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstdio>
+#include <functional>
 #include <string>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -27,30 +31,17 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manag
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size) {}
 
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() {
+  StopCompaction();
+  UnpinUpperLevels();
+}
+
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { 
-  //root_page_id是否有效/page是否能找到,否的话返回false
-  //找到root_page_id对应的页,判断其size是否大于1,非叶子节点的根节点其数量最小值为1,内部节点的
-  //根节点其大小为0
-  if(root_page_id_==INVALID_PAGE_ID){
-    return true;
-  }
-  Page*page=buffer_pool_manager_->FetchPage(this->root_page_id_,nullptr);
-  if(page==nullptr){
-    buffer_pool_manager_->UnpinPage(this->root_page_id_,false);
-    return true;
-  }
-  auto root_page=reinterpret_cast<InternalPage*>(page->GetData());
-  if((root_page->IsLeafPage()&&root_page->GetSize()==0)||(!root_page->IsLeafPage()&&root_page->GetSize()==1)){
-    buffer_pool_manager_->UnpinPage(this->root_page_id_,false);
-    return true;
-  }
-  buffer_pool_manager_->UnpinPage(this->root_page_id_,false);
-  return false;
- }
+bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -61,29 +52,53 @@ bool BPLUSTREE_TYPE::IsEmpty() const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  page_id_t page_id=root_page_id_;
-  Page*page=buffer_pool_manager_->FetchPage(page_id,nullptr);
-  auto root_page=reinterpret_cast<InternalPage*>(page->GetData());
-  while(!root_page->IsLeafPage()){
-    int index=root_page->Lookup(key,comparator_);   
-    //强制转为page_id
-    page_id=root_page->ValueAt(index);
-    buffer_pool_manager_->UnpinPage(page_id,false);
-    page=buffer_pool_manager_->FetchPage(page_id,nullptr);
-    root_page=reinterpret_cast<InternalPage*>(page->GetData());
-  }
-  //root_page为叶子节点,强转为叶子节点
-  auto leaf_page=reinterpret_cast<LeafPage*>(page->GetData());
-  int find_idx=leaf_page->KeyIndex(key,comparator_);
-  bool ans=false; 
-  if(comparator_(key,leaf_page->GetItem(find_idx).first)==0){
-    while(find_idx<leaf_page->GetSize()&&comparator_(key,leaf_page->GetItem(find_idx).first)==0){
-      result->emplace_back(leaf_page->GetItem(find_idx++).second);
-      ans=true;
-    }
-  }
-  buffer_pool_manager_->UnpinPage(page_id,false);
-  return ans;
+  Page *page = FindLeafPage(key, false, Operation::FIND, true, transaction);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  bool found = leaf_page->Lookup(key, &value, comparator_);
+  if (found) {
+    result->emplace_back(value);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+/*
+ * Look up every key of keys, which should be sorted, and store the values of
+ * keys[i] in (*results)[i]. The leaf of a key stays read latched and answers
+ * the following keys for as long as they fall into it, the tree is descended
+ * again for the first key that does not.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                               Transaction *transaction) {
+  results->assign(keys.size(), std::vector<ValueType>());
+  Page *page = nullptr;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (page != nullptr && !LeafCovers(reinterpret_cast<LeafPage *>(page->GetData()), keys[i])) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = nullptr;
+    }
+    if (page == nullptr) {
+      page = FindLeafPage(keys[i], false, Operation::FIND, true, transaction);
+      if (page == nullptr) {
+        return;
+      }
+    }
+    ValueType value;
+    if (reinterpret_cast<LeafPage *>(page->GetData())->Lookup(keys[i], &value, comparator_)) {
+      (*results)[i].emplace_back(value);
+    }
+  }
+  if (page != nullptr) {
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
 }
 
 /*****************************************************************************
@@ -91,21 +106,111 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  *****************************************************************************/
 /*
  * Insert constant key & value pair into b+ tree
- * if current tree is empty, start new tree, update root page id and insert
- * entry, otherwise insert into leaf page.
+ * The leaf is first reached optimistically, with read latches on the way down
+ * and a write latch on the leaf only. When the leaf would split, the descent
+ * is redone pessimistically, keeping write latches on the ancestors that the
+ * split can reach, and the tree is started or the entry inserted there.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) { 
-  if(IsEmpty()){
-    StartNewTree(key,value);
-    return true;
+bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  std::shared_lock<std::shared_mutex> snapshot_guard(snapshot_latch_);
+  Page *page = FindLeafPage(key, false, Operation::INSERT, true, transaction);
+  if (page != nullptr) {
+    auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    bool exists = leaf_page->Lookup(key, nullptr, comparator_);
+    bool safe = !exists && IsSafe(leaf_page, Operation::INSERT, key);
+    if (safe) {
+      PreserveForSnapshots(page);
+      leaf_page->Insert(key, value, comparator_);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), safe);
+    if (exists || safe) {
+      return !exists;
+    }
   }
-  if(InsertIntoLeaf(key,value,transaction)){
-    return true;
+
+  Transaction local_transaction(INVALID_TXN_ID);
+  if (transaction == nullptr) {
+    transaction = &local_transaction;
   }
-  return false; }
+  bool inserted = true;
+  while (true) {
+    Page *page = FindLeafPage(key, false, Operation::INSERT, false, transaction);
+    if (page == nullptr) {
+      StartNewTree(key, value);
+      break;
+    }
+    auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    if (leaf_page->Lookup(key, nullptr, comparator_) || leaf_page->GetSize() < leaf_page->MaxSizeFor(key)) {
+      inserted = InsertIntoLeaf(key, value, transaction);
+      break;
+    }
+    // the key is too long, or shares too few bytes with the keys of the leaf, to fit in, split it and try again
+    SplitLeaf(leaf_page, transaction);
+    ReleaseLatches(transaction, true);
+  }
+  ReleaseLatches(transaction, true);
+  return inserted;
+}
+/*
+ * Insert the key & value pairs of items, which should be sorted by key. The
+ * leaf reached by an optimistic descent stays write latched and takes the
+ * following pairs for as long as their keys fall into it and it has room for
+ * them without a split. A pair that would split the leaf, or start the tree,
+ * goes through Insert.
+ * @return: the number of pairs inserted, pairs with an existing key are skipped
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::InsertBatch(const std::vector<MappingType> &items, Transaction *transaction) {
+  int inserted = 0;
+  std::shared_lock<std::shared_mutex> snapshot_guard(snapshot_latch_);
+  Page *page = nullptr;
+  bool is_dirty = false;
+  auto release_leaf = [&]() {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+    page = nullptr;
+    is_dirty = false;
+  };
+  for (const auto &[key, value] : items) {
+    if (page != nullptr && !LeafCovers(reinterpret_cast<LeafPage *>(page->GetData()), key)) {
+      release_leaf();
+    }
+    if (page == nullptr) {
+      page = FindLeafPage(key, false, Operation::INSERT, true, transaction);
+    }
+    if (page != nullptr) {
+      auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+      if (leaf_page->Lookup(key, nullptr, comparator_)) {
+        continue;
+      }
+      if (IsSafe(leaf_page, Operation::INSERT, key)) {
+        if (!is_dirty) {
+          PreserveForSnapshots(page);
+        }
+        leaf_page->Insert(key, value, comparator_);
+        is_dirty = true;
+        inserted++;
+        continue;
+      }
+      release_leaf();
+    }
+    // Insert holds the snapshot latch itself
+    snapshot_guard.unlock();
+    if (Insert(key, value, transaction)) {
+      inserted++;
+    }
+    snapshot_guard.lock();
+  }
+  if (page != nullptr) {
+    release_leaf();
+  }
+  return inserted;
+}
+
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -115,49 +220,55 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   page_id_t page_id;
-  Page*page=buffer_pool_manager_->NewPage(&page_id,nullptr);
-  if(page==nullptr){
-    throw "out of memory";
-  }
-  LeafPage* leaf_page=reinterpret_cast<LeafPage*>(page->GetData());
-  leaf_page->Init(page_id, INVALID_PAGE_ID, this->leaf_max_size_);
-  leaf_page->Insert(key,value,comparator_);
-  this->root_page_id_=page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new root page");
+  }
+  MarkNewPage(page_id);
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf_page->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  leaf_page->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
   UpdateRootPageId(1);
-  buffer_pool_manager_->UnpinPage(page_id,true);
+  buffer_pool_manager_->UnpinPage(page_id, true);
 }
 
 /*
  * Insert constant key & value pair into leaf page
- * User needs to first find the right leaf page as insertion target, then look
- * through leaf page to see whether insert key exist or not. If exist, return
- * immdiately, otherwise insert entry. Remember to deal with split if necessary.
+ * The leaf is the last page of the transaction's page set, write latched
+ * together with every ancestor that a split would modify, and has room for
+ * the key. If the key exists, return immdiately, otherwise insert entry.
+ * Remember to deal with split if necessary. The latches are released by the
+ * caller.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  if(IsEmpty()){
-    StartNewTree(key,value);
-    return true;
-  }
-  Page*page=FindLeafPage(key,false);
-  LeafPage* leaf_page=reinterpret_cast<LeafPage*>(page->GetData());
-  if(leaf_page->Lookup(key,nullptr,comparator_)){
-    //已经存在
-    buffer_pool_manager_->UnpinPage(page->GetPageId(),true);
+  Page *page = transaction->GetPageSet()->back();
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  if (leaf_page->Lookup(key, nullptr, comparator_)) {
     return false;
   }
-  leaf_page->Insert(key,value,comparator_);
-  if(leaf_page->GetSize()==leaf_page->GetMaxSize()){
-    //fenlie
-    LeafPage*split_page=reinterpret_cast<LeafPage*>(Split(leaf_page));
-    this->InsertIntoParent(leaf_page,split_page->KeyAt(0),split_page,transaction);
+  leaf_page->Insert(key, value, comparator_);
+  if (leaf_page->GetSize() >= leaf_page->GetMaxSize()) {
+    SplitLeaf(leaf_page, transaction);
   }
-  buffer_pool_manager_->UnpinPage(page->GetPageId(),true);
   return true;
 }
 
+/*
+ * Split the leaf and insert the separator into its parent, both write latched.
+ * The separator is the shortest key between the two halves.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SplitLeaf(LeafPage *leaf_page, Transaction *transaction) {
+  LeafPage *split_page = Split(leaf_page);
+  KeyType separator = InternalPage::ShortestSeparator(leaf_page->KeyAt(leaf_page->GetSize() - 1), split_page->KeyAt(0));
+  InsertIntoParent(leaf_page, separator, split_page, transaction);
+  buffer_pool_manager_->UnpinPage(split_page->GetPageId(), true);
+}
+
 /*
  * Split input page and return newly created page.
  * Using template N to represent either internal page or leaf page.
@@ -168,30 +279,29 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
-  page_id_t page_id_new;
-  Page*page=buffer_pool_manager_->NewPage(&page_id_new,nullptr);
-  if(page==nullptr){
-    throw "out of memory";
-  }
-  N* split_node;
-  if(node->IsLeafPage()){
-   node=reinterpret_cast<LeafPage*>(node);
-   split_node=reinterpret_cast<LeafPage*>(page->GetData());
-   split_node->Init(page_id_new, node->GetParentPageId(), this->leaf_max_size_);
-   node->MoveHalfTo(split_node);
-   split_node->SetNextPageId(node->GetNextPageId());
-   node->SetNextPageId(split_node->GetPageId());
-   split_node=reinterpret_cast<N*>(split_node);
-  }else{
-    auto node_new=reinterpret_cast<InternalPage*>(node);
-    split_node=reinterpret_cast<InternalPage*>(page->GetData());
-    split_node->Init(page_id_new, node_new->GetParentPageId(), this->internal_max_size_);
-    node_new->MoveHalfTo(split_node,buffer_pool_manager_);
-    split_node=reinterpret_cast<N*>(split_node);
-  }
-  //buffer_pool_manager_->UnpinPage(page_id_new,true);
-  //需要返回,暂时不能unpin
-  return split_node;
+  page_id_t new_page_id;
+  Page *page = buffer_pool_manager_->NewPage(&new_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page for split");
+  }
+  MarkNewPage(new_page_id);
+  // the new page stays pinned, the caller unpins it once the parent has been updated. It needs no latch, other
+  // threads only reach it through the parent or the split leaf, which are both write latched
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  if (node->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<LeafPage *>(node);
+    auto *new_leaf = reinterpret_cast<LeafPage *>(new_node);
+    new_leaf->Init(new_page_id, leaf->GetParentPageId(), leaf_max_size_);
+    leaf->MoveHalfTo(new_leaf);
+    new_leaf->SetNextPageId(leaf->GetNextPageId());
+    leaf->SetNextPageId(new_page_id);
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    auto *new_internal = reinterpret_cast<InternalPage *>(new_node);
+    new_internal->Init(new_page_id, internal->GetParentPageId(), internal_max_size_);
+    internal->MoveHalfTo(new_internal, buffer_pool_manager_);
+  }
+  return new_node;
 }
 
 /*
@@ -201,106 +311,569 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  * @param   new_node      returned page from split() method
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
- * recursively if necessary.
+ * recursively if necessary. The parent is already write latched by this
+ * thread, and so is the root latch when the root splits.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-  Transaction *transaction) {
-  if(old_node->IsRootPage()){
-    Page*new_root_page=buffer_pool_manager_->NewPage(&root_page_id_);
-    auto new_root=reinterpret_cast<InternalPage*>(new_root_page->GetData());
-    new_root->Init(root_page_id_,INVALID_PAGE_ID,this->internal_max_size_);
+                                      Transaction *transaction) {
+  if (old_node->IsRootPage()) {
+    page_id_t new_root_id;
+    Page *page = buffer_pool_manager_->NewPage(&new_root_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new root page");
+    }
+    MarkNewPage(new_root_id);
+    auto *new_root = reinterpret_cast<InternalPage *>(page->GetData());
+    new_root->Init(new_root_id, INVALID_PAGE_ID, internal_max_size_);
+    new_root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(new_root_id);
+    new_node->SetParentPageId(new_root_id);
+    root_page_id_ = new_root_id;
     UpdateRootPageId(0);
-    new_root->PopulateNewRoot(old_node->GetPageId(),key,new_node->GetPageId());
-    old_node->SetParentPageId(root_page_id_);
-    new_node->SetParentPageId(root_page_id_);
-    buffer_pool_manager_->UnpinPage(root_page_id_,true);
-    return ;  
+    MarkUpperLevelsChanged();
+    buffer_pool_manager_->UnpinPage(new_root_id, true);
+    return;
   }
-  page_id_t parent_page_id=old_node->GetParentPageId();
-  InternalPage *parent_page=reinterpret_cast<InternalPage*>(buffer_pool_manager_->FetchPage(parent_page_id,nullptr)->GetData());
-  parent_page->InsertNodeAfter(old_node->GetPageId(),key,new_node->GetPageId());
-  if(parent_page->GetSize()==parent_page->GetMaxSize()){
-    auto split_page=Split(parent_page);
-    InsertIntoParent(parent_page,split_page->KeyAt(0),split_page);//之所以是keyat(0)是因为需要提取一个中间的key放到parent上
-    buffer_pool_manager_->UnpinPage(split_page->GetPageId(),true);
+  page_id_t parent_page_id = old_node->GetParentPageId();
+  auto *parent_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+  parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  new_node->SetParentPageId(parent_page_id);
+  if (parent_page->GetSize() > parent_page->GetMaxSize()) {
+    SplitInternal(parent_page, transaction);
   }
-  buffer_pool_manager_->UnpinPage(parent_page_id,true);
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+}
+
+/*
+ * Split an internal page that exceeds its max size and insert the separator
+ * into its parent, both write latched, splitting further up if need be
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SplitInternal(InternalPage *internal_page, Transaction *transaction) {
+  InternalPage *split_page = Split(internal_page);
+  MarkUpperLevelsChanged();
+  // KeyAt(0) of the new page is the separator pushed up into the grandparent
+  InsertIntoParent(internal_page, split_page->KeyAt(0), split_page, transaction);
+  buffer_pool_manager_->UnpinPage(split_page->GetPageId(), true);
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+namespace {
+/* Number of entries a bulk loaded node is filled with */
+inline size_t FillOf(size_t capacity, size_t min_size, double fill_factor) {
+  auto fill = static_cast<size_t>(static_cast<double>(capacity) * fill_factor + 0.5);
+  return std::clamp<size_t>(fill, std::max<size_t>(min_size, 1), capacity);
+}
+}  // namespace
+
+/*
+ * Sort a run of a bulk load by key, keeping pairs with equal keys in input order
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SortRun(std::vector<MappingType> *run) {
+  std::stable_sort(run->begin(), run->end(),
+                   [&](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; });
+}
+
+/*
+ * Sort a run and write it to a temporary file, which goes away once closed
+ * @return : the file, positioned at its first entry
+ */
+INDEX_TEMPLATE_ARGUMENTS
+typename BPLUSTREE_TYPE::RunFile BPLUSTREE_TYPE::SpillRun(std::vector<MappingType> *run) {
+  SortRun(run);
+  RunFile file(std::tmpfile(), &std::fclose);
+  if (file == nullptr || std::fwrite(run->data(), sizeof(MappingType), run->size(), file.get()) != run->size()) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot spill a bulk load run");
+  }
+  std::rewind(file.get());
+  run->clear();
+  return file;
+}
+
+/*
+ * Build the tree bottom-up from the pairs of a bulk load: the last run, still
+ * in memory, and the runs spilled before it. A single run is sorted in place,
+ * several are merged through a heap. Either way the entries reach the leaves
+ * in key order, and every internal level is then built from the separators and
+ * page ids of the level below, so no entry goes through a root-to-leaf descent.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadRuns(std::vector<MappingType> *run, std::vector<RunFile> *spilled_runs,
+                                  double fill_factor, Transaction *transaction) {
+  BUSTUB_ASSERT(IsEmpty(), "a bulk load needs an empty tree");
+  std::function<bool(MappingType *)> next_sorted;
+  size_t next = 0;
+  // the heap orders the heads of the runs by key, then by run so that the first pair of a key wins
+  auto greater = [&](const std::pair<MappingType, size_t> &a, const std::pair<MappingType, size_t> &b) {
+    int cmp = comparator_(a.first.first, b.first.first);
+    return cmp > 0 || (cmp == 0 && a.second > b.second);
+  };
+  std::priority_queue<std::pair<MappingType, size_t>, std::vector<std::pair<MappingType, size_t>>, decltype(greater)>
+      heads(greater);
+  if (spilled_runs->empty()) {
+    SortRun(run);
+    next_sorted = [&](MappingType *entry) {
+      if (next == run->size()) {
+        return false;
+      }
+      *entry = (*run)[next++];
+      return true;
+    };
+  } else {
+    if (!run->empty()) {
+      spilled_runs->emplace_back(SpillRun(run));
+    }
+    MappingType head;
+    for (size_t i = 0; i < spilled_runs->size(); i++) {
+      if (std::fread(&head, sizeof(MappingType), 1, (*spilled_runs)[i].get()) == 1) {
+        heads.emplace(head, i);
+      }
+    }
+    next_sorted = [&](MappingType *entry) {
+      if (heads.empty()) {
+        return false;
+      }
+      auto [top, i] = heads.top();
+      heads.pop();
+      *entry = top;
+      if (std::fread(&top, sizeof(MappingType), 1, (*spilled_runs)[i].get()) == 1) {
+        heads.emplace(top, i);
+      }
+      return true;
+    };
   }
 
+  bool has_last = false;
+  KeyType last_key;
+  auto next_entry = [&](MappingType *entry) {
+    while (next_sorted(entry)) {
+      if (!has_last || comparator_(entry->first, last_key) != 0) {
+        has_last = true;
+        last_key = entry->first;
+        return true;
+      }
+    }
+    return false;
+  };
+  std::vector<std::pair<KeyType, page_id_t>> level = BuildLeafLevel(next_entry, fill_factor);
+  if (level.empty()) {
+    return;
+  }
+  while (level.size() > 1) {
+    level = BuildInternalLevel(level, fill_factor);
+  }
+  root_latch_.WLock();
+  root_page_id_ = level[0].second;
+  UpdateRootPageId(1);
+  MarkUpperLevelsChanged();
+  root_latch_.WUnlock();
+}
+
+/*
+ * Write the entries returned by next_entry, in key order, into new chained
+ * leaves. A leaf takes entries up to the fill factor of the max size they leave
+ * it, then the last leaf takes entries from its neighbor to reach min size.
+ * @return : the separator and page id of every leaf, in key order
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<std::pair<KeyType, page_id_t>> BPLUSTREE_TYPE::BuildLeafLevel(
+    const std::function<bool(MappingType *)> &next_entry, double fill_factor) {
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  LeafPage *prev_leaf = nullptr;
+  LeafPage *leaf = nullptr;
+  MappingType entry;
+  while (next_entry(&entry)) {
+    if (leaf != nullptr) {
+      // a leaf splits as soon as it reaches max size
+      int max_size = leaf->MaxSizeFor(entry.first);
+      if (leaf->GetSize() < static_cast<int>(FillOf(max_size - 1, max_size / 2, fill_factor))) {
+        leaf->CopyNFrom(&entry, 1);
+        continue;
+      }
+    }
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a leaf page for bulk load");
+    }
+    if (prev_leaf != nullptr) {
+      buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+    }
+    if (leaf != nullptr) {
+      leaf->SetNextPageId(page_id);
+    }
+    // the separator of a leaf is the shortest key between it and the previous one
+    level.emplace_back(leaf == nullptr ? entry.first
+                                       : InternalPage::ShortestSeparator(leaf->KeyAt(leaf->GetSize() - 1), entry.first),
+                       page_id);
+    prev_leaf = leaf;
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+    leaf->CopyNFrom(&entry, 1);
+  }
+  if (prev_leaf != nullptr) {
+    while (leaf->GetSize() < leaf->GetMinSize() && prev_leaf->GetSize() > prev_leaf->GetMinSize()) {
+      prev_leaf->MoveLastToFrontOf(leaf);
+    }
+    level.back().first = InternalPage::ShortestSeparator(prev_leaf->KeyAt(prev_leaf->GetSize() - 1), leaf->KeyAt(0));
+    buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+  }
+  if (leaf != nullptr) {
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+  }
+  return level;
+}
+
+/*
+ * Build the internal pages above children. A page takes children up to the
+ * fill factor of the max size they leave it, then the last page takes children
+ * from its neighbor to reach min size.
+ * @return : the separator and page id of every new internal page, in key order
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<std::pair<KeyType, page_id_t>> BPLUSTREE_TYPE::BuildInternalLevel(
+    const std::vector<std::pair<KeyType, page_id_t>> &children, double fill_factor) {
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  InternalPage *prev_internal = nullptr;
+  InternalPage *internal = nullptr;
+  // the first key of each child is its separator, the one of the first child of a page moves up a level
+  for (const auto &child : children) {
+    if (internal != nullptr) {
+      int max_size = internal->MaxSizeFor(child.first);
+      if (internal->GetSize() < static_cast<int>(FillOf(max_size, (max_size + 1) / 2, fill_factor))) {
+        internal->CopyNFrom(&child, 1, buffer_pool_manager_);
+        continue;
+      }
+    }
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate an internal page for bulk load");
+    }
+    if (prev_internal != nullptr) {
+      buffer_pool_manager_->UnpinPage(prev_internal->GetPageId(), true);
+    }
+    prev_internal = internal;
+    internal = reinterpret_cast<InternalPage *>(page->GetData());
+    internal->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+    internal->CopyNFrom(&child, 1, buffer_pool_manager_);
+    level.emplace_back(child.first, page_id);
+  }
+  if (prev_internal != nullptr) {
+    while (internal->GetSize() < internal->GetMinSize() && prev_internal->GetSize() > prev_internal->GetMinSize()) {
+      prev_internal->MoveLastToFrontOf(internal, level.back().first, buffer_pool_manager_);
+      level.back().first = internal->KeyAt(0);
+    }
+    buffer_pool_manager_->UnpinPage(prev_internal->GetPageId(), true);
+  }
+  if (internal != nullptr) {
+    buffer_pool_manager_->UnpinPage(internal->GetPageId(), true);
+  }
+  return level;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
 /*
  * Delete key & value pair associated with input key
  * If current tree is empty, return immdiately.
- * If not, User needs to first find the right leaf page as deletion target, then
- * delete entry from leaf page. Remember to deal with redistribute or merge if
- * necessary.
+ * If not, the leaf is first reached optimistically as for Insert. When the
+ * leaf would underflow, the descent is redone pessimistically and the entry
+ * deleted there, followed by redistribute or merge if necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
-  if(this->IsEmpty()){
-    return ;
+  std::shared_lock<std::shared_mutex> snapshot_guard(snapshot_latch_);
+  Page *page = FindLeafPage(key, false, Operation::DELETE, true, transaction);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  bool exists = leaf_page->Lookup(key, nullptr, comparator_);
+  bool safe = exists && IsSafe(leaf_page, Operation::DELETE, key);
+  if (safe) {
+    PreserveForSnapshots(page);
+    leaf_page->RemoveAndDeleteRecord(key, comparator_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), safe);
+  if (!exists || safe) {
+    return;
+  }
+
+  Transaction local_transaction(INVALID_TXN_ID);
+  if (transaction == nullptr) {
+    transaction = &local_transaction;
+  }
+  page = FindLeafPage(key, false, Operation::DELETE, false, transaction);
+  if (page != nullptr) {
+    leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    int old_size = leaf_page->GetSize();
+    if (leaf_page->RemoveAndDeleteRecord(key, comparator_) != old_size &&
+        CoalesceOrRedistribute(leaf_page, transaction)) {
+      transaction->AddIntoDeletedPageSet(page->GetPageId());
+    }
+  }
+  ReleaseLatches(transaction, true);
+}
+
+/*
+ * Remove the keys from lower, included, to upper, excluded, holding the root
+ * latch throughout. The paths to the two bounds are write latched from the top
+ * down, the subtrees between them are dropped whole and the leaf at the lower
+ * bound is linked to the one at the upper bound. The pages on the paths are
+ * then brought back to their min size from the bottom up. A page that was left
+ * as the only child of its parent gets its siblings when the parent merges,
+ * and is taken care of in the next round.
+ * @return : the number of keys removed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::RemoveRange(const KeyType &lower, const KeyType &upper, Transaction *transaction) {
+  if (comparator_(lower, upper) >= 0) {
+    return 0;
+  }
+  Transaction local_transaction(INVALID_TXN_ID);
+  if (transaction == nullptr) {
+    transaction = &local_transaction;
+  }
+  std::shared_lock<std::shared_mutex> snapshot_guard(snapshot_latch_);
+  root_latch_.WLock();
+  if (upper_levels_changed_) {
+    RepinUpperLevels();
+  }
+  transaction->AddIntoPageSet(nullptr);
+  if (IsEmpty()) {
+    ReleaseLatches(transaction, false);
+    return 0;
+  }
+  Page *root_page = buffer_pool_manager_->FetchPage(root_page_id_);
+  root_page->WLatch();
+  PreserveForSnapshots(root_page);
+  transaction->AddIntoPageSet(root_page);
+  std::vector<Page *> lower_path;
+  std::vector<Page *> upper_path;
+  int removed = RemoveRangeBelow(root_page, &lower, &upper, &lower_path, &upper_path, transaction);
+  if (lower_path.back() != upper_path.back()) {
+    reinterpret_cast<LeafPage *>(lower_path.back()->GetData())->SetNextPageId(upper_path.back()->GetPageId());
+  }
+
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t level = lower_path.size(); level-- > 0;) {
+      for (Page *page : {lower_path[level], upper_path[level]}) {
+        auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+        if (deleted_page_set->count(page->GetPageId()) != 0 || node->IsRootPage() ||
+            node->GetSize() >= node->GetMinSize()) {
+          continue;
+        }
+        // a page that moved under a page off the paths, as its parent merged, has that one latched now
+        Page *parent_page = LatchOnce(node->GetParentPageId(), transaction);
+        if (reinterpret_cast<InternalPage *>(parent_page->GetData())->GetSize() == 1) {
+          continue;
+        }
+        bool should_delete = node->IsLeafPage()
+                                 ? CoalesceOrRedistribute(reinterpret_cast<LeafPage *>(node), transaction)
+                                 : CoalesceOrRedistribute(reinterpret_cast<InternalPage *>(node), transaction);
+        if (should_delete) {
+          transaction->AddIntoDeletedPageSet(page->GetPageId());
+        }
+        changed = true;
+      }
+    }
   }
-  Page*page=this->FindLeafPage(key,false);
-  if(page==nullptr){
-    buffer_pool_manager_->UnpinPage(page->GetPageId(),false);
-    return ;
+  // the root goes away when a single child is left to it, or no key to a root leaf
+  while (!IsEmpty()) {
+    root_page = LatchOnce(root_page_id_, transaction);
+    if (!AdjustRoot(reinterpret_cast<BPlusTreePage *>(root_page->GetData()))) {
+      break;
+    }
+    transaction->AddIntoDeletedPageSet(root_page->GetPageId());
   }
-  LeafPage* leaf_page=reinterpret_cast<LeafPage*>(page->GetData());
-  leaf_page->RemoveAndDeleteRecord(key,comparator_);
-  if(leaf_page->GetSize()>=leaf_page->GetMinSize()){
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(),true);
-    return ;
+  ReleaseLatches(transaction, true);
+  return removed;
+}
+
+/*
+ * Delete every page of the tree, which is left empty. The pages are dropped
+ * as the subtrees of a range removal are.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Clear(Transaction *transaction) {
+  Transaction local_transaction(INVALID_TXN_ID);
+  if (transaction == nullptr) {
+    transaction = &local_transaction;
+  }
+  std::shared_lock<std::shared_mutex> snapshot_guard(snapshot_latch_);
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);
+  // the pinned pages go away with the others, they are pinned again as the tree grows
+  UnpinUpperLevels();
+  if (!IsEmpty()) {
+    DropSubtree(root_page_id_, transaction);
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(0);
+    MarkUpperLevelsChanged();
   }
-  bool flag=CoalesceOrRedistribute(leaf_page,transaction);
-  if(flag){
-    buffer_pool_manager_->UnpinPage(page->GetPageId(),true);
-    buffer_pool_manager_->DeletePage(page->GetPageId());
-  }else{
-    buffer_pool_manager_->UnpinPage(page->GetPageId(),true);
+  ReleaseLatches(transaction, true);
+}
+
+/*
+ * Remove the keys from lower to upper, either null when it is unbounded in the
+ * subtree, below the write latched page. The children between the bounds are
+ * dropped, the ones at a bound are write latched and searched in turn. The
+ * pages met on the way to each bound are appended to its path.
+ * @return : the number of keys removed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::RemoveRangeBelow(Page *page, const KeyType *lower, const KeyType *upper,
+                                     std::vector<Page *> *lower_path, std::vector<Page *> *upper_path,
+                                     Transaction *transaction) {
+  if (lower != nullptr) {
+    lower_path->push_back(page);
+  }
+  if (upper != nullptr) {
+    upper_path->push_back(page);
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (node->IsLeafPage()) {
+    return reinterpret_cast<LeafPage *>(node)->RemoveRange(lower, upper, comparator_);
+  }
+  auto *internal = reinterpret_cast<InternalPage *>(node);
+  int first = lower == nullptr ? 0 : internal->LookupIndex(*lower, comparator_);
+  int last = upper == nullptr ? internal->GetSize() - 1 : internal->LookupIndexBefore(*upper, comparator_);
+  auto search_child = [&](int index, const KeyType *child_lower, const KeyType *child_upper) {
+    Page *child = buffer_pool_manager_->FetchPage(internal->ValueAt(index));
+    child->WLatch();
+    PreserveForSnapshots(child);
+    transaction->AddIntoPageSet(child);
+    return RemoveRangeBelow(child, child_lower, child_upper, lower_path, upper_path, transaction);
+  };
+
+  int removed = 0;
+  if (lower != nullptr) {
+    removed += search_child(first, lower, first == last ? upper : nullptr);
+  }
+  int begin = lower == nullptr ? first : first + 1;
+  int end = upper == nullptr ? last + 1 : last;
+  for (int i = begin; i < end; i++) {
+    removed += DropSubtree(internal->ValueAt(i), transaction);
+  }
+  if (upper != nullptr && (lower == nullptr || first != last)) {
+    removed += search_child(last, nullptr, upper);
+  }
+  if (begin < end) {
+    internal->Remove(begin, end - begin);
+  }
+  return removed;
+}
+
+/*
+ * Drop the subtree of a page whose keys all fall in a removed range. Its pages
+ * are write latched on the way down, so that the descents in them are done,
+ * and deleted once the removal releases its latches. The leaves are emptied
+ * for the scans that wait for them.
+ * @return : the number of keys dropped
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::DropSubtree(page_id_t page_id, Transaction *transaction) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  page->WLatch();
+  PreserveForSnapshots(page);
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  int removed = 0;
+  if (node->IsLeafPage()) {
+    removed = node->GetSize();
+    node->SetSize(0);
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    for (int i = 0; i < internal->GetSize(); i++) {
+      removed += DropSubtree(internal->ValueAt(i), transaction);
+    }
   }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  transaction->AddIntoDeletedPageSet(page_id);
+  return removed;
 }
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
+ * The parent is already write latched by this thread, the sibling is latched
+ * here unless this thread holds it already. Pages that go away are added to
+ * the transaction's deleted page set.
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
-  if(node->IsRootPage()){
+  if (node->IsRootPage()) {
     return AdjustRoot(node);
   }
-  page_id_t page_id=node->GetParentPageId();
-  page_id_t node_page_id=node->GetPageId();
-  Page*page=buffer_pool_manager_->FetchPage(page_id,nullptr);
-  InternalPage*parent_page=reinterpret_cast<InternalPage*>(page->GetData());
-  int index=parent_page->ValueIndex(node_page_id);
-  page_id_t sli_page_id=static_cast<page_id_t>(parent_page->ValueAt(index==0?1:index-1));
-  Page*sli_page=buffer_pool_manager_->FetchPage(sli_page_id,nullptr);
-  N *sli_plus_page=reinterpret_cast<N*>(sli_page->GetData());
-  if(sli_plus_page->GetSize()+node->GetSize()<=node->GetMaxSize()){
-    bool res=Coalesce(&sli_plus_page,&node,&parent_page,index,transaction);
-    buffer_pool_manager_->UnpinPage(page_id,true);
-    buffer_pool_manager_->UnpinPage(sli_page_id,true);
-    if(res){
-      buffer_pool_manager_->DeletePage(page_id);
-    }
-    if(index==0){
-      buffer_pool_manager_->DeletePage(sli_page_id);
-    }
-    return index>0;
-  }else{
-    Redistribute(sli_plus_page,node,index);
-    buffer_pool_manager_->UnpinPage(page_id,true);
-    buffer_pool_manager_->UnpinPage(sli_page_id,true);
+  if (node->GetSize() >= node->GetMinSize()) {
+    return false;
+  }
+  page_id_t parent_page_id = node->GetParentPageId();
+  auto *parent_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+  if (parent_page->GetSize() == 1) {
+    // a range removal may leave node as the only child, it gets siblings once its parent merged
+    buffer_pool_manager_->UnpinPage(parent_page_id, false);
+    return false;
+  }
+  int index = parent_page->ValueIndex(node->GetPageId());
+  page_id_t sibling_page_id = parent_page->ValueAt(index == 0 ? 1 : index - 1);
+  Page *sibling_page = buffer_pool_manager_->FetchPage(sibling_page_id);
+  bool held = HoldsLatch(sibling_page_id, transaction);
+  if (!held) {
+    sibling_page->WLatch();
+    PreserveForSnapshots(sibling_page);
   }
-  return false;
+  auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+
+  // leaves split as soon as they are full, so a merged leaf must stay below the max size it would have, a merged
+  // internal page takes the separator of the right page as the key of its first entry
+  int capacity;
+  if (node->IsLeafPage()) {
+    capacity = reinterpret_cast<LeafPage *>(node)->MaxSizeWith(*reinterpret_cast<LeafPage *>(sibling)) - 1;
+  } else {
+    auto *left = reinterpret_cast<InternalPage *>(index == 0 ? node : sibling);
+    auto *right = reinterpret_cast<InternalPage *>(index == 0 ? sibling : node);
+    capacity = left->MaxSizeWith(*right, parent_page->KeyAt(index == 0 ? 1 : index));
+  }
+  if (sibling->GetSize() + node->GetSize() > capacity) {
+    Redistribute(sibling, node, index, transaction);
+    if (!held) {
+      sibling_page->WUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(sibling_page_id, true);
+    buffer_pool_manager_->UnpinPage(parent_page_id, true);
+    return false;
+  }
+
+  bool parent_should_delete = Coalesce(&sibling, &node, &parent_page, index, transaction);
+  if (!held) {
+    sibling_page->WUnlatch();
+  }
+  buffer_pool_manager_->UnpinPage(sibling_page_id, true);
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+  if (parent_should_delete) {
+    transaction->AddIntoDeletedPageSet(parent_page_id);
+  }
+  if (index == 0) {
+    // the right sibling was merged into node, so the sibling is the page that goes away
+    transaction->AddIntoDeletedPageSet(sibling_page_id);
+    return false;
+  }
+  return true;
 }
 
 /*
@@ -315,80 +888,82 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
  * @return  true means parent node should be deleted, false means no deletion
  * happend
  */
-//merge操作
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
-  BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
-  Transaction *transaction) {
-    if(index==0){
-      std::swap(neighbor_node,node);
-      index=1;
-    }
-    if((*node)->IsLeafPage()){
-      LeafPage* node_new=reinterpret_cast<LeafPage*>(*node);
-      LeafPage* neighbor_node_new=reinterpret_cast<LeafPage*>(*neighbor_node);
-      node_new->MoveAllTo(neighbor_node);
-      neighbor_node->SetNextPageId(node_new->GetNextPageId());
-    }else{
-      InternalPage*node_new=reinterpret_cast<InternalPage*>(*node);
-      InternalPage*neighbor_node_new=reinterpret_cast<InternalPage*>(*neighbor_node);
-      auto mid_key=(*parent)->KeyAt(index);
-      node_new->MoveAllTo(neighbor_node_new,mid_key,buffer_pool_manager_);
-    }
-    (*parent)->Remove(index);
-    //buffer_pool_manager_->UnpinPage();
-  return CoalesceOrRedistribute(*parent,transaction);
-}
-
-/*
- * Redistribute key & value pairs from one page to its sibling page. If index ==
- * 0, move sibling page's first key & value pair into end of input "node",
- * otherwise move sibling page's last key & value pair into head of input
- * "node".
+                              BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
+                              Transaction *transaction) {
+  // always merge the right page into the left one
+  N *left = *neighbor_node;
+  N *right = *node;
+  int right_index = index;
+  if (index == 0) {
+    std::swap(left, right);
+    right_index = 1;
+  }
+  if (right->IsLeafPage()) {
+    reinterpret_cast<LeafPage *>(right)->MoveAllTo(reinterpret_cast<LeafPage *>(left));
+  } else {
+    reinterpret_cast<InternalPage *>(right)->MoveAllTo(reinterpret_cast<InternalPage *>(left),
+                                                       (*parent)->KeyAt(right_index), buffer_pool_manager_);
+  }
+  (*parent)->Remove(right_index);
+  return CoalesceOrRedistribute(*parent, transaction);
+}
+
+/*
+ * Redistribute key & value pairs from one page to its sibling page until the
+ * sibling reaches its min size. If index == 0, move sibling page's first key &
+ * value pairs into end of input "node", otherwise move sibling page's last key
+ * & value pairs into head of input "node".
  * Using template N to represent either internal page or leaf page.
+ * The separator of two leaves becomes the shortest key between them. A longer
+ * separator may take the room the parent keeps for one more entry, the parent
+ * then splits as on an insert. It is write latched together with its own
+ * parent in that case, as a full internal page is not safe for a delete.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  */
-//借位操作
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
-  page_id_t page_id=node->GetParentPageId();
-  Page*page=buffer_pool_manager_->FetchPage(page_id,nullptr);
-  auto parent_page=reinterpret_cast<InternalPage*>(page->GetData());
-  if(index==0){
-    if(node->IsLeafPage()){
-      node=reinterpret_cast<LeafPage*>(node);
-      neighbor_node=reinterpret_cast<LeafPage*>(neighbor_node);
-      neighbor_node->MoveFirstToEndOf(node);
-      parent_page->SetKeyAt(1,neighbor_node->KeyAt(0));
-      //
-    }else{
-      node=reinterpret_cast<InternalPage*>(node);
-      neighbor_node=reinterpret_cast<InternalPage*>(neighbor_node);
-      int idx=parent_page->ValueIndex(neighbor_node->GetPageId());
-      auto key=parent_page->KeyAt(idx+1);
-      neighbor_node->MoveFirstToEndOf(node,key,buffer_pool_manager_);
-      parent_page->SetKeyAt(1,neighbor_node->KeyAt(0));
-    }
-  }else{
-    //有左节点
-    if(node->IsLeafPage()){
-      node=reinterpret_cast<LeafPage*>(node);
-      neighbor_node=reinterpret_cast<LeafPage*>(neighbor_node);
-      node->MoveFirstToEndOf(neighbor_node);
-      parent_page->SetKeyAt(index,node->KeyAt(0));
-    }else{
-      node=reinterpret_cast<InternalPage*>(node);
-      neighbor_node=reinterpret_cast<InternalPage*>(neighbor_node);
-      int idx=parent_page->ValueIndex(node->GetPageId());
-      auto key=parent_page->KeyAt(idx);
-      node->MoveFirstToEndOf(neighbor_node,key,buffer_pool_manager_);
-      parent_page->SetKeyAt(index,node->KeyAt(0));
-    }
-  }
-  buffer_pool_manager_->UnpinPage(page_id,true); 
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index, Transaction *transaction) {
+  page_id_t parent_page_id = node->GetParentPageId();
+  auto *parent_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+  const int key_index = index == 0 ? 1 : index;
+  KeyType separator = parent_page->KeyAt(key_index);
+  // a single removal takes one entry, a range removal may take more
+  while (node->GetSize() < node->GetMinSize() && neighbor_node->GetSize() > 1) {
+    if (node->IsLeafPage()) {
+      auto *leaf = reinterpret_cast<LeafPage *>(node);
+      auto *neighbor_leaf = reinterpret_cast<LeafPage *>(neighbor_node);
+      if (index == 0) {
+        neighbor_leaf->MoveFirstToEndOf(leaf);
+      } else {
+        neighbor_leaf->MoveLastToFrontOf(leaf);
+      }
+      continue;
+    }
+    // the key of the entry next to the moved one is the new separator of two internal pages
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    auto *neighbor_internal = reinterpret_cast<InternalPage *>(neighbor_node);
+    KeyType next_separator = neighbor_internal->KeyAt(index == 0 ? 1 : neighbor_internal->GetSize() - 1);
+    if (index == 0) {
+      neighbor_internal->MoveFirstToEndOf(internal, separator, buffer_pool_manager_);
+    } else {
+      neighbor_internal->MoveLastToFrontOf(internal, separator, buffer_pool_manager_);
+    }
+    separator = next_separator;
+  }
+  if (node->IsLeafPage()) {
+    auto *left = reinterpret_cast<LeafPage *>(index == 0 ? node : neighbor_node);
+    auto *right = reinterpret_cast<LeafPage *>(index == 0 ? neighbor_node : node);
+    separator = InternalPage::ShortestSeparator(left->KeyAt(left->GetSize() - 1), right->KeyAt(0));
+  }
+  parent_page->SetKeyAt(key_index, separator);
+  if (parent_page->GetSize() > parent_page->GetMaxSize()) {
+    SplitInternal(parent_page, transaction);
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
 }
 /*
  * Update root page if necessary
@@ -401,26 +976,364 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { 
-  //根节点只有一个左儿子时应该删除
-  if(old_root_node->GetSize()==1&&old_root_node->IsRootPage()){
-    auto old_root_node_new=reinterpret_cast<InternalPage*>(old_root_node);
-    auto page_id=old_root_node_new->RemoveAndReturnOnlyChild();
-    root_page_id_=static_cast<page_id_t>(page_id);
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+  if (!old_root_node->IsLeafPage() && old_root_node->GetSize() == 1) {
+    auto *old_root = reinterpret_cast<InternalPage *>(old_root_node);
+    root_page_id_ = old_root->RemoveAndReturnOnlyChild();
     UpdateRootPageId(0);
-    Page*page=buffer_pool_manager_->FetchPage(page_id,nullptr);
-    InternalPage*page_new=reinterpret_cast<InternalPage*>(page->GetData());
-    page_new->SetParentPageId(INVALID_PAGE_ID);
-    buffer_pool_manager_->UnpinPage(page_id,true);
+    MarkUpperLevelsChanged();
+    Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+    auto *new_root = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    new_root->SetParentPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(root_page_id_, true);
     return true;
   }
-  //所有节点都被删除
-  if(old_root_node->IsRootPage()&&old_root_node->GetSize()==0){
-    root_page_id_=INVALID_PAGE_ID;
+  if (old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {
+    root_page_id_ = INVALID_PAGE_ID;
     UpdateRootPageId(0);
+    MarkUpperLevelsChanged();
     return true;
   }
-  return false; }
+  return false;
+}
+
+/*****************************************************************************
+ * COMPACTION
+ *****************************************************************************/
+/*
+ * Compact the tree from left to right, one leaf at a time. The pages on the
+ * path to a leaf that starts them take in their right siblings for as long as
+ * they fit and fill up from the next one, from the top down, the parents
+ * merging and the root going away as they underflow. The leaf then moves to a
+ * new page right after the one of the previous leaf unless it is in order
+ * already. A step latches the pages on the path to its leaf that it may
+ * change, the ones a delete would keep and the lowest ancestor with a leaf to
+ * the left, and releases them before the next one, so readers and writers go
+ * on in between and in the rest of the tree.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Compact(Transaction *transaction) {
+  Transaction local_transaction(INVALID_TXN_ID);
+  if (transaction == nullptr) {
+    transaction = &local_transaction;
+  }
+  KeyType key;
+  bool left_most = true;
+  page_id_t last_page_id = INVALID_PAGE_ID;
+  while (CompactStep(&key, &left_most, &last_page_id, transaction)) {
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StartCompaction(std::chrono::milliseconds interval) {
+  std::scoped_lock lock(compaction_latch_);
+  if (compaction_thread_.joinable()) {
+    return;
+  }
+  stop_compaction_ = false;
+  compaction_thread_ = std::thread([this, interval] {
+    Transaction transaction(INVALID_TXN_ID);
+    KeyType key;
+    bool left_most = true;
+    page_id_t last_page_id = INVALID_PAGE_ID;
+    std::unique_lock<std::mutex> lock(compaction_latch_);
+    while (!compaction_cv_.wait_for(lock, interval, [this] { return stop_compaction_; })) {
+      lock.unlock();
+      if (!CompactStep(&key, &left_most, &last_page_id, &transaction)) {
+        left_most = true;
+        last_page_id = INVALID_PAGE_ID;
+      }
+      lock.lock();
+    }
+  });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StopCompaction() {
+  {
+    std::scoped_lock lock(compaction_latch_);
+    if (!compaction_thread_.joinable()) {
+      return;
+    }
+    stop_compaction_ = true;
+  }
+  compaction_cv_.notify_all();
+  compaction_thread_.join();
+}
+
+/*
+ * Compact the leaf of key, or the left most leaf, with the pages above it and
+ * set key to the leaf to go on with
+ * @return : false when the leaf was the last one
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::CompactStep(KeyType *key, bool *left_most, page_id_t *last_page_id, Transaction *transaction) {
+  std::shared_lock<std::shared_mutex> snapshot_guard(snapshot_latch_);
+  if (FindLeafPage(*key, *left_most, Operation::COMPACT, false, transaction) == nullptr) {
+    ReleaseLatches(transaction, false);
+    return false;
+  }
+  bool has_next = CompactLeaf(last_page_id, key, transaction);
+  ReleaseLatches(transaction, true);
+  *left_most = false;
+  return has_next;
+}
+
+/*
+ * Compact the leaf of the transaction's page set, whose path is write latched
+ * from the root latch down, and set key to the first key of the leaf to go on
+ * with. That is the same leaf when a page above it changed, as it was not
+ * moved yet, so that a step changes the pages above the ones it latched only
+ * in the ways a delete would.
+ * @return : false when the leaf was the last one
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::CompactLeaf(page_id_t *last_page_id, KeyType *key, Transaction *transaction) {
+  auto page_set = transaction->GetPageSet();
+  Page *page = page_set->back();
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  if (leaf_page->IsRootPage()) {
+    return false;
+  }
+  // an internal page is filled up in the step of its left most leaf, before the pages below it, whose path keeps its
+  // parent latched. The page set starts with the root latch unless the step released the pages above a safe one.
+  size_t first = page_set->front() == nullptr ? 2 : 1;
+  size_t top = page_set->size() - 1;
+  while (top > first &&
+         reinterpret_cast<InternalPage *>((*page_set)[top - 1]->GetData())->ValueIndex((*page_set)[top]->GetPageId()) ==
+             0) {
+    top--;
+  }
+  for (size_t level = top; level < page_set->size(); level++) {
+    auto *parent = reinterpret_cast<InternalPage *>((*page_set)[level - 1]->GetData());
+    auto *node = reinterpret_cast<BPlusTreePage *>((*page_set)[level]->GetData());
+    bool changed = node->IsLeafPage() ? FillFromSiblings(reinterpret_cast<LeafPage *>(node), parent, transaction)
+                                      : FillFromSiblings(reinterpret_cast<InternalPage *>(node), parent, transaction);
+    if (changed) {
+      *key = leaf_page->KeyAt(0);
+      return true;
+    }
+  }
+  auto *parent = reinterpret_cast<InternalPage *>((*page_set)[page_set->size() - 2]->GetData());
+  int index = parent->ValueIndex(page->GetPageId());
+
+  // a leaf stays where it is when it follows the previous one or the next one follows it, as does the previous leaf
+  // when a concurrent merge leads back to it
+  page_id_t page_id = page->GetPageId();
+  if (page_id == *last_page_id || page_id == *last_page_id + 1 || leaf_page->GetNextPageId() == page_id + 1) {
+    *last_page_id = page_id;
+  } else {
+    Page *prev_page = FindPreviousLeaf(transaction);
+    page_id_t new_page_id;
+    Page *new_page = buffer_pool_manager_->NewPage(&new_page_id);
+    if (new_page == nullptr) {
+      if (prev_page != nullptr) {
+        prev_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), false);
+      }
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page for compaction");
+    }
+    MarkNewPage(new_page_id);
+    // as for a split, the new page needs no latch while its parent and the previous leaf are write latched
+    auto *new_leaf = reinterpret_cast<LeafPage *>(new_page->GetData());
+    new_leaf->Init(new_page_id, parent->GetPageId(), leaf_max_size_);
+    leaf_page->MoveAllTo(new_leaf);
+    // a scan that waits for the old page goes on to the new one
+    leaf_page->SetNextPageId(new_page_id);
+    parent->SetValueAt(index, new_page_id);
+    if (prev_page != nullptr) {
+      auto *prev_leaf = reinterpret_cast<LeafPage *>(prev_page->GetData());
+      BUSTUB_ASSERT(prev_leaf->GetNextPageId() == page_id, "the previous leaf must link to the leaf");
+      prev_leaf->SetNextPageId(new_page_id);
+      prev_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+    }
+    transaction->AddIntoDeletedPageSet(page_id);
+    *last_page_id = new_page_id;
+    leaf_page = new_leaf;
+    page = new_page;
+  }
+
+  page_id_t next_page_id = leaf_page->GetNextPageId();
+  if (page != page_set->back()) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  if (next_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+  next_page->RLatch();
+  *key = reinterpret_cast<LeafPage *>(next_page->GetData())->KeyAt(0);
+  next_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page_id, false);
+  return true;
+}
+
+/*
+ * Move the entries of the right siblings of node into it for as long as they
+ * fit, then fill it up from the next sibling to the point where an insert
+ * would split it. The sibling may be left below its min size when it is not
+ * the last child, as it is filled up from its own sibling in turn.
+ * A merge that would underflow parent waits for a step that latches the page
+ * above it.
+ * @return : true when parent changed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+bool BPLUSTREE_TYPE::FillFromSiblings(N *node, InternalPage *parent, Transaction *transaction) {
+  int index = parent->ValueIndex(node->GetPageId());
+  bool changed = false;
+  while (index + 1 < parent->GetSize()) {
+    page_id_t sibling_page_id = parent->ValueAt(index + 1);
+    Page *sibling_page = buffer_pool_manager_->FetchPage(sibling_page_id);
+    sibling_page->WLatch();
+    PreserveForSnapshots(sibling_page);
+    auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+    int capacity = node->IsLeafPage()
+                       ? reinterpret_cast<LeafPage *>(node)->MaxSizeWith(*reinterpret_cast<LeafPage *>(sibling)) - 1
+                       : reinterpret_cast<InternalPage *>(node)->MaxSizeWith(*reinterpret_cast<InternalPage *>(sibling),
+                                                                             parent->KeyAt(index + 1)) -
+                             1;
+    if (node->GetSize() + sibling->GetSize() > capacity) {
+      int keep = index + 2 < parent->GetSize() ? 1 : sibling->GetMinSize();
+      KeyType separator = parent->KeyAt(index + 1);
+      bool moved = false;
+      while (sibling->GetSize() > keep) {
+        if (node->IsLeafPage()) {
+          auto *leaf = reinterpret_cast<LeafPage *>(node);
+          auto *sibling_leaf = reinterpret_cast<LeafPage *>(sibling);
+          if (leaf->GetSize() + 1 >= leaf->MaxSizeFor(sibling_leaf->KeyAt(0))) {
+            break;
+          }
+          sibling_leaf->MoveFirstToEndOf(leaf);
+        } else {
+          auto *internal = reinterpret_cast<InternalPage *>(node);
+          auto *sibling_internal = reinterpret_cast<InternalPage *>(sibling);
+          if (internal->GetSize() + 1 >= internal->MaxSizeFor(separator)) {
+            break;
+          }
+          KeyType next_separator = sibling_internal->KeyAt(1);
+          sibling_internal->MoveFirstToEndOf(internal, separator, buffer_pool_manager_);
+          separator = next_separator;
+        }
+        moved = true;
+      }
+      // the new separator may split the parent, as it does in Redistribute, which is then full and not safe
+      if (moved) {
+        if (node->IsLeafPage()) {
+          separator = InternalPage::ShortestSeparator(node->KeyAt(node->GetSize() - 1), sibling->KeyAt(0));
+        }
+        parent->SetKeyAt(index + 1, separator);
+        if (parent->GetSize() > parent->GetMaxSize()) {
+          SplitInternal(parent, transaction);
+        }
+      }
+      sibling_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(sibling_page_id, moved);
+      return changed || moved;
+    }
+    bool changes_above = parent->IsRootPage() ? parent->GetSize() == 2 : parent->GetSize() - 1 < parent->GetMinSize();
+    if (changes_above && !HoldsParentLatch(parent, transaction)) {
+      sibling_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(sibling_page_id, false);
+      return changed;
+    }
+    if (Coalesce(&node, &sibling, &parent, index + 1, transaction)) {
+      transaction->AddIntoDeletedPageSet(parent->GetPageId());
+    }
+    sibling_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(sibling_page_id, true);
+    transaction->AddIntoDeletedPageSet(sibling_page_id);
+    if (changes_above) {
+      return true;
+    }
+    changed = true;
+  }
+  return changed;
+}
+
+/*
+ * Write latch the leaf before the one of the transaction's page set, by way of
+ * the lowest ancestor on the path with a child to the left of it
+ * @return : the leaf page, nullptr for the left most leaf
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindPreviousLeaf(Transaction *transaction) {
+  auto page_set = transaction->GetPageSet();
+  // the page set starts with the root latch, or with the lowest ancestor a step keeps, which has such a child
+  size_t first = page_set->front() == nullptr ? 1 : 0;
+  for (size_t level = page_set->size() - 1; level > first; level--) {
+    auto *ancestor = reinterpret_cast<InternalPage *>((*page_set)[level - 1]->GetData());
+    int index = ancestor->ValueIndex((*page_set)[level]->GetPageId());
+    if (index == 0) {
+      continue;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(ancestor->ValueAt(index - 1));
+    LatchForDescent(page, Operation::COMPACT);
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    while (!node->IsLeafPage()) {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      Page *child = buffer_pool_manager_->FetchPage(internal->ValueAt(internal->GetSize() - 1));
+      LatchForDescent(child, Operation::COMPACT);
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = child;
+      node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    }
+    PreserveForSnapshots(page);
+    return page;
+  }
+  return nullptr;
+}
+
+/*****************************************************************************
+ * SNAPSHOT
+ *****************************************************************************/
+/*
+ * Take a snapshot at the current root, with no write in progress. The pages
+ * the root leads to are then left as the writes before the snapshot left them,
+ * and each write from then on copies a page for the snapshot before it changes
+ * the page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::shared_ptr<BPLUSTREE_SNAPSHOT_TYPE> BPLUSTREE_TYPE::Snapshot() {
+  std::unique_lock<std::shared_mutex> snapshot_guard(snapshot_latch_);
+  root_latch_.RLock();
+  auto snapshot = std::make_shared<BPLUSTREE_SNAPSHOT_TYPE>(buffer_pool_manager_, comparator_, root_page_id_);
+  root_latch_.RUnlock();
+  snapshots_.erase(std::remove_if(snapshots_.begin(), snapshots_.end(),
+                                  [](const std::weak_ptr<BPLUSTREE_SNAPSHOT_TYPE> &taken) { return taken.expired(); }),
+                   snapshots_.end());
+  snapshots_.emplace_back(snapshot);
+  return snapshot;
+}
+
+/*
+ * Hand a copy of the write latched page to each snapshot that still reads the
+ * page as it is, before the page changes. The snapshots share one copy.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::PreserveForSnapshots(Page *page) {
+  std::shared_ptr<SnapshotPage> copy;
+  for (const auto &taken : snapshots_) {
+    if (auto snapshot = taken.lock()) {
+      snapshot->Preserve(page, &copy);
+    }
+  }
+}
+
+/*
+ * Tell the snapshots about a page allocated by a write, which they do not
+ * read, so that they need no copy of it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::MarkNewPage(page_id_t page_id) {
+  for (const auto &taken : snapshots_) {
+    if (auto snapshot = taken.lock()) {
+      snapshot->AddNewPage(page_id);
+    }
+  }
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -431,7 +1344,7 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return BeginRange(nullptr, true, nullptr, true, 0); }
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -439,7 +1352,7 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return BeginRange(&key, true, nullptr, true, 0); }
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -449,34 +1362,485 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERA
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() { return INDEXITERATOR_TYPE(); }
 
+/*
+ * Input parameters are the bounds of a range scan, find the leaf page of the
+ * lower bound (the left most one if it is open) and position the iterator at
+ * its first key in range, the iterator stops at the upper bound
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::BeginRange(const KeyType *lower, bool lower_inclusive, const KeyType *upper,
+                                              bool upper_inclusive, int prefetch_size) {
+  int index = 0;
+  Page *page = lower == nullptr ? FindLeafPage(KeyType(), true, Operation::FIND, true, nullptr)
+                                : FindLeafAfter(*lower, lower_inclusive, &index);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  auto resume = [this](const KeyType &key, int *index) { return FindLeafAfter(key, false, index); };
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index, &comparator_, upper, upper_inclusive, prefetch_size,
+                            resume);
+}
+
+/*
+ * Input parameter is void, find the right most leaf page first, then
+ * construct a descending index iterator at its last key
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin() {
+  int index = 0;
+  Page *page = FindLeafBefore(nullptr, false, &index);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  auto resume_before = [this](const KeyType &key, int *index) { return FindLeafBefore(&key, false, index); };
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index, resume_before);
+}
+
+/*
+ * Input parameter is high key, find the leaf page that contains the greatest
+ * key not above it first, then construct a descending index iterator there
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin(const KeyType &key) {
+  int index = 0;
+  Page *page = FindLeafBefore(&key, true, &index);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  auto resume_before = [this](const KeyType &key, int *index) { return FindLeafBefore(&key, false, index); };
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, index, resume_before);
+}
+
+/*
+ * Find the leaf page of key and the index of its first key not below key, or
+ * above key if inclusive is false; the index is the size of the leaf if there
+ * is none
+ * @return : the read latched leaf page, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafAfter(const KeyType &key, bool inclusive, int *index) {
+  Page *page = FindLeafPage(key, false, Operation::FIND, true, nullptr);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  *index = leaf_page->KeyIndex(key, comparator_);
+  if (!inclusive && *index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(*index), key) == 0) {
+    (*index)++;
+  }
+  return page;
+}
+
+/*
+ * Find the leaf page holding the greatest key below key, or not above key if
+ * inclusive is set, or the greatest key of all if key is null, and its index.
+ * The descent takes the child right before key at every level. Should the
+ * leaf reached hold no such key, as its smaller keys were removed, the search
+ * is repeated for the keys below the separator on the way down that bounds the
+ * leaf from below.
+ * @return : the read latched leaf page, nullptr if there is no such key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafBefore(const KeyType *key, bool inclusive, int *index) {
+  KeyType fence;
+  KeyType bound;
+  while (true) {
+    RepinIfChanged();
+    root_latch_.RLock();
+    if (IsEmpty()) {
+      root_latch_.RUnlock();
+      return nullptr;
+    }
+    bool pinned;
+    Page *page = FetchNode(root_page_id_, &pinned);
+    page->RLatch();
+    if (!pinned) {
+      root_latch_.RUnlock();
+    }
+    bool has_fence = false;
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    while (!node->IsLeafPage()) {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      int child_index = key == nullptr ? internal->GetSize() - 1
+                        : inclusive    ? internal->LookupIndex(*key, comparator_)
+                                       : internal->LookupIndexBefore(*key, comparator_);
+      if (child_index > 0) {
+        fence = internal->KeyAt(child_index);
+        has_fence = true;
+      }
+      bool child_pinned = false;
+      Page *child = pinned ? FetchNode(internal->ValueAt(child_index), &child_pinned)
+                           : buffer_pool_manager_->FetchPage(internal->ValueAt(child_index));
+      child->RLatch();
+      page->RUnlatch();
+      if (!pinned) {
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      } else if (!child_pinned) {
+        root_latch_.RUnlock();
+      }
+      page = child;
+      pinned = child_pinned;
+      node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    }
+
+    auto *leaf_page = reinterpret_cast<LeafPage *>(node);
+    int last = leaf_page->GetSize() - 1;
+    if (key != nullptr) {
+      last = leaf_page->KeyIndex(*key, comparator_) - 1;
+      if (inclusive && last + 1 < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(last + 1), *key) == 0) {
+        last++;
+      }
+    }
+    if (last >= 0) {
+      *index = last;
+      return page;
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!has_fence) {
+      return nullptr;
+    }
+    bound = fence;
+    key = &bound;
+    inclusive = false;
+  }
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
- * the left most leaf page
+ * the left most leaf page. The page is returned pinned but not latched.
  */
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
-  if(root_page_id_==INVALID_PAGE_ID){
-    throw "not a tree";
-  }
-  //page_id_t page_id=root_page_id_;
-  Page*page=buffer_pool_manager_->FetchPage(root_page_id_,nullptr);
-  auto root_page=reinterpret_cast<InternalPage*>(page->GetData());//这里不同,没有getdata应该是错的
-  while(!root_page->IsLeafPage()){ 
-    int index=leftMost?root_page->ValueAt(0):root_page->Lookup(key,comparator_);   
-    //强制转为page_id
-    page_id_t next_page_id=root_page->ValueAt(index);
-    buffer_pool_manager_->UnpinPage(root_page->GetPageId(),false);   
-    page=buffer_pool_manager_->FetchPage(next_page_id,nullptr);
-    root_page=reinterpret_cast<InternalPage*>(page->GetData());
-    //page_id=next_page_id;
+  Page *page = FindLeafPage(key, leftMost, Operation::FIND, true, nullptr);
+  if (page != nullptr) {
+    page->RUnlatch();
   }
   return page;
 }
 
+/*
+ * Descend to the leaf page for key (the left most one if left_most is set),
+ * latch crabbing on the way down. Returns nullptr if the tree is empty.
+ * FIND or optimistic: read latches are taken child before parent, and the leaf
+ * is returned read latched for FIND and write latched otherwise. No other latch
+ * is held on return.
+ * Pessimistic: write latches are taken from the root latch down, and the ones
+ * above a node that is safe for op are released. The latches still held, the
+ * leaf last and nullptr for the root latch, are left in the transaction's page
+ * set for ReleaseLatches. The root latch stays held on an empty tree.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool left_most, Operation op, bool optimistic,
+                                   Transaction *transaction) {
+  if (op == Operation::FIND || optimistic) {
+    RepinIfChanged();
+    root_latch_.RLock();
+    if (IsEmpty()) {
+      root_latch_.RUnlock();
+      return nullptr;
+    }
+    // the root latch stays held while the descent is on pinned pages, which are only unpinned under its write latch
+    bool pinned;
+    Page *page = FetchNode(root_page_id_, &pinned);
+    LatchForDescent(page, op);
+    if (!pinned) {
+      root_latch_.RUnlock();
+    }
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    while (!node->IsLeafPage()) {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      page_id_t child_page_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+      bool child_pinned = false;
+      Page *child = pinned ? FetchNode(child_page_id, &child_pinned) : buffer_pool_manager_->FetchPage(child_page_id);
+      LatchForDescent(child, op);
+      page->RUnlatch();
+      if (!pinned) {
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      } else if (!child_pinned) {
+        root_latch_.RUnlock();
+      }
+      page = child;
+      pinned = child_pinned;
+      node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    }
+    return page;
+  }
+
+  root_latch_.WLock();
+  if (upper_levels_changed_) {
+    RepinUpperLevels();
+  }
+  transaction->AddIntoPageSet(nullptr);
+  if (IsEmpty()) {
+    return nullptr;
+  }
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    page->WLatch();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    // a left most compaction step has no key to tell the path to the previous leaf by, nor a previous leaf
+    if ((!left_most || op != Operation::COMPACT) && IsSafe(node, op, key)) {
+      ReleaseLatches(transaction, false);
+    }
+    transaction->AddIntoPageSet(page);
+    if (node->IsLeafPage()) {
+      // the pages still latched are the ones the operation may change
+      for (Page *latched_page : *transaction->GetPageSet()) {
+        if (latched_page != nullptr) {
+          PreserveForSnapshots(latched_page);
+        }
+      }
+      return page;
+    }
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+  }
+}
+
+/*
+ * Read latch a page reached by an optimistic descent, or write latch it when
+ * it is the leaf of an insert or delete. The caller still holds the latch
+ * above the page, so a leaf cannot be split or merged while its read latch is
+ * traded for a write latch.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LatchForDescent(Page *page, Operation op) {
+  page->RLatch();
+  if (op != Operation::FIND && reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    page->RUnlatch();
+    page->WLatch();
+  }
+}
+
+/*
+ * A node is safe for op on key when op cannot split or merge it, so that its
+ * ancestors are left untouched.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation op, const KeyType &key) const {
+  if (op == Operation::INSERT) {
+    // a leaf splits when it reaches max size, which the key may lower, an internal page when it exceeds it
+    return node->IsLeafPage() ? node->GetSize() + 1 < reinterpret_cast<LeafPage *>(node)->MaxSizeFor(key)
+                              : node->GetSize() < node->GetMaxSize();
+  }
+  if (op == Operation::COMPACT) {
+    // a compaction step changes the pages above one a delete leaves alone only through merges that underflow it, which
+    // wait for the next step when its parent is not latched. The path to the previous leaf goes through the page when
+    // it has a child left of the path.
+    return !node->IsLeafPage() && reinterpret_cast<InternalPage *>(node)->LookupIndex(key, comparator_) > 0 &&
+           IsSafe(node, Operation::DELETE, key);
+  }
+  if (op == Operation::DELETE) {
+    // a full internal page splits when a redistribution below it takes a longer separator
+    if (!node->IsLeafPage() && node->GetSize() >= node->GetMaxSize()) {
+      return false;
+    }
+    if (node->IsRootPage()) {
+      // a root leaf goes away with its last entry, an internal root when a single child is left
+      return node->IsLeafPage() ? node->GetSize() > 1 : node->GetSize() > 2;
+    }
+    return node->GetSize() > node->GetMinSize();
+  }
+  return true;
+}
+
+/*
+ * Release the latches in the transaction's page set, unpinning their pages,
+ * then delete the pages in its deleted page set.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseLatches(Transaction *transaction, bool is_dirty) {
+  auto page_set = transaction->GetPageSet();
+  for (Page *page : *page_set) {
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+      continue;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+  page_set->clear();
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  if (!deleted_page_set->empty() && pinned_levels_ > 0) {
+    // a pinned page that goes away is unpinned first, no descent is on the pinned pages under the root write latch
+    root_latch_.WLock();
+    for (page_id_t page_id : *deleted_page_set) {
+      if (pinned_pages_.erase(page_id) != 0) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+      }
+    }
+    root_latch_.WUnlock();
+  }
+  for (page_id_t page_id : *deleted_page_set) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  deleted_page_set->clear();
+}
+
+/*
+ * Whether the page is write latched by this thread, as part of the
+ * transaction's page set
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::HoldsLatch(page_id_t page_id, Transaction *transaction) const {
+  if (transaction == nullptr) {
+    return false;
+  }
+  auto page_set = transaction->GetPageSet();
+  return std::any_of(page_set->begin(), page_set->end(),
+                     [page_id](Page *page) { return page != nullptr && page->GetPageId() == page_id; });
+}
+
+/*
+ * Whether the page above an internal page, or the root latch above the root,
+ * is write latched by this thread
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::HoldsParentLatch(InternalPage *node, Transaction *transaction) const {
+  if (node->IsRootPage()) {
+    return transaction->GetPageSet()->front() == nullptr;
+  }
+  return HoldsLatch(node->GetParentPageId(), transaction);
+}
+
+/*
+ * Write latch a page into the transaction's page set, unless it is there
+ * already
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::LatchOnce(page_id_t page_id, Transaction *transaction) {
+  auto page_set = transaction->GetPageSet();
+  for (Page *page : *page_set) {
+    if (page != nullptr && page->GetPageId() == page_id) {
+      return page;
+    }
+  }
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  page->WLatch();
+  PreserveForSnapshots(page);
+  transaction->AddIntoPageSet(page);
+  return page;
+}
+
+/*
+ * Fetch the page of a node reached with the root latch held, from the pinned
+ * pages if it is one of them, which the caller must then not unpin
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchNode(page_id_t page_id, bool *pinned) {
+  auto iterator = pinned_pages_.find(page_id);
+  *pinned = iterator != pinned_pages_.end();
+  return *pinned ? iterator->second : buffer_pool_manager_->FetchPage(page_id);
+}
+
+/*
+ * Have the pinned pages collected anew by the next descent, after the root or
+ * an internal page changed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::MarkUpperLevelsChanged() {
+  if (pinned_levels_ > 0) {
+    upper_levels_changed_ = true;
+  }
+}
+
+/*
+ * Unpin the pinned pages, then pin the internal pages of the top levels level
+ * by level, as long as they take at most half of the buffer pool. Called with
+ * the root write latch and no page latch held.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RepinUpperLevels() {
+  UnpinUpperLevels();
+  if (IsEmpty()) {
+    return;
+  }
+  const size_t budget = buffer_pool_manager_->GetPoolSize() / 2;
+  std::vector<page_id_t> level{root_page_id_};
+  for (int depth = 0; depth < pinned_levels_ && !level.empty(); depth++) {
+    std::vector<page_id_t> next_level;
+    for (page_id_t page_id : level) {
+      if (pinned_pages_.size() >= budget) {
+        return;
+      }
+      Page *page = buffer_pool_manager_->FetchPage(page_id);
+      page->RLatch();
+      auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      if (node->IsLeafPage()) {
+        // every leaf is on the same level, which is left unpinned
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return;
+      }
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      for (int i = 0; i < internal->GetSize(); i++) {
+        next_level.push_back(internal->ValueAt(i));
+      }
+      page->RUnlatch();
+      pinned_pages_.emplace(page_id, page);
+    }
+    level = std::move(next_level);
+  }
+}
+
+/*
+ * Unpin the pinned pages, with the root write latch held or no other thread
+ * left on the tree
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::UnpinUpperLevels() {
+  upper_levels_changed_ = false;
+  for (const auto &[page_id, page] : pinned_pages_) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+  pinned_pages_.clear();
+}
+
+/*
+ * Collect the pinned pages anew if the upper levels changed, with no latch held
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RepinIfChanged() {
+  if (upper_levels_changed_) {
+    root_latch_.WLock();
+    if (upper_levels_changed_) {
+      RepinUpperLevels();
+    }
+    root_latch_.WUnlock();
+  }
+}
+
+/*
+ * Keep the internal pages of the top levels pinned, 0 unpins them
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::PinUpperLevels(int levels) {
+  root_latch_.WLock();
+  pinned_levels_ = levels;
+  RepinUpperLevels();
+  root_latch_.WUnlock();
+}
+
+/*
+ * A latched leaf covers key when key belongs to it whatever its separators in
+ * the parent are: key lies between its first and last keys, or after its
+ * first key on the right most leaf.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::LeafCovers(LeafPage *leaf_page, const KeyType &key) const {
+  int size = leaf_page->GetSize();
+  return size > 0 && comparator_(leaf_page->KeyAt(0), key) <= 0 &&
+         (leaf_page->GetNextPageId() == INVALID_PAGE_ID || comparator_(key, leaf_page->KeyAt(size - 1)) <= 0);
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -488,13 +1852,18 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  // the header page is shared by every index, which may be built concurrently
+  header_page->WLatch();
   if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
+    // create a new record<index_name + root_page_id> in header_page, the record survives an emptied tree
+    if (!header_page->InsertRecord(index_name_, root_page_id_)) {
+      header_page->UpdateRecord(index_name_, root_page_id_);
+    }
   } else {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
+  header_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
@@ -506,12 +1875,18 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertFromFile(const std::string &file_name, Transaction *transaction) {
   int64_t key;
   std::ifstream input(file_name);
-  while (input) {
-    input >> key;
-
+  std::vector<MappingType> entries;
+  while (input >> key) {
     KeyType index_key;
     index_key.SetFromInteger(key);
-    RID rid(key);
+    entries.emplace_back(index_key, RID(key));
+  }
+  // an empty tree is bulk loaded
+  if (IsEmpty()) {
+    BulkLoad(entries.begin(), entries.end(), 1.0, transaction);
+    return;
+  }
+  for (const auto &[index_key, rid] : entries) {
     Insert(index_key, rid, transaction);
   }
 }
@@ -662,5 +2037,6 @@ template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<GenericKey<128>, RID, GenericComparator<128>>;
 
 }  // namespace bustub
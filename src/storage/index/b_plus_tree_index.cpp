@@ -11,56 +11,175 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "common/exception.h"
+
 namespace bustub {
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     bool unique, int pinned_levels)
     : Index(std::move(metadata)),
+      unique_(unique),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {
+  if (!unique_ && (sizeof(KeyType) <= KEY_RID_SIZE || MaxEncodedKeySize(GetKeySchema()) > KeySize())) {
+    throw Exception(ExceptionType::INVALID, "the keys of a non-unique index need room for a RID");
+  }
+  if (pinned_levels > 0) {
+    container_.PinUpperLevels(pinned_levels);
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
-  // construct insert index key
+KeyType BPLUSTREE_INDEX_TYPE::MakeKey(const Tuple &key, const RID &rid) const {
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema(), KeySize());
+  if (!unique_) {
+    index_key.SetRid(rid);
+  }
+  return index_key;
+}
 
-  container_.Insert(index_key, rid, transaction);
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t BPLUSTREE_INDEX_TYPE::KeySize() const {
+  return unique_ ? sizeof(KeyType) : sizeof(KeyType) - KEY_RID_SIZE;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
-  // construct delete index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+KeyType BPLUSTREE_INDEX_TYPE::RidBound(const KeyType &key, bool highest) const {
+  KeyType bound = key;
+  bound.SetRid(highest ? RID(std::numeric_limits<page_id_t>::max(), std::numeric_limits<uint32_t>::max())
+                       : RID(std::numeric_limits<page_id_t>::min(), 0));
+  return bound;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Insert(MakeKey(key, rid), rid, transaction);
+}
 
-  container_.Remove(index_key, transaction);
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Remove(MakeKey(key, rid), transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema(), KeySize());
+
+  if (unique_) {
+    container_.GetValue(index_key, result, transaction);
+    return;
+  }
+  // the entries of a key lie next to each other, in RID order
+  KeyType lower = RidBound(index_key, false);
+  KeyType upper = RidBound(index_key, true);
+  for (auto iterator = container_.BeginRange(&lower, true, &upper, true); !iterator.IsEnd(); ++iterator) {
+    result->push_back((*iterator).second);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                   Transaction *transaction) {
+  if (!unique_) {
+    Index::ScanKeys(keys, results, transaction);
+    return;
+  }
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromKey(keys[i], GetKeySchema());
+  }
+  // the keys are looked up in sorted order, so that runs of keys that share a leaf take one descent
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](size_t lhs, size_t rhs) { return comparator_(index_keys[lhs], index_keys[rhs]) < 0; });
+  std::vector<KeyType> sorted_keys;
+  sorted_keys.reserve(keys.size());
+  for (size_t i : order) {
+    sorted_keys.emplace_back(index_keys[i]);
+  }
+  std::vector<std::vector<RID>> sorted_results;
+  container_.GetValues(sorted_keys, &sorted_results, transaction);
+  results->assign(keys.size(), std::vector<RID>());
+  for (size_t i = 0; i < order.size(); i++) {
+    (*results)[order[i]] = std::move(sorted_results[i]);
+  }
+}
 
-  container_.GetValue(index_key, result, transaction);
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntries(std::vector<std::pair<Tuple, RID>> *entries, Transaction *transaction) {
+  std::vector<std::pair<KeyType, ValueType>> pairs;
+  pairs.reserve(entries->size());
+  for (const auto &[key, rid] : *entries) {
+    pairs.emplace_back(MakeKey(key, rid), rid);
+  }
+  if (!container_.IsEmpty()) {
+    // sorted, runs of entries that share a leaf go in with one descent; the stable sort keeps the first entry of a key
+    std::stable_sort(pairs.begin(), pairs.end(),
+                     [&](const auto &lhs, const auto &rhs) { return comparator_(lhs.first, rhs.first) < 0; });
+    container_.InsertBatch(pairs, transaction);
+    return;
+  }
+  // an empty tree is bulk loaded, keeping the first entry of each key as Insert would
+  container_.BulkLoad(pairs.begin(), pairs.end(), 1.0, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::Destroy(Transaction *transaction) { container_.Clear(transaction); }
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.Begin(); }
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) { return container_.Begin(key); }
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) {
+  return container_.Begin(unique_ ? key : RidBound(key, false));
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() { return container_.End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetRangeIterator(const KeyType *lower, bool lower_inclusive,
+                                                          const KeyType *upper, bool upper_inclusive) {
+  if (unique_) {
+    return container_.BeginRange(lower, lower_inclusive, upper, upper_inclusive);
+  }
+  // an included bound takes in every RID of its key, an excluded one leaves them all out
+  KeyType lower_bound;
+  KeyType upper_bound;
+  if (lower != nullptr) {
+    lower_bound = RidBound(*lower, !lower_inclusive);
+  }
+  if (upper != nullptr) {
+    upper_bound = RidBound(*upper, upper_inclusive);
+  }
+  return container_.BeginRange(lower != nullptr ? &lower_bound : nullptr, lower_inclusive,
+                               upper != nullptr ? &upper_bound : nullptr, upper_inclusive);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator() { return container_.RBegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator(const KeyType &key) {
+  return container_.RBegin(unique_ ? key : RidBound(key, true));
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<GenericKey<128>, RID, GenericComparator<128>>;
 
 }  // namespace bustub
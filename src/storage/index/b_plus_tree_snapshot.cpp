@@ -0,0 +1,212 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/b_plus_tree_snapshot.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/b_plus_tree_snapshot.h"
+
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+SnapshotPage::SnapshotPage(BufferPoolManager *buffer_pool_manager, Page *page)
+    : buffer_pool_manager_(buffer_pool_manager) {
+  Page *copy = buffer_pool_manager_->NewPage(&page_id_);
+  if (copy == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page for a snapshot");
+  }
+  memcpy(copy->GetData(), page->GetData(), PAGE_SIZE);
+  buffer_pool_manager_->UnpinPage(page_id_, true);
+}
+
+SnapshotPage::~SnapshotPage() { buffer_pool_manager_->DeletePage(page_id_); }
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_SNAPSHOT_TYPE::BPlusTreeSnapshot(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                                           page_id_t root_page_id)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), root_page_id_(root_page_id) {}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Return the value the key had when the snapshot was taken
+ * @return : true means key exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_SNAPSHOT_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) const {
+  bool latched;
+  Page *page = FindLeafPage(key, false, &latched);
+  if (page == nullptr) {
+    return false;
+  }
+  ValueType value;
+  bool found = reinterpret_cast<LeafPage *>(page->GetData())->Lookup(key, &value, comparator_);
+  if (found) {
+    result->emplace_back(value);
+  }
+  ReleasePage(page, latched);
+  return found;
+}
+
+/*****************************************************************************
+ * ITERATOR
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+typename BPLUSTREE_SNAPSHOT_TYPE::Iterator BPLUSTREE_SNAPSHOT_TYPE::Begin() const {
+  Iterator iterator;
+  iterator.snapshot_ = this;
+  bool latched;
+  Page *page = FindLeafPage(KeyType(), true, &latched);
+  if (page != nullptr) {
+    iterator.next_page_id_ = ReadLeaf(page, 0, &iterator.items_);
+    ReleasePage(page, latched);
+  }
+  iterator.SkipExhaustedLeaves();
+  return iterator;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename BPLUSTREE_SNAPSHOT_TYPE::Iterator BPLUSTREE_SNAPSHOT_TYPE::Begin(const KeyType &key) const {
+  Iterator iterator;
+  iterator.snapshot_ = this;
+  bool latched;
+  Page *page = FindLeafPage(key, false, &latched);
+  if (page != nullptr) {
+    int index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_);
+    iterator.next_page_id_ = ReadLeaf(page, index, &iterator.items_);
+    ReleasePage(page, latched);
+  }
+  iterator.SkipExhaustedLeaves();
+  return iterator;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename BPLUSTREE_SNAPSHOT_TYPE::Iterator &BPLUSTREE_SNAPSHOT_TYPE::Iterator::operator++() {
+  index_++;
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_SNAPSHOT_TYPE::Iterator::SkipExhaustedLeaves() {
+  while (index_ == items_.size() && next_page_id_ != INVALID_PAGE_ID) {
+    items_.clear();
+    index_ = 0;
+    bool latched;
+    Page *page = snapshot_->FetchPage(next_page_id_, &latched);
+    next_page_id_ = snapshot_->ReadLeaf(page, 0, &items_);
+    snapshot_->ReleasePage(page, latched);
+  }
+}
+
+/*****************************************************************************
+ * COPY ON WRITE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_SNAPSHOT_TYPE::Preserve(Page *page, std::shared_ptr<SnapshotPage> *copy) {
+  std::lock_guard<std::mutex> guard(latch_);
+  page_id_t page_id = page->GetPageId();
+  if (copies_.count(page_id) != 0 || new_pages_.count(page_id) != 0) {
+    return;
+  }
+  if (*copy == nullptr) {
+    *copy = std::make_shared<SnapshotPage>(buffer_pool_manager_, page);
+  }
+  copies_.emplace(page_id, *copy);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_SNAPSHOT_TYPE::AddNewPage(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  new_pages_.insert(page_id);
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+/*
+ * Fetch the page of the snapshot for page_id. A tree page that has no copy yet
+ * is read latched and looked up again, since a writer may have copied and
+ * changed it in the meantime. With the read latch held it stays unchanged for
+ * as long as it is read.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_SNAPSHOT_TYPE::FetchPage(page_id_t page_id, bool *latched) const {
+  auto copy_of = [this](page_id_t page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto iterator = copies_.find(page_id);
+    return iterator == copies_.end() ? INVALID_PAGE_ID : iterator->second->GetPageId();
+  };
+  page_id_t copy_page_id = copy_of(page_id);
+  if (copy_page_id == INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    page->RLatch();
+    copy_page_id = copy_of(page_id);
+    if (copy_page_id == INVALID_PAGE_ID) {
+      *latched = true;
+      return page;
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+  *latched = false;
+  return buffer_pool_manager_->FetchPage(copy_page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_SNAPSHOT_TYPE::ReleasePage(Page *page, bool latched) const {
+  if (latched) {
+    page->RUnlatch();
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+}
+
+/*
+ * Find the leaf of the snapshot that contains key, or the left most one, with
+ * a single page of the snapshot fetched at a time
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_SNAPSHOT_TYPE::FindLeafPage(const KeyType &key, bool left_most, bool *latched) const {
+  if (IsEmpty()) {
+    return nullptr;
+  }
+  Page *page = FetchPage(root_page_id_, latched);
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+    ReleasePage(page, *latched);
+    page = FetchPage(child_page_id, latched);
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_SNAPSHOT_TYPE::ReadLeaf(Page *page, int index, std::vector<MappingType> *items) const {
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  for (; index < leaf_page->GetSize(); index++) {
+    items->emplace_back(leaf_page->GetItem(index));
+  }
+  return leaf_page->GetNextPageId();
+}
+
+template class BPlusTreeSnapshot<GenericKey<4>, RID, GenericComparator<4>>;
+template class BPlusTreeSnapshot<GenericKey<8>, RID, GenericComparator<8>>;
+template class BPlusTreeSnapshot<GenericKey<16>, RID, GenericComparator<16>>;
+template class BPlusTreeSnapshot<GenericKey<32>, RID, GenericComparator<32>>;
+template class BPlusTreeSnapshot<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeSnapshot<GenericKey<128>, RID, GenericComparator<128>>;
+
+}  // namespace bustub
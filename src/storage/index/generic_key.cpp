@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key.cpp
+//
+// Identification: src/storage/index/generic_key.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/generic_key.h"
+
+#include "common/exception.h"
+#include "type/limits.h"
+#include "type/type.h"
+
+namespace bustub {
+
+namespace {
+/** Writes byte at *offset unless it lies past size, and advances *offset. */
+inline void PutByte(uint8_t byte, char *data, uint32_t size, uint32_t *offset) {
+  if (*offset < size) {
+    data[*offset] = static_cast<char>(byte);
+  }
+  (*offset)++;
+}
+
+/** Writes the low width bytes of bits, most significant first. */
+inline void PutBigEndian(uint64_t bits, uint32_t width, char *data, uint32_t size, uint32_t *offset) {
+  for (uint32_t i = width; i > 0; i--) {
+    PutByte(static_cast<uint8_t>(bits >> (8 * (i - 1))), data, size, offset);
+  }
+}
+
+/** Writes a signed integer of width bytes, flipping its sign bit so that it orders as an unsigned one. */
+inline void PutSigned(int64_t integer, uint32_t width, char *data, uint32_t size, uint32_t *offset) {
+  const uint64_t sign = uint64_t{1} << (8 * width - 1);
+  PutBigEndian(static_cast<uint64_t>(integer) ^ sign, width, data, size, offset);
+}
+}  // namespace
+
+void EncodeKeyValue(const Value &value, char *data, uint32_t size, uint32_t *offset) {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      PutSigned(value.GetAs<int8_t>(), sizeof(int8_t), data, size, offset);
+      break;
+    case TypeId::SMALLINT:
+      PutSigned(value.GetAs<int16_t>(), sizeof(int16_t), data, size, offset);
+      break;
+    case TypeId::INTEGER:
+      PutSigned(value.GetAs<int32_t>(), sizeof(int32_t), data, size, offset);
+      break;
+    case TypeId::BIGINT:
+      PutSigned(value.GetAs<int64_t>(), sizeof(int64_t), data, size, offset);
+      break;
+    case TypeId::DECIMAL: {
+      double decimal = value.GetAs<double>();
+      uint64_t bits;
+      memcpy(&bits, &decimal, sizeof(bits));
+      const uint64_t sign = uint64_t{1} << 63;
+      PutBigEndian((bits & sign) != 0 ? ~bits : bits | sign, sizeof(bits), data, size, offset);
+      break;
+    }
+    case TypeId::TIMESTAMP: {
+      // the NULL timestamp is the largest one, shift the others up past 0 to make room for it
+      uint64_t timestamp = value.GetAs<uint64_t>();
+      PutBigEndian(timestamp == BUSTUB_TIMESTAMP_NULL ? 0 : timestamp + 1, sizeof(timestamp), data, size, offset);
+      break;
+    }
+    case TypeId::VARCHAR: {
+      if (value.IsNull()) {
+        PutByte(0x00, data, size, offset);
+        break;
+      }
+      PutByte(0x01, data, size, offset);
+      // the stored length counts the terminating '\0'
+      const char *chars = value.GetData();
+      const uint32_t length = value.GetLength() == 0 ? 0 : value.GetLength() - 1;
+      for (uint32_t i = 0; i < length && *offset < size; i++) {
+        PutByte(static_cast<uint8_t>(chars[i]), data, size, offset);
+        if (chars[i] == '\0') {
+          PutByte(0xFF, data, size, offset);
+        }
+      }
+      PutByte(0x00, data, size, offset);
+      PutByte(0x00, data, size, offset);
+      break;
+    }
+    default:
+      throw Exception(ExceptionType::MISMATCH_TYPE, "type cannot be part of an index key");
+  }
+}
+
+uint32_t MaxEncodedKeySize(const Schema *key_schema) {
+  uint32_t size = 0;
+  for (const Column &column : key_schema->GetColumns()) {
+    if (column.GetType() == TypeId::VARCHAR) {
+      // the NULL marker, every character escaped, and the terminator
+      size += 1 + 2 * column.GetLength() + 2;
+    } else {
+      size += Type::GetTypeSize(column.GetType());
+    }
+  }
+  return size;
+}
+
+int64_t DecodeKeyInteger(const char *data, uint32_t size) {
+  const uint32_t width = size < sizeof(int64_t) ? sizeof(int32_t) : sizeof(int64_t);
+  uint64_t bits = 0;
+  for (uint32_t i = 0; i < width && i < size; i++) {
+    bits = (bits << 8) | static_cast<uint8_t>(data[i]);
+  }
+  bits ^= uint64_t{1} << (8 * width - 1);
+  return width == sizeof(int32_t) ? static_cast<int32_t>(bits) : static_cast<int64_t>(bits);
+}
+
+void EncodeKeyRid(const RID &rid, char *data) {
+  uint32_t offset = 0;
+  PutSigned(rid.GetPageId(), sizeof(page_id_t), data, KEY_RID_SIZE, &offset);
+  PutBigEndian(rid.GetSlotNum(), sizeof(uint32_t), data, KEY_RID_SIZE, &offset);
+}
+
+RID DecodeKeyRid(const char *data) {
+  uint64_t bits = 0;
+  for (uint32_t i = 0; i < KEY_RID_SIZE; i++) {
+    bits = (bits << 8) | static_cast<uint8_t>(data[i]);
+  }
+  auto page_id = static_cast<page_id_t>(static_cast<uint32_t>(bits >> 32) ^ (uint32_t{1} << 31));
+  return RID(page_id, static_cast<uint32_t>(bits));
+}
+
+}  // namespace bustub
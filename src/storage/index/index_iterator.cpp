@@ -2,7 +2,9 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
+#include "common/exception.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -15,16 +17,239 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index)
+    : buffer_pool_manager_(buffer_pool_manager),
+      page_(page),
+      leaf_(reinterpret_cast<LeafPage *>(page->GetData())),
+      page_id_(page->GetPageId()),
+      index_(index) {
+  SkipExhaustedLeaves();
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-bool INDEXITERATOR_TYPE::IsEnd() { throw std::runtime_error("unimplemented"); }
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index,
+                                  const KeyComparator *comparator, const KeyType *upper, bool upper_inclusive,
+                                  int prefetch_size, std::function<Page *(const KeyType &, int *)> resume)
+    : buffer_pool_manager_(buffer_pool_manager),
+      page_(page),
+      leaf_(reinterpret_cast<LeafPage *>(page->GetData())),
+      page_id_(page->GetPageId()),
+      index_(index),
+      comparator_(comparator),
+      has_upper_(upper != nullptr),
+      upper_inclusive_(upper_inclusive),
+      prefetch_size_(prefetch_size),
+      resume_(std::move(resume)) {
+  if (has_upper_) {
+    upper_ = *upper;
+  }
+  SkipExhaustedLeaves();
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &INDEXITERATOR_TYPE::operator*() { throw std::runtime_error("unimplemented"); }
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index,
+                                  std::function<Page *(const KeyType &, int *)> resume_before)
+    : buffer_pool_manager_(buffer_pool_manager),
+      page_(page),
+      leaf_(reinterpret_cast<LeafPage *>(page->GetData())),
+      page_id_(page->GetPageId()),
+      index_(index),
+      reverse_(true),
+      resume_(std::move(resume_before)) {
+  SkipExhaustedLeaves();
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() { throw std::runtime_error("unimplemented"); }
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept { *this = std::move(other); }
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    Release();
+    ReleasePrefetched();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    leaf_ = other.leaf_;
+    page_id_ = other.page_id_;
+    index_ = other.index_;
+    comparator_ = other.comparator_;
+    has_upper_ = other.has_upper_;
+    upper_inclusive_ = other.upper_inclusive_;
+    upper_ = other.upper_;
+    prefetch_size_ = other.prefetch_size_;
+    prefetched_ = std::move(other.prefetched_);
+    other.prefetched_.clear();
+    reverse_ = other.reverse_;
+    resume_ = std::move(other.resume_);
+    other.page_ = nullptr;
+    other.leaf_ = nullptr;
+    other.page_id_ = INVALID_PAGE_ID;
+    other.index_ = 0;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() {
+  Release();
+  ReleasePrefetched();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::IsEnd() { return page_ == nullptr; }
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType &INDEXITERATOR_TYPE::operator*() {
+  assert(!IsEnd());
+  item_ = leaf_->GetItem(index_);
+  return item_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
+  assert(!IsEnd());
+  if (reverse_) {
+    index_--;
+  } else {
+    index_++;
+  }
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (page_ != nullptr && (index_ < 0 || index_ >= leaf_->GetSize())) {
+    if (reverse_) {
+      // latching the previous leaf while this one is held could deadlock with forward scans, so the tree is searched
+      // again for the keys before the first one of this leaf
+      KeyType first_key = leaf_->KeyAt(0);
+      Release();
+      index_ = 0;
+      page_ = resume_(first_key, &index_);
+      if (page_ != nullptr) {
+        leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+        page_id_ = page_->GetPageId();
+      }
+      continue;
+    }
+    page_id_t next_page_id = leaf_->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      Release();
+      index_ = 0;
+      break;
+    }
+    // the next leaf is latched before the current one is released, which must not wait: a coalesce latches its left
+    // sibling while it holds the right one
+    Page *next_page = TakeNextPage(next_page_id);
+    if (next_page != nullptr && next_page->TryRLatch()) {
+      Release();
+      page_ = next_page;
+      leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+      page_id_ = next_page_id;
+      index_ = 0;
+      continue;
+    }
+
+    if (!resume_ || leaf_->GetSize() == 0) {
+      // wait for the next leaf with no latch held, keys that move between the two leaves meanwhile are missed
+      Release();
+      index_ = 0;
+      if (next_page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf of a scan");
+      }
+      next_page->RLatch();
+      page_ = next_page;
+      leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+      page_id_ = next_page_id;
+      continue;
+    }
+    // the leaves are being changed, search the tree again for the keys after the last one of this leaf
+    KeyType last_key = leaf_->KeyAt(leaf_->GetSize() - 1);
+    if (next_page != nullptr) {
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+    }
+    ReleasePrefetched();
+    Release();
+    index_ = 0;
+    page_ = resume_(last_key, &index_);
+    if (page_ != nullptr) {
+      leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+      page_id_ = page_->GetPageId();
+    }
+  }
+  if (page_ != nullptr && has_upper_) {
+    int cmp = (*comparator_)(leaf_->KeyAt(index_), upper_);
+    if (cmp > 0 || (cmp == 0 && !upper_inclusive_)) {
+      Release();
+      index_ = 0;
+    }
+  }
+  if (page_ == nullptr) {
+    ReleasePrefetched();
+  } else {
+    Prefetch();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *INDEXITERATOR_TYPE::TakeNextPage(page_id_t next_page_id) {
+  if (!prefetched_.empty() && prefetched_.front()->GetPageId() == next_page_id) {
+    Page *page = prefetched_.front();
+    prefetched_.pop_front();
+    return page;
+  }
+  // the leaves were split or merged since they were prefetched
+  ReleasePrefetched();
+  return buffer_pool_manager_->FetchPage(next_page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Prefetch() {
+  while (static_cast<int>(prefetched_.size()) < prefetch_size_) {
+    // the current leaf is latched already, the ones ahead of it only if no writer holds them
+    Page *last = prefetched_.empty() ? page_ : prefetched_.back();
+    if (last != page_ && !last->TryRLatch()) {
+      return;
+    }
+    auto *last_leaf = reinterpret_cast<LeafPage *>(last->GetData());
+    page_id_t next_page_id = last_leaf->GetNextPageId();
+    // the leaves after one that reaches the upper bound lie past the range
+    bool past_upper = has_upper_ && last_leaf->GetSize() > 0 &&
+                      (*comparator_)(last_leaf->KeyAt(last_leaf->GetSize() - 1), upper_) >= 0;
+    if (last != page_) {
+      last->RUnlatch();
+    }
+    if (next_page_id == INVALID_PAGE_ID || past_upper) {
+      return;
+    }
+    Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_page == nullptr) {
+      // out of frames, the scan goes on without prefetching
+      return;
+    }
+    prefetched_.push_back(next_page);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id_, false);
+    page_ = nullptr;
+    leaf_ = nullptr;
+    page_id_ = INVALID_PAGE_ID;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReleasePrefetched() {
+  for (Page *page : prefetched_) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+  prefetched_.clear();
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -36,4 +261,6 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<GenericKey<128>, RID, GenericComparator<128>>;
+
 }  // namespace bustub
@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.cpp
+//
+// Identification: src/storage/index/key_search.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/key_search.h"
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+int CountIntegersBelow(const int64_t *keys, int n, int64_t key, bool inclusive) {
+  // a key is counted unless it is greater than key, resp. not less than key
+  int counted = 0;
+  int i = 0;
+#if defined(__AVX2__)
+  const __m256i needle = _mm256_set1_epi64x(key);
+  for (; i + 4 <= n; i += 4) {
+    __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+    __m256i below = inclusive ? _mm256_cmpgt_epi64(lanes, needle) : _mm256_cmpgt_epi64(needle, lanes);
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(below));
+    counted += inclusive ? 4 - __builtin_popcount(mask) : __builtin_popcount(mask);
+  }
+#elif defined(__SSE4_2__)
+  const __m128i needle = _mm_set1_epi64x(key);
+  for (; i + 2 <= n; i += 2) {
+    __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+    __m128i below = inclusive ? _mm_cmpgt_epi64(lanes, needle) : _mm_cmpgt_epi64(needle, lanes);
+    int mask = _mm_movemask_pd(_mm_castsi128_pd(below));
+    counted += inclusive ? 2 - __builtin_popcount(mask) : __builtin_popcount(mask);
+  }
+#endif
+  for (; i < n; i++) {
+    counted += static_cast<int>(inclusive ? keys[i] <= key : keys[i] < key);
+  }
+  return counted;
+}
+
+}  // namespace bustub
@@ -9,10 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
 #include "common/exception.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -25,28 +28,39 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
-  this->page_id_=page_id;
-  this->parent_page_id_=parent_id;
-  this->max_size_=max_size;
-  this->page_type_=IndexPageType::INTERNAL_PAGE;
-  this->size_=0;
-  this->next_page_id_=INVALID_PAGE_ID;
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, int tail_size) {
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  size_limit_ = max_size;
+  tail_size_ = tail_size;
+  heap_offset_ = Room();
+  UpdateMaxSize();
 }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
- * array offset)
+ * array offset). The bytes past the ones of the cell are zero.
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  //KeyType key{};
-  return this->array_[index].first;
+  KeyType key;
+  auto *data = reinterpret_cast<char *>(&key);
+  const int key_bytes = CellEnd(index) - offsets_[index] - sizeof(ValueType);
+  memcpy(data, Heap() + offsets_[index], key_bytes);
+  memset(data + key_bytes, 0, sizeof(KeyType) - key_bytes);
+  return key;
 }
 
+/*
+ * The cell is rewritten for the new key, which must fit in the page
+ */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
-  this->array_[index].first=key
+  ValueType value = ValueAt(index);
+  RemoveAt(index);
+  InsertAt(index, key, value);
+  UpdateMaxSize();
 }
 
 /*
@@ -54,22 +68,188 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
  * equals to input "value"
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const { 
-  for(int i=0;i<GetSize();i++){
-    if(this->array_[i].second==value){
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  for (int i = 0; i < GetSize(); i++) {
+    if (ValueAt(i) == value) {
       return i;
     }
   }
   return -1;
- }
+}
 
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { 
-  return this->array_[index].second; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
+  ValueType value;
+  memcpy(&value, Heap() + CellEnd(index) - sizeof(ValueType), sizeof(ValueType));
+  return value;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  memcpy(Heap() + CellEnd(index) - sizeof(ValueType), &value, sizeof(ValueType));
+}
+
+/*
+ * The shortest key above lower and not above upper: the bytes of upper up to
+ * the first one that differs from lower, which is above the one of lower, the
+ * others zero
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ShortestSeparator(const KeyType &lower, const KeyType &upper) {
+  KeyType separator = upper;
+  const auto *lhs = reinterpret_cast<const char *>(&lower);
+  auto *data = reinterpret_cast<char *>(&separator);
+  size_t length = 0;
+  while (length < sizeof(KeyType) && lhs[length] == data[length]) {
+    length++;
+  }
+  if (length < sizeof(KeyType)) {
+    memset(data + length + 1, 0, sizeof(KeyType) - length - 1);
+  }
+  return separator;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::Heap() {
+  return reinterpret_cast<char *>(offsets_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::Heap() const {
+  return reinterpret_cast<const char *>(offsets_);
+}
+
+/*
+ * End of the cell at index, which is where the cell of the previous entry starts
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::CellEnd(int index) const {
+  return index == 0 ? Room() : offsets_[index - 1];
+}
+
+/*
+ * Encode key & value pair into a new cell at index, moving the cells of the
+ * entries after it down
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  const int cell_size = CellSize(key);
+  BUSTUB_ASSERT(UsedBytes() + static_cast<int>(sizeof(uint16_t)) + cell_size <= Room(), "the entry must fit in the page");
+  const int end = CellEnd(index);
+  char *heap = Heap();
+  memmove(heap + heap_offset_ - cell_size, heap + heap_offset_, end - heap_offset_);
+  for (int i = index; i < GetSize(); i++) {
+    offsets_[i] -= cell_size;
+  }
+  memmove(offsets_ + index + 1, offsets_ + index, (GetSize() - index) * sizeof(uint16_t));
+  offsets_[index] = end - cell_size;
+  memcpy(heap + offsets_[index], &key, cell_size - sizeof(ValueType));
+  memcpy(heap + end - sizeof(ValueType), &value, sizeof(ValueType));
+  heap_offset_ -= cell_size;
+  IncreaseSize(1);
+}
+
+/*
+ * Drop the count entries from index on, moving the cells of the entries after
+ * them up
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAt(int index, int count) {
+  const int begin = offsets_[index + count - 1];
+  const int cell_size = CellEnd(index) - begin;
+  char *heap = Heap();
+  memmove(heap + heap_offset_ + cell_size, heap + heap_offset_, begin - heap_offset_);
+  for (int i = index + count; i < GetSize(); i++) {
+    offsets_[i] += cell_size;
+  }
+  memmove(offsets_ + index, offsets_ + index + count, (GetSize() - index - count) * sizeof(uint16_t));
+  heap_offset_ += cell_size;
+  IncreaseSize(-count);
+}
+
+/*****************************************************************************
+ * SIZE
+ *****************************************************************************/
+/*
+ * Bytes of the page left to the offsets and cells
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::Room() const {
+  return PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - tail_size_;
+}
+
+/*
+ * Size of the cell of key: its bytes up to the last non-zero one, and the value
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::CellSize(const KeyType &key) const {
+  const auto *data = reinterpret_cast<const char *>(&key);
+  int key_size = sizeof(KeyType);
+  while (key_size > 0 && data[key_size - 1] == 0) {
+    key_size--;
+  }
+  return key_size + sizeof(ValueType);
+}
+
+/*
+ * Bytes the offsets and cells of the page take
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::UsedBytes() const {
+  return GetSize() * sizeof(uint16_t) + Room() - heap_offset_;
+}
+
+/*
+ * Max size of a page of size entries that take used_bytes: the size limit of
+ * the tree, as far as further entries of full keys fit, keeping the room of
+ * one of them. It is below size when the entries leave no such room.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::MaxSizeOf(int size, int used_bytes) const {
+  if (used_bytes > Room()) {
+    return size - 1;
+  }
+  const int widest = sizeof(uint16_t) + sizeof(KeyType) + sizeof(ValueType);
+  return std::min(size_limit_, size + (Room() - used_bytes) / widest - 1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::UpdateMaxSize() {
+  SetMaxSize(MaxSizeOf(GetSize(), UsedBytes()));
+}
+
+/*
+ * Max size of the page once it also holds key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::MaxSizeFor(const KeyType &key) const {
+  return MaxSizeOf(GetSize() + 1, UsedBytes() + sizeof(uint16_t) + CellSize(key));
+}
+
+/*
+ * Max size of the page once key replaces the key at index
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::MaxSizeWithKeyAt(int index, const KeyType &key) const {
+  return MaxSizeOf(GetSize(), UsedBytes() - (CellEnd(index) - offsets_[index]) + CellSize(key));
+}
+
+/*
+ * Max size of the page once it also holds the entries of other, the first one
+ * with middle_key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::MaxSizeWith(const BPlusTreeInternalPage &other, const KeyType &middle_key) const {
+  if (other.GetSize() == 0) {
+    return GetMaxSize();
+  }
+  const int other_bytes = other.UsedBytes() - (other.CellEnd(0) - other.offsets_[0]) + CellSize(middle_key);
+  return MaxSizeOf(GetSize() + other.GetSize(), UsedBytes() + other_bytes);
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -81,17 +261,31 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  int l=1,r=GetSize()-1;
-  //应该找到最后一个相等的
-  while(l<r){
-    int mid=(l+r+1)>>1;
-    if(comparator(this->array_[mid].first,key)<=0){
-      l=mid;
-    }else{
-      r=mid-1;
-    }
-  }
-  return this->array_[l].second;
+  return ValueAt(LookupIndex(key, comparator));
+}
+
+/*
+ * Find the index of the child pointer which points to the page that contains
+ * input "key"
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndex(const KeyType &key, const KeyComparator &comparator) const {
+  // find the last index whose key is <= key, treating the invalid key(0) as -inf
+  int index = KeySearch<KeyType, KeyComparator>::UpperBound(
+      key, 1, GetSize(), [this](int i) { return KeyAt(i); }, comparator);
+  return index - 1;
+}
+
+/*
+ * Find the index of the child pointer which points to the page that contains
+ * the keys right before input "key", that is the greatest ones below it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndexBefore(const KeyType &key, const KeyComparator &comparator) const {
+  // find the last index whose key is < key, treating the invalid key(0) as -inf
+  int index = KeySearch<KeyType, KeyComparator>::LowerBound(
+      key, 1, GetSize(), [this](int i) { return KeyAt(i); }, comparator);
+  return index - 1;
 }
 
 /*****************************************************************************
@@ -105,79 +299,86 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
-   const ValueType &new_value) {
-     this->array_[0].second=old_value;
-     this->array_[1]=MappingType(new_key,new_value);
-     SetSize(2);
-  }
+                                                     const ValueType &new_value) {
+  InsertAt(0, KeyType(), old_value);
+  InsertAt(1, new_key, new_value);
+  UpdateMaxSize();
+}
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
- * old_value
+ * old_value. The page must be within max size, it may exceed it afterwards.
  * @return:  new size after insertion
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
-  const ValueType &new_value) {
-  int index=ValueIndex(old_value);
-  for(int i=this->GetSize()-1;i>index;i--){
-    this->array_[i+1]=this->array_[i];
-  }
-  this->array_[++index]=MappingType(new_key,new_value);
-  this->IncreaseSize(1);
-  return this->GetSize();
+                                                    const ValueType &new_value) {
+  InsertAt(ValueIndex(old_value) + 1, new_key, new_value);
+  UpdateMaxSize();
+  return GetSize();
 }
 
 /*****************************************************************************
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Remove half of key & value pairs from this page to "recipient" page. The
+ * halves take about as many bytes each, or as many entries when the page is
+ * over the size limit.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
-   BufferPoolManager *buffer_pool_manager) {
-     int index=this->GetMinSize();
-     int move_num=this->GetSize()-index;
-     
-       //recipient->array_[recipient->size_++]=this->array_[i];
-     recipient->CopyNFrom(array_+index,move_num,buffer_pool_manager);
-     this->SetSize(index);
-     //recipient->array_[0].second=this->array_[index-1].second;
-
+                                                BufferPoolManager *buffer_pool_manager) {
+  const int half = UsedBytes() / 2;
+  int keep = 1;
+  while (keep + 1 < GetSize() && static_cast<int>((keep + 1) * sizeof(uint16_t)) + Room() - offsets_[keep] <= half) {
+    keep++;
+  }
+  // a page held back by the size limit rather than by its bytes splits by entries, so both halves keep the min size
+  if (GetSize() > size_limit_) {
+    keep = std::clamp(keep, GetSize() / 2, GetSize() - GetSize() / 2);
   }
+  for (int i = keep; i < GetSize(); i++) {
+    recipient->CopyLastFrom(MappingType(KeyAt(i), ValueAt(i)), buffer_pool_manager);
+  }
+  RemoveAt(keep, GetSize() - keep);
+  UpdateMaxSize();
+}
 
 /* Copy entries into me, starting from {items} and copy {size} entries.
  * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
-  for(int i=0;i<size;i++){
-    this->array_[i+GetSize()]=items[i];
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(const MappingType *items, int size,
+                                               BufferPoolManager *buffer_pool_manager) {
+  for (int i = 0; i < size; i++) {
+    CopyLastFrom(items[i], buffer_pool_manager);
   }
-  for(int i=0;i<size;i++){
-    Page*page=buffer_pool_manager->FetchPage(ValueAt(i+GetSize()));
-    BPlusTreeInternalPage*new_page=reinterpret_cast<BPlusTreeInternalPage*>(page->GetData());
-    new_page->SetParentPageId(GetPageId());
-    buffer_pool_manager->UnpinPage(new_page->GetPageId(),true);
-  }
-  IncreaseSize(size);
+}
+
+/*
+ * Make the child page of value point to me
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Adopt(const ValueType &value, BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(value);
+  auto *child = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  child->SetParentPageId(GetPageId());
+  buffer_pool_manager->UnpinPage(page->GetPageId(), true);
 }
 
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
 /*
- * Remove the key & value pair in internal page according to input index(a.k.a
- * array offset)
+ * Remove the count key & value pairs in internal page from input index(a.k.a
+ * array offset) on
  * NOTE: store key&value pair continuously after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
-  for(int i=index;i<GetSize()-1;i++){
-    this->array_[i]=this->array_[i+1];
-  }
-  IncreaseSize(-1);
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index, int count) {
+  RemoveAt(index, count);
+  UpdateMaxSize();
 }
 
 /*
@@ -185,9 +386,11 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
  * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() { 
-  SetSize(0);
-  return ValueAt(0); }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
+  ValueType value = ValueAt(0);
+  Remove(0);
+  return value;
+}
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
@@ -200,11 +403,13 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-  BufferPoolManager *buffer_pool_manager) {
-    SetKeyAt(0,middle_key);
-    recipient->CopyNFrom(this->array_,buffer_pool_manager);
-    SetSize(0);
+                                               BufferPoolManager *buffer_pool_manager) {
+  recipient->CopyLastFrom(MappingType(middle_key, ValueAt(0)), buffer_pool_manager);
+  for (int i = 1; i < GetSize(); i++) {
+    recipient->CopyLastFrom(MappingType(KeyAt(i), ValueAt(i)), buffer_pool_manager);
   }
+  Remove(0, GetSize());
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -219,15 +424,10 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-  BufferPoolManager *buffer_pool_manager) {
-    this->SetKeyAt(0,middle_key);
-    recipient->CopyNFrom(array_,1,buffer_pool_manager);
-    // for(int i=0;i<GetSize()-1;i++){
-    //   this->array_[i]=this->array_[i+1];
-    // }
-    Remove(0);
-    //IncreaseSize(-1);
-  }
+                                                      BufferPoolManager *buffer_pool_manager) {
+  recipient->CopyLastFrom(MappingType(middle_key, ValueAt(0)), buffer_pool_manager);
+  Remove(0);
+}
 
 /* Append an entry at the end.
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
@@ -235,12 +435,9 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *rec
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  this->array_[GetSize()]=pair;
-  Page*page=buffer_pool_manager->FetchPage(ValueAt(GetSize()),nullptr);
-  BPlusTreeInternalPage*new_page=reinterpret_cast<BPlusTreeInternalPage*>(page->GetData());
-  new_page->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(page->GetPageId(),true);
-  IncreaseSize(1);
+  InsertAt(GetSize(), pair.first, pair.second);
+  UpdateMaxSize();
+  Adopt(pair.second, buffer_pool_manager);
 }
 
 /*
@@ -252,11 +449,11 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-  BufferPoolManager *buffer_pool_manager) {
-    recipient->SetKeyAt(0,middle_key);
-    recipient->CopyFirstFrom(this->array_[GetSize()-1],buffer_pool_manager);
-    IncreaseSize(-1);
-  }
+                                                       BufferPoolManager *buffer_pool_manager) {
+  recipient->SetKeyAt(0, middle_key);
+  recipient->CopyFirstFrom(MappingType(KeyAt(GetSize() - 1), ValueAt(GetSize() - 1)), buffer_pool_manager);
+  Remove(GetSize() - 1);
+}
 
 /* Append an entry at the beginning.
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
@@ -264,15 +461,9 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *re
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  for(int i=GetSize();i>0;i--){
-    this->array_[i]=this->array_[i-1];
-  }
-  this->array_[0]=pair;
-  Page*page=buffer_pool_manager->FetchPage(ValueAt(0),nullptr);
-  BPlusTreeInternalPage*new_page=reinterpret_cast<BPlusTreeInternalPage*>(page->GetData());
-  new_page->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(page->GetPageId(),true);
-  IncreaseSize(1);
+  InsertAt(0, pair.first, pair.second);
+  UpdateMaxSize();
+  Adopt(pair.second, buffer_pool_manager);
 }
 
 // valuetype for internalNode should be page id_t
@@ -281,4 +472,5 @@ template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeInternalPage<GenericKey<128>, page_id_t, GenericComparator<128>>;
 }  // namespace bustub
@@ -9,10 +9,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -27,52 +31,51 @@ namespace bustub {
  * next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
-  this->page_id_=IndexPageType::page_id;
-  this->parent_page_id_=parent_id;
-  this->max_size_=max_size;
-  this->page_type_=LEAF_PAGE;
-  this->size_=0;
-  this->next_page_id_=INVALID_PAGE_ID;
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, int tail_size) {
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  size_limit_ = max_size;
+  tail_size_ = tail_size;
+  prefix_size_ = sizeof(KeyType);
+  heap_offset_ = Room();
+  SetMaxSize(MaxSizeOf(0, 0));
 }
 
 /**
  * Helper methods to set/get next page id
  */
 INDEX_TEMPLATE_ARGUMENTS
-page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return this->next_page_id_; }
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
-  this->next_page_id_=next_page_id;
-}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
 /**
  * Helper method to find the first index i so that array[i].first >= key
  * NOTE: This method is only used when generating index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const { 
-  int l=0,r=GetSize()-1 ;
-  while(l<r){
-    int mid=(l+r)>>1;
-    if(comparator(this->array_[mid].first,key)<0){
-      l=mid+1;
-    }else{
-      r=mid;
-    }
-  }
-  return l; }
+int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
+  return KeySearch<KeyType, KeyComparator>::LowerBound(
+      key, 0, GetSize(), [this](int index) { return KeyAt(index); }, comparator);
+}
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
- * array offset)
+ * array offset). The shared bytes come from the shared key, the others from the
+ * cell, the bytes past them are zero.
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key{};
-  return this->array_[index].first;
+  KeyType key = shared_key_;
+  auto *data = reinterpret_cast<char *>(&key);
+  const int key_bytes = CellEnd(index) - offsets_[index] - sizeof(ValueType);
+  memcpy(data + prefix_size_, Heap() + offsets_[index], key_bytes);
+  memset(data + prefix_size_ + key_bytes, 0, sizeof(KeyType) - prefix_size_ - key_bytes);
+  return key;
 }
 
 /*
@@ -80,9 +83,225 @@ KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
-  // replace with your own code
-  return array_[index];
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const { return MappingType(KeyAt(index), ValueAt(index)); }
+
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const {
+  ValueType value;
+  memcpy(&value, Heap() + CellEnd(index) - sizeof(ValueType), sizeof(ValueType));
+  return value;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+char *B_PLUS_TREE_LEAF_PAGE_TYPE::Heap() {
+  return reinterpret_cast<char *>(offsets_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_LEAF_PAGE_TYPE::Heap() const {
+  return reinterpret_cast<const char *>(offsets_);
+}
+
+/*
+ * End of the cell at index, which is where the cell of the previous entry starts
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::CellEnd(int index) const {
+  return index == 0 ? Room() : offsets_[index - 1];
+}
+
+/*
+ * Encode key & value pair into a new cell at index with the current layout,
+ * moving the cells of the entries after it down. The key must share the bytes
+ * of the layout and fit in the page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  const int cell_size = CellSize(key, prefix_size_);
+  const int end = CellEnd(index);
+  char *heap = Heap();
+  memmove(heap + heap_offset_ - cell_size, heap + heap_offset_, end - heap_offset_);
+  for (int i = index; i < GetSize(); i++) {
+    offsets_[i] -= cell_size;
+  }
+  memmove(offsets_ + index + 1, offsets_ + index, (GetSize() - index) * sizeof(uint16_t));
+  offsets_[index] = end - cell_size;
+  memcpy(heap + offsets_[index], reinterpret_cast<const char *>(&key) + prefix_size_, cell_size - sizeof(ValueType));
+  memcpy(heap + end - sizeof(ValueType), &value, sizeof(ValueType));
+  heap_offset_ -= cell_size;
+  IncreaseSize(1);
+}
+
+/*
+ * Drop the count entries from index on, moving the cells of the entries after
+ * them up
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAt(int index, int count) {
+  const int begin = offsets_[index + count - 1];
+  const int cell_size = CellEnd(index) - begin;
+  char *heap = Heap();
+  memmove(heap + heap_offset_ + cell_size, heap + heap_offset_, begin - heap_offset_);
+  for (int i = index + count; i < GetSize(); i++) {
+    offsets_[i] += cell_size;
+  }
+  memmove(offsets_ + index, offsets_ + index + count, (GetSize() - index - count) * sizeof(uint16_t));
+  heap_offset_ += cell_size;
+  IncreaseSize(-count);
+}
+
+/*****************************************************************************
+ * LAYOUT
+ *****************************************************************************/
+/*
+ * Bytes of the page left to the offsets and cells
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::Room() const {
+  return PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(KeyType) - tail_size_;
+}
+
+/*
+ * Size of the cell of key when the page shares prefix_size leading bytes: the
+ * key bytes past the prefix, up to the last non-zero one, and the value
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::CellSize(const KeyType &key, int prefix_size) const {
+  const auto *data = reinterpret_cast<const char *>(&key);
+  int key_size = sizeof(KeyType);
+  while (key_size > prefix_size && data[key_size - 1] == 0) {
+    key_size--;
+  }
+  return std::max(0, key_size - prefix_size) + sizeof(ValueType);
+}
+
+/*
+ * Bytes the offsets and cells of the page take with prefix_size shared bytes,
+ * which must be at most the current ones
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::UsedBytes(int prefix_size) const {
+  if (prefix_size == prefix_size_) {
+    return GetSize() * sizeof(uint16_t) + Room() - heap_offset_;
+  }
+  int used_bytes = 0;
+  for (int i = 0; i < GetSize(); i++) {
+    used_bytes += sizeof(uint16_t) + CellSize(KeyAt(i), prefix_size);
+  }
+  return used_bytes;
+}
+
+/*
+ * Max size of a page of size entries that take used_bytes: the size limit of
+ * the tree, as far as further keys that share no bytes fit. It is below size
+ * when the entries do not fit.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::MaxSizeOf(int size, int used_bytes) const {
+  if (used_bytes > Room()) {
+    return size - 1;
+  }
+  const int widest = sizeof(uint16_t) + sizeof(KeyType) + sizeof(ValueType);
+  return std::min(size_limit_, size + (Room() - used_bytes) / widest);
+}
+
+/*
+ * Number of the first prefix_size bytes of the shared key that key shares
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::NarrowPrefix(const KeyType &key, int prefix_size) const {
+  const auto *lhs = reinterpret_cast<const char *>(&shared_key_);
+  const auto *rhs = reinterpret_cast<const char *>(&key);
+  int prefix = 0;
+  while (prefix < prefix_size && lhs[prefix] == rhs[prefix]) {
+    prefix++;
+  }
+  return prefix;
+}
+
+/*
+ * Rewrite the cells for a new layout and shared key, which every entry must share
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Relayout(int prefix_size, const KeyType &shared_key) {
+  std::vector<MappingType> items;
+  items.reserve(GetSize());
+  for (int i = 0; i < GetSize(); i++) {
+    items.emplace_back(GetItem(i));
+  }
+  prefix_size_ = prefix_size;
+  shared_key_ = shared_key;
+  heap_offset_ = Room();
+  SetSize(0);
+  for (const auto &item : items) {
+    InsertAt(GetSize(), item.first, item.second);
+  }
+  SetMaxSize(MaxSizeOf(GetSize(), UsedBytes(prefix_size_)));
+}
+
+/*
+ * Make the layout take key, which an empty page adopts as its shared key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Widen(const KeyType &key) {
+  if (GetSize() == 0) {
+    Relayout(sizeof(KeyType), key);
+    return;
+  }
+  int prefix_size = NarrowPrefix(key, prefix_size_);
+  if (prefix_size != prefix_size_) {
+    Relayout(prefix_size, shared_key_);
+  }
+}
+
+/*
+ * Recompute the layout from the entries left, after some of them went away
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Tighten() {
+  if (GetSize() == 0) {
+    heap_offset_ = Room();
+    SetMaxSize(MaxSizeOf(0, 0));
+    return;
+  }
+  // the keys are sorted, so the first and the last one share the fewest bytes
+  KeyType first = KeyAt(0);
+  KeyType last = KeyAt(GetSize() - 1);
+  const auto *lhs = reinterpret_cast<const char *>(&first);
+  const auto *rhs = reinterpret_cast<const char *>(&last);
+  int prefix_size = 0;
+  while (prefix_size < static_cast<int>(sizeof(KeyType)) && lhs[prefix_size] == rhs[prefix_size]) {
+    prefix_size++;
+  }
+  Relayout(prefix_size, first);
+}
+
+/*
+ * Max size of the page once it also holds key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::MaxSizeFor(const KeyType &key) const {
+  if (GetSize() == 0) {
+    return MaxSizeOf(1, sizeof(uint16_t) + CellSize(key, sizeof(KeyType)));
+  }
+  int prefix_size = NarrowPrefix(key, prefix_size_);
+  return MaxSizeOf(GetSize() + 1, UsedBytes(prefix_size) + sizeof(uint16_t) + CellSize(key, prefix_size));
+}
+
+/*
+ * Max size of the page once it also holds the entries of other
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::MaxSizeWith(const BPlusTreeLeafPage &other) const {
+  if (other.GetSize() == 0) {
+    return GetMaxSize();
+  }
+  if (GetSize() == 0) {
+    return MaxSizeOf(other.GetSize(), other.UsedBytes(other.prefix_size_));
+  }
+  // the keys of other share the bytes of its layout with its shared key
+  int prefix_size = NarrowPrefix(other.shared_key_, std::min(prefix_size_, other.prefix_size_));
+  return MaxSizeOf(GetSize() + other.GetSize(), UsedBytes(prefix_size) + other.UsedBytes(prefix_size));
 }
 
 /*****************************************************************************
@@ -94,15 +313,14 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-  int index=KeyIndex(key,comparator);
-  if(comparator(KeyAt(index),key)==0){
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) {
     return GetSize();
   }
-  for(int i=GetSize()-1;i>=index;i--){
-    this->array_[i+1]=this->array_[i];
-  }
-  this->array_[index]=MappingType(key,value);
-  IncreaseSize(1);
+  BUSTUB_ASSERT(GetSize() < MaxSizeFor(key), "the key must fit in the leaf");
+  Widen(key);
+  InsertAt(index, key, value);
+  SetMaxSize(MaxSizeOf(GetSize(), UsedBytes(prefix_size_)));
   return GetSize();
 }
 
@@ -110,32 +328,37 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &valu
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Remove half of key & value pairs from this page to "recipient" page. The
+ * halves take about as many bytes each, or as many entries when the page is
+ * full by the size limit.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
-  int min_size=GetMinSize();
-  int remove_size=GetSize()-min_size;
-  // for(int i=min_size;i<GetSize();i++){
-  //   recipient->array_[i-min_size]=this->array_[i];
-  // }
-  recipient->CopyNFrom(array_+min_size,remove_size);
-  //this->SetSize(min_size);
-  //recipient->SetSize(remove_size);
-  // recipient->SetNextPageId(this->GetNextPageId());
-  // this->SetNextPageId(recipient->GetPageId());
-  IncreaseSize(-remove_size);
+  const int half = UsedBytes(prefix_size_) / 2;
+  int keep = 1;
+  while (keep + 1 < GetSize() && static_cast<int>((keep + 1) * sizeof(uint16_t)) + Room() - offsets_[keep] <= half) {
+    keep++;
+  }
+  // a page held back by the size limit rather than by its bytes splits by entries, so both halves keep the min size
+  if (GetSize() >= size_limit_) {
+    keep = std::clamp(keep, GetSize() / 2, GetSize() - GetSize() / 2);
+  }
+  for (int i = keep; i < GetSize(); i++) {
+    recipient->CopyLastFrom(GetItem(i));
+  }
+  SetSize(keep);
+  heap_offset_ = offsets_[keep - 1];
+  Tighten();
 }
 
 /*
  * Copy starting from items, and copy {size} number of elements into me.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
-  for(int i=0;i<size;i++){
-    this->array_[i+GetSize()]=items[i];
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const MappingType *items, int size) {
+  for (int i = 0; i < size; i++) {
+    CopyLastFrom(items[i]);
   }
-  IncreaseSize(size);
 }
 
 /*****************************************************************************
@@ -148,9 +371,11 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
-  int index=this->KeyIndex(key,comparator);
-  if(comparator(KeyAt(index),key)==0){
-    *value=this->array_[index].second;
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) {
+    if (value != nullptr) {
+      *value = ValueAt(index);
+    }
     return true;
   }
   return false;
@@ -162,20 +387,37 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
 /*
  * First look through leaf page to see whether delete key exist or not. If
  * exist, perform deletion, otherwise return immediately.
- * NOTE: store key&value pair continuously after deletion
+ * NOTE: store key&value pair continuously after deletion. The layout is kept,
+ * so that the max size does not grow past the one before.
  * @return   page size after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) { 
-  int index=this->KeyIndex(key,comparator);
-  if(index<GetSize()&&comparator(KeyAt(index),key)==0){
-    //deletion
-    for(int i=index;i<GetSize()-1;i++){
-      this->array_[i]=this->array_[i+1];
-    }
-    IncreaseSize(-1);
+int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) {
+    RemoveAt(index);
+    SetMaxSize(MaxSizeOf(GetSize(), UsedBytes(prefix_size_)));
+  }
+  return GetSize();
+}
+
+/*
+ * Remove the entries whose keys lie from lower, included, to upper, excluded,
+ * either null when unbounded. The layout is kept, as with a single removal.
+ * @return   number of entries removed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveRange(const KeyType *lower, const KeyType *upper,
+                                            const KeyComparator &comparator) {
+  int begin = lower == nullptr ? 0 : KeyIndex(*lower, comparator);
+  int end = upper == nullptr ? GetSize() : KeyIndex(*upper, comparator);
+  if (begin >= end) {
+    return 0;
   }
-  return GetSize(); }
+  RemoveAt(begin, end - begin);
+  SetMaxSize(MaxSizeOf(GetSize(), UsedBytes(prefix_size_)));
+  return end - begin;
+}
 
 /*****************************************************************************
  * MERGE
@@ -186,13 +428,12 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
-  // for(int i=0;i<GetSize();i++){
-  //   recipient->array_[i]=this->array_[i];
-  // }
-  // recipient->SetSize(this->size_);
-  recipient->CopyNFrom(this->array_,GetSize());
+  for (int i = 0; i < GetSize(); i++) {
+    recipient->CopyLastFrom(GetItem(i));
+  }
+  recipient->SetNextPageId(GetNextPageId());
   SetSize(0);
-  //recipient->next_page_id_=this->next_page_id_;
+  Tighten();
 }
 
 /*****************************************************************************
@@ -203,11 +444,9 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
-  recipient->CopyNFrom(this->array_,1);
-  IncreaseSize(-1);
-  for(int i=0;i<GetSize();i++){
-    this->array_[i]=this->array_[i+1];
-  }
+  recipient->CopyLastFrom(GetItem(0));
+  RemoveAt(0);
+  SetMaxSize(MaxSizeOf(GetSize(), UsedBytes(prefix_size_)));
 }
 
 /*
@@ -215,9 +454,10 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
-  //int index=GetSize()-1;
-  this->array_[GetSize()]=item;
-  IncreaseSize(1);
+  BUSTUB_ASSERT(GetSize() < MaxSizeFor(item.first), "the key must fit in the leaf");
+  Widen(item.first);
+  InsertAt(GetSize(), item.first, item.second);
+  SetMaxSize(MaxSizeOf(GetSize(), UsedBytes(prefix_size_)));
 }
 
 /*
@@ -225,9 +465,9 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
-  int index=GetSize()-1;
-  recipient_->CopyFirstFrom(array_[GetSize() - 1]);
-  IncreaseSize(-1);
+  recipient->CopyFirstFrom(GetItem(GetSize() - 1));
+  RemoveAt(GetSize() - 1);
+  SetMaxSize(MaxSizeOf(GetSize(), UsedBytes(prefix_size_)));
 }
 
 /*
@@ -235,12 +475,10 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
-  int index=GetSize();
-  for(int i=index;i;i--){
-    this->array_[i]=this->array_[i-1];
-  }
-  this->array_[0]=item;
-  IncreaseSize(1);
+  BUSTUB_ASSERT(GetSize() < MaxSizeFor(item.first), "the key must fit in the leaf");
+  Widen(item.first);
+  InsertAt(0, item.first, item.second);
+  SetMaxSize(MaxSizeOf(GetSize(), UsedBytes(prefix_size_)));
 }
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
@@ -248,4 +486,5 @@ template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeLeafPage<GenericKey<128>, RID, GenericComparator<128>>;
 }  // namespace bustub
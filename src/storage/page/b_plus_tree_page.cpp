@@ -40,8 +40,7 @@ void BPlusTreePage::IncreaseSize(int amount) {
 /*
  * Helper methods to get/set max size (capacity) of the page
  */
-int BPlusTreePage::GetMaxSize() const { 
-    return max_size_-1; }
+int BPlusTreePage::GetMaxSize() const { return max_size_; }
 void BPlusTreePage::SetMaxSize(int size) {
     max_size_=size;
 }
@@ -50,7 +49,10 @@ void BPlusTreePage::SetMaxSize(int size) {
  * Helper method to get min page size
  * Generally, min page size == max page size / 2
  */
-int BPlusTreePage::GetMinSize() const { return max_size_/2; }
+int BPlusTreePage::GetMinSize() const {
+  // a leaf splits once it reaches max_size, an internal page once it exceeds it
+  return IsLeafPage() ? max_size_ / 2 : (max_size_ + 1) / 2;
+}
 
 /*
  * Helper methods to get/set parent page id
@@ -34,11 +34,16 @@ void HashTableDirectoryPage::IncrGlobalDepth() {
   for(int i=0;i<(int)origin_depth;i++){
     bucket_page_ids_[i+origin_depth]=bucket_page_ids_[i];
     local_depths_[i+origin_depth]=local_depths_[i];
+    SetChildDirectory(i + origin_depth, IsChildDirectory(i));
   }
   global_depth_++;
 }
 uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx){
-  return bucket_idx^(1<<local_depths_[bucket_idx]);
+  // the image differs in the highest bit of the local depth, a bucket of local depth 0 has none
+  if (local_depths_[bucket_idx] == 0) {
+    return bucket_idx;
+  }
+  return bucket_idx ^ (1U << (local_depths_[bucket_idx] - 1));
 }
 void HashTableDirectoryPage::DecrGlobalDepth() { global_depth_--; }
 
@@ -50,14 +55,34 @@ void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t buck
   bucket_page_ids_[bucket_idx]=bucket_page_id;
 }
 
+bool HashTableDirectoryPage::IsChildDirectory(uint32_t bucket_idx) {
+  return (child_directories_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
+}
+
+void HashTableDirectoryPage::SetChildDirectory(uint32_t bucket_idx, bool is_child_directory) {
+  if (is_child_directory) {
+    child_directories_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+  } else {
+    child_directories_[bucket_idx / 8] &= static_cast<char>(~(1 << (bucket_idx % 8)));
+  }
+}
+
+uint32_t HashTableDirectoryPage::GetParentDepth() { return parent_depth_; }
+
+void HashTableDirectoryPage::SetParentDepth(uint32_t parent_depth) { parent_depth_ = parent_depth; }
+
 uint32_t HashTableDirectoryPage::Size() { 
   
   return 1<<global_depth_;
  }
 
 bool HashTableDirectoryPage::CanShrink() { 
-  for(int i=0;i<static_cast<int>(Size());i++){
-    if(GetGlobalDepth()>=GetLocalDepth(i)){
+  // the directory halves if no bucket needs every bit of the global depth
+  if (global_depth_ == 0) {
+    return false;
+  }
+  for (uint32_t i = 0; i < Size(); i++) {
+    if (GetLocalDepth(i) >= GetGlobalDepth()) {
       return false;
     }
   }
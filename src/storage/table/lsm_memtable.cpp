@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_memtable.cpp
+//
+// Identification: src/storage/table/lsm_memtable.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/lsm_memtable.h"
+
+namespace bustub {
+
+LsmMemTable::LsmMemTable() { head_.next_.resize(MAX_HEIGHT, nullptr); }
+
+LsmMemTable::~LsmMemTable() {
+  Node *node = head_.next_[0];
+  while (node != nullptr) {
+    Node *next = node->next_[0];
+    delete node;
+    node = next;
+  }
+}
+
+void LsmMemTable::Put(uint64_t row, LsmEntryKind kind, const Tuple &tuple) {
+  latch_.WLock();
+  Node *prev[MAX_HEIGHT];
+  Node *node = FindGreaterOrEqual(row, prev);
+  if (node != nullptr && node->entry_.row_ == row) {
+    size_ -= EntrySize(node->entry_);
+  } else {
+    // Each level holds a quarter of the nodes of the level below it
+    int height = 1;
+    while (height < MAX_HEIGHT && random_() % 4 == 0) {
+      height++;
+    }
+    for (; height_ < height; height_++) {
+      prev[height_] = &head_;
+    }
+    node = new Node;
+    node->entry_.row_ = row;
+    node->next_.resize(height);
+    for (int level = 0; level < height; level++) {
+      node->next_[level] = prev[level]->next_[level];
+      prev[level]->next_[level] = node;
+    }
+    num_entries_++;
+  }
+  node->entry_.kind_ = kind;
+  node->entry_.tuple_ = kind == LsmEntryKind::TOMBSTONE ? Tuple{} : tuple;
+  size_ += EntrySize(node->entry_);
+  latch_.WUnlock();
+}
+
+bool LsmMemTable::Get(uint64_t row, LsmEntry *entry) {
+  latch_.RLock();
+  Node *node = FindGreaterOrEqual(row, nullptr);
+  bool found = node != nullptr && node->entry_.row_ == row;
+  if (found) {
+    *entry = node->entry_;
+  }
+  latch_.RUnlock();
+  return found;
+}
+
+bool LsmMemTable::LowerBound(uint64_t row, LsmEntry *entry) {
+  latch_.RLock();
+  Node *node = FindGreaterOrEqual(row, nullptr);
+  if (node != nullptr) {
+    *entry = node->entry_;
+  }
+  latch_.RUnlock();
+  return node != nullptr;
+}
+
+void LsmMemTable::ForEach(const std::function<void(const LsmEntry &)> &visit) {
+  latch_.RLock();
+  for (Node *node = head_.next_[0]; node != nullptr; node = node->next_[0]) {
+    visit(node->entry_);
+  }
+  latch_.RUnlock();
+}
+
+LsmMemTable::Node *LsmMemTable::FindGreaterOrEqual(uint64_t row, Node **prev) {
+  Node *node = &head_;
+  for (int level = height_ - 1; level >= 0; level--) {
+    while (node->next_[level] != nullptr && node->next_[level]->entry_.row_ < row) {
+      node = node->next_[level];
+    }
+    if (prev != nullptr) {
+      prev[level] = node;
+    }
+  }
+  return node->next_[0];
+}
+
+}  // namespace bustub
@@ -0,0 +1,243 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_run.cpp
+//
+// Identification: src/storage/table/lsm_run.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/lsm_run.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * BLOOM FILTER
+ *****************************************************************************/
+LsmBloomFilter::LsmBloomFilter(size_t num_rows) {
+  size_t num_words = std::max<size_t>(1, (num_rows * BITS_PER_ROW + 63) / 64);
+  bits_.resize(num_words, 0);
+  num_bits_ = num_words * 64;
+}
+
+void LsmBloomFilter::Add(uint64_t row) {
+  auto [hash, delta] = Hash(row);
+  for (size_t i = 0; i < NUM_PROBES; i++, hash += delta) {
+    size_t bit = hash % num_bits_;
+    bits_[bit / 64] |= uint64_t{1} << (bit % 64);
+  }
+}
+
+bool LsmBloomFilter::MayContain(uint64_t row) const {
+  auto [hash, delta] = Hash(row);
+  for (size_t i = 0; i < NUM_PROBES; i++, hash += delta) {
+    size_t bit = hash % num_bits_;
+    if ((bits_[bit / 64] & (uint64_t{1} << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::pair<uint64_t, uint64_t> LsmBloomFilter::Hash(uint64_t row) {
+  // splitmix64, as rows are mostly consecutive numbers
+  uint64_t hash = row + 0x9e3779b97f4a7c15;
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+  hash ^= hash >> 31;
+  // the probes step by an odd delta, so that they do not repeat
+  return {hash, (hash >> 32) | 1};
+}
+
+/*****************************************************************************
+ * CURSOR
+ *****************************************************************************/
+void LsmRun::Cursor::Next() {
+  index_++;
+  if (index_ == entries_.size()) {
+    page_index_++;
+    Load();
+  }
+}
+
+void LsmRun::Cursor::Load() {
+  entries_.clear();
+  index_ = 0;
+  if (page_index_ == run_->pages_.size()) {
+    return;
+  }
+  page_id_t page_id = run_->pages_[page_index_].second;
+  Page *page = run_->buffer_pool_manager_->FetchPage(page_id);
+  const char *data = page->GetData();
+  uint32_t num_entries;
+  memcpy(&num_entries, data, sizeof(uint32_t));
+  entries_.resize(num_entries);
+  size_t offset = PAGE_HEADER_SIZE;
+  for (auto &entry : entries_) {
+    offset = ReadEntry(data, offset, &entry);
+  }
+  run_->buffer_pool_manager_->UnpinPage(page_id, false);
+}
+
+/*****************************************************************************
+ * WRITE
+ *****************************************************************************/
+LsmRun::LsmRun(BufferPoolManager *buffer_pool_manager, size_t max_entries)
+    : buffer_pool_manager_(buffer_pool_manager), bloom_filter_(max_entries), page_(PAGE_SIZE, 0) {}
+
+LsmRun::~LsmRun() {
+  for (const auto &[first_row, page_id] : pages_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+void LsmRun::Append(const LsmEntry &entry) {
+  uint32_t tuple_size = entry.kind_ == LsmEntryKind::TOMBSTONE ? 0 : entry.tuple_.GetLength();
+  if (page_size_ + ENTRY_HEADER_SIZE + tuple_size > PAGE_SIZE) {
+    WritePage();
+  }
+  char *data = page_.data();
+  memcpy(data + page_size_, &entry.row_, sizeof(uint64_t));
+  memcpy(data + page_size_ + sizeof(uint64_t), &entry.kind_, sizeof(uint32_t));
+  memcpy(data + page_size_ + sizeof(uint64_t) + sizeof(uint32_t), &tuple_size, sizeof(uint32_t));
+  if (tuple_size != 0) {
+    memcpy(data + page_size_ + ENTRY_HEADER_SIZE, entry.tuple_.GetData(), tuple_size);
+  }
+  page_size_ += ENTRY_HEADER_SIZE + tuple_size;
+  uint32_t page_entries;
+  memcpy(&page_entries, data, sizeof(uint32_t));
+  page_entries++;
+  memcpy(data, &page_entries, sizeof(uint32_t));
+
+  bloom_filter_.Add(entry.row_);
+  last_row_ = entry.row_;
+  num_entries_++;
+}
+
+void LsmRun::Finish() {
+  if (page_size_ != PAGE_HEADER_SIZE) {
+    WritePage();
+  }
+  page_.clear();
+  page_.shrink_to_fit();
+}
+
+void LsmRun::WritePage() {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page for a sorted run");
+  }
+  memcpy(page->GetData(), page_.data(), PAGE_SIZE);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  uint64_t first_row;
+  memcpy(&first_row, page_.data() + PAGE_HEADER_SIZE, sizeof(uint64_t));
+  pages_.emplace_back(first_row, page_id);
+  std::fill(page_.begin(), page_.end(), 0);
+  page_size_ = PAGE_HEADER_SIZE;
+}
+
+/*****************************************************************************
+ * READ
+ *****************************************************************************/
+bool LsmRun::Get(uint64_t row, LsmEntry *entry) const {
+  if (num_entries_ == 0 || row > last_row_ || !bloom_filter_.MayContain(row)) {
+    return false;
+  }
+  int page_index = PageIndex(row);
+  if (page_index < 0) {
+    return false;
+  }
+  page_id_t page_id = pages_[page_index].second;
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  const char *data = page->GetData();
+  uint32_t num_entries;
+  memcpy(&num_entries, data, sizeof(uint32_t));
+  bool found = false;
+  size_t offset = PAGE_HEADER_SIZE;
+  for (uint32_t i = 0; i < num_entries; i++) {
+    uint64_t entry_row;
+    memcpy(&entry_row, data + offset, sizeof(uint64_t));
+    if (entry_row >= row) {
+      found = entry_row == row;
+      if (found) {
+        ReadEntry(data, offset, entry);
+      }
+      break;
+    }
+    offset = NextEntry(data, offset);
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return found;
+}
+
+bool LsmRun::LowerBound(uint64_t row, LsmEntry *entry) const {
+  if (num_entries_ == 0 || row > last_row_) {
+    return false;
+  }
+  // The entry is on the page of row, or else it is the first entry of the page after it
+  auto page_index = static_cast<size_t>(std::max(PageIndex(row), 0));
+  while (true) {
+    page_id_t page_id = pages_[page_index].second;
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    const char *data = page->GetData();
+    uint32_t num_entries;
+    memcpy(&num_entries, data, sizeof(uint32_t));
+    bool found = false;
+    size_t offset = PAGE_HEADER_SIZE;
+    for (uint32_t i = 0; i < num_entries && !found; i++) {
+      uint64_t entry_row;
+      memcpy(&entry_row, data + offset, sizeof(uint64_t));
+      if (entry_row >= row) {
+        ReadEntry(data, offset, entry);
+        found = true;
+      }
+      offset = NextEntry(data, offset);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (found) {
+      return true;
+    }
+    page_index++;
+  }
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+int LsmRun::PageIndex(uint64_t row) const {
+  auto page = std::upper_bound(
+      pages_.begin(), pages_.end(), row,
+      [](uint64_t row, const std::pair<uint64_t, page_id_t> &page) { return row < page.first; });
+  return static_cast<int>(page - pages_.begin()) - 1;
+}
+
+size_t LsmRun::ReadEntry(const char *data, size_t offset, LsmEntry *entry) {
+  uint32_t tuple_size;
+  memcpy(&entry->row_, data + offset, sizeof(uint64_t));
+  memcpy(&entry->kind_, data + offset + sizeof(uint64_t), sizeof(uint32_t));
+  memcpy(&tuple_size, data + offset + sizeof(uint64_t) + sizeof(uint32_t), sizeof(uint32_t));
+  if (entry->kind_ == LsmEntryKind::TOMBSTONE) {
+    entry->tuple_ = Tuple{};
+  } else {
+    // The size and the data of the tuple are laid out as Tuple::SerializeTo writes them
+    entry->tuple_.DeserializeFrom(data + offset + sizeof(uint64_t) + sizeof(uint32_t));
+  }
+  return offset + ENTRY_HEADER_SIZE + tuple_size;
+}
+
+size_t LsmRun::NextEntry(const char *data, size_t offset) {
+  uint32_t tuple_size;
+  memcpy(&tuple_size, data + offset + sizeof(uint64_t) + sizeof(uint32_t), sizeof(uint32_t));
+  return offset + ENTRY_HEADER_SIZE + tuple_size;
+}
+
+}  // namespace bustub
@@ -0,0 +1,370 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_table.cpp
+//
+// Identification: src/storage/table/lsm_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/lsm_table.h"
+
+#include <limits>
+#include <utility>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+LsmTable::LsmTable(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
+                   size_t memtable_size, size_t level0_runs, size_t level_size_ratio)
+    : TableHeap(buffer_pool_manager, lock_manager, log_manager, INVALID_PAGE_ID),
+      memtable_size_(memtable_size),
+      level0_runs_(level0_runs),
+      level_size_ratio_(level_size_ratio),
+      memtable_(std::make_shared<LsmMemTable>()) {
+  if (buffer_pool_manager_->NewPage(&rid_page_id_) == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate the page of an LSM table");
+  }
+  buffer_pool_manager_->UnpinPage(rid_page_id_, false);
+  background_thread_ = std::thread(&LsmTable::RunBackgroundThread, this);
+}
+
+LsmTable::~LsmTable() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  background_thread_.join();
+  buffer_pool_manager_->DeletePage(rid_page_id_);
+}
+
+/*****************************************************************************
+ * WRITE
+ *****************************************************************************/
+bool LsmTable::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
+  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    if (next_row_ > std::numeric_limits<uint32_t>::max()) {
+      // no slot number left for the row
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    MakeRoom(&lock);
+    uint64_t row = next_row_++;
+    memtable_->Put(row, LsmEntryKind::VALUE, tuple);
+    *rid = RidOf(row);
+  }
+  // Update the transaction's write set.
+  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  return true;
+}
+
+bool LsmTable::MarkDelete(const RID &rid, Transaction *txn) {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    MakeRoom(&lock);
+    LsmEntry entry;
+    if (!Find(CurrentVersion(), RowOf(rid), &entry) || entry.kind_ != LsmEntryKind::VALUE) {
+      return false;
+    }
+    memtable_->Put(entry.row_, LsmEntryKind::DELETE_MARKED, entry.tuple_);
+  }
+  // Update the transaction's write set.
+  txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+  return true;
+}
+
+bool LsmTable::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) {
+  if (tuple.size_ + 32 > PAGE_SIZE) {
+    return false;
+  }
+  LsmEntry old_entry;
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    MakeRoom(&lock);
+    if (!Find(CurrentVersion(), RowOf(rid), &old_entry) || old_entry.kind_ != LsmEntryKind::VALUE) {
+      return false;
+    }
+    memtable_->Put(old_entry.row_, LsmEntryKind::VALUE, tuple);
+  }
+  // Update the transaction's write set.
+  if (txn->GetState() != TransactionState::ABORTED) {
+    txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_entry.tuple_, this);
+  }
+  return true;
+}
+
+void LsmTable::ApplyDelete(const RID &rid, Transaction *txn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  MakeRoom(&lock);
+  memtable_->Put(RowOf(rid), LsmEntryKind::TOMBSTONE, Tuple{});
+}
+
+void LsmTable::RollbackDelete(const RID &rid, Transaction *txn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  MakeRoom(&lock);
+  LsmEntry entry;
+  if (Find(CurrentVersion(), RowOf(rid), &entry) && entry.kind_ == LsmEntryKind::DELETE_MARKED) {
+    memtable_->Put(entry.row_, LsmEntryKind::VALUE, entry.tuple_);
+  }
+}
+
+/*
+ * Hand the memtable to the background thread once it is full, waiting for
+ * the flush of the one handed over before if that is still going on
+ */
+void LsmTable::MakeRoom(std::unique_lock<std::mutex> *lock) {
+  if (memtable_->GetSize() < memtable_size_) {
+    return;
+  }
+  cv_.wait(*lock, [this] { return immutable_ == nullptr; });
+  // Another writer may have handed it over while we waited
+  if (memtable_->GetSize() < memtable_size_) {
+    return;
+  }
+  immutable_ = std::move(memtable_);
+  memtable_ = std::make_shared<LsmMemTable>();
+  cv_.notify_all();
+}
+
+/*****************************************************************************
+ * READ
+ *****************************************************************************/
+bool LsmTable::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+  LsmEntry entry;
+  if (!Find(GetVersion(), RowOf(rid), &entry) || entry.kind_ != LsmEntryKind::VALUE) {
+    return false;
+  }
+  // rid may be the rid of tuple, which the assignment overwrites
+  *tuple = entry.tuple_;
+  tuple->rid_ = RidOf(entry.row_);
+  return true;
+}
+
+TableIterator LsmTable::Begin(Transaction *txn) {
+  Tuple tuple;
+  RID rid = Seek(GetVersion(), 0, &tuple) ? tuple.rid_ : RID(INVALID_PAGE_ID, 0);
+  return TableIterator(this, rid, txn);
+}
+
+void LsmTable::NextTuple(Tuple *tuple, Transaction *txn) {
+  if (!Seek(GetVersion(), RowOf(tuple->rid_) + 1, tuple)) {
+    tuple->rid_ = RID(INVALID_PAGE_ID, 0);
+  }
+}
+
+LsmTable::Version LsmTable::CurrentVersion() const {
+  Version version{memtable_, immutable_, level0_};
+  for (const auto &run : levels_) {
+    if (run != nullptr) {
+      version.runs_.push_back(run);
+    }
+  }
+  return version;
+}
+
+LsmTable::Version LsmTable::GetVersion() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return CurrentVersion();
+}
+
+bool LsmTable::Find(const Version &version, uint64_t row, LsmEntry *entry) {
+  if (version.memtable_->Get(row, entry)) {
+    return true;
+  }
+  if (version.immutable_ != nullptr && version.immutable_->Get(row, entry)) {
+    return true;
+  }
+  for (const auto &run : version.runs_) {
+    if (run->Get(row, entry)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Find the first row from row on whose newest entry holds a tuple. Each of the
+ * memtables and runs is searched for the first row it has from row on; of
+ * those the lowest row is next, with the entry of the newest that has it.
+ */
+bool LsmTable::Seek(const Version &version, uint64_t row, Tuple *tuple) const {
+  while (true) {
+    LsmEntry next;
+    bool found = false;
+    LsmEntry entry;
+    auto take_if_lower = [&](bool has_entry) {
+      if (has_entry && (!found || entry.row_ < next.row_)) {
+        std::swap(next, entry);
+        found = true;
+      }
+    };
+    take_if_lower(version.memtable_->LowerBound(row, &entry));
+    if (version.immutable_ != nullptr) {
+      take_if_lower(version.immutable_->LowerBound(row, &entry));
+    }
+    for (const auto &run : version.runs_) {
+      take_if_lower(run->LowerBound(row, &entry));
+    }
+    if (!found) {
+      return false;
+    }
+    if (next.kind_ == LsmEntryKind::VALUE) {
+      *tuple = next.tuple_;
+      tuple->rid_ = RidOf(next.row_);
+      return true;
+    }
+    // The row was deleted, go on with the rows after it
+    row = next.row_ + 1;
+  }
+}
+
+/*****************************************************************************
+ * FLUSH AND COMPACTION
+ *****************************************************************************/
+void LsmTable::Flush() {
+  std::unique_lock<std::mutex> lock(latch_);
+  cv_.wait(lock, [this] { return immutable_ == nullptr; });
+  if (memtable_->GetNumEntries() != 0) {
+    immutable_ = std::move(memtable_);
+    memtable_ = std::make_shared<LsmMemTable>();
+    cv_.notify_all();
+  }
+  size_t level;
+  cv_.wait(lock, [this, &level] { return immutable_ == nullptr && !busy_ && !NeedsCompaction(&level); });
+}
+
+size_t LsmTable::GetNumRuns(size_t level) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (level == 0) {
+    return level0_.size();
+  }
+  return level <= levels_.size() && levels_[level - 1] != nullptr ? 1 : 0;
+}
+
+void LsmTable::RunBackgroundThread() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    size_t level;
+    cv_.wait(lock, [this, &level] { return stop_ || immutable_ != nullptr || NeedsCompaction(&level); });
+    if (stop_) {
+      return;
+    }
+    busy_ = true;
+    if (immutable_ != nullptr) {
+      // Write the memtable out as the newest run of level 0; it is read from as it is until then
+      std::shared_ptr<LsmMemTable> memtable = immutable_;
+      lock.unlock();
+      auto run = std::make_shared<LsmRun>(buffer_pool_manager_, memtable->GetNumEntries());
+      memtable->ForEach([&run](const LsmEntry &entry) { run->Append(entry); });
+      run->Finish();
+      lock.lock();
+      level0_.insert(level0_.begin(), std::move(run));
+      immutable_ = nullptr;
+    } else {
+      Compact(level, &lock);
+    }
+    busy_ = false;
+    cv_.notify_all();
+  }
+}
+
+bool LsmTable::NeedsCompaction(size_t *level) const {
+  if (level0_.size() >= level0_runs_) {
+    *level = 0;
+    return true;
+  }
+  for (size_t i = 0; i < levels_.size(); i++) {
+    if (levels_[i] != nullptr && levels_[i]->GetSize() > LevelCapacity(i + 1)) {
+      *level = i + 1;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t LsmTable::LevelCapacity(size_t level) const {
+  size_t capacity = memtable_size_ * level0_runs_;
+  for (size_t i = 1; i < level; i++) {
+    capacity *= level_size_ratio_;
+  }
+  return capacity;
+}
+
+/*
+ * Merge the runs of level into the run of the level below it. Only the
+ * background thread changes the runs, so the runs merged are still there when
+ * the merged run takes their place.
+ */
+void LsmTable::Compact(size_t level, std::unique_lock<std::mutex> *lock) {
+  std::vector<std::shared_ptr<LsmRun>> inputs;
+  if (level == 0) {
+    inputs = level0_;
+  } else {
+    inputs.push_back(levels_[level - 1]);
+  }
+  if (level < levels_.size() && levels_[level] != nullptr) {
+    inputs.push_back(levels_[level]);
+  }
+  // A tombstone has nothing left to hide once it reaches the last level
+  bool last_level = true;
+  for (size_t i = level + 1; i < levels_.size(); i++) {
+    last_level = last_level && levels_[i] == nullptr;
+  }
+  size_t max_entries = 0;
+  for (const auto &run : inputs) {
+    max_entries += run->GetNumEntries();
+  }
+  lock->unlock();
+
+  auto output = std::make_shared<LsmRun>(buffer_pool_manager_, max_entries);
+  std::vector<LsmRun::Cursor> cursors;
+  cursors.reserve(inputs.size());
+  for (const auto &run : inputs) {
+    cursors.emplace_back(run.get());
+  }
+  while (true) {
+    // The lowest row left, from the newest run that has it
+    LsmRun::Cursor *newest = nullptr;
+    for (auto &cursor : cursors) {
+      if (!cursor.IsEnd() && (newest == nullptr || cursor.Entry().row_ < newest->Entry().row_)) {
+        newest = &cursor;
+      }
+    }
+    if (newest == nullptr) {
+      break;
+    }
+    uint64_t row = newest->Entry().row_;
+    if (!last_level || newest->Entry().kind_ != LsmEntryKind::TOMBSTONE) {
+      output->Append(newest->Entry());
+    }
+    for (auto &cursor : cursors) {
+      if (!cursor.IsEnd() && cursor.Entry().row_ == row) {
+        cursor.Next();
+      }
+    }
+  }
+  output->Finish();
+
+  lock->lock();
+  if (level == 0) {
+    level0_.clear();
+  } else {
+    levels_[level - 1] = nullptr;
+  }
+  if (levels_.size() <= level) {
+    levels_.resize(level + 1);
+  }
+  levels_[level] = output->GetNumEntries() == 0 ? nullptr : std::move(output);
+}
+
+}  // namespace bustub
@@ -189,6 +189,35 @@ TableIterator TableHeap::Begin(Transaction *txn) {
   return TableIterator(this, rid, txn);
 }
 
+void TableHeap::NextTuple(Tuple *tuple, Transaction *txn) {
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(tuple->rid_.GetPageId()));
+  cur_page->RLatch();
+  assert(cur_page != nullptr);  // all pages are pinned
+
+  RID next_tuple_rid;
+  if (!cur_page->GetNextTupleRid(tuple->rid_,
+                                 &next_tuple_rid)) {  // end of this page
+    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
+      auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(cur_page->GetNextPageId()));
+      cur_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+      cur_page = next_page;
+      cur_page->RLatch();
+      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
+        break;
+      }
+    }
+  }
+  tuple->rid_ = next_tuple_rid;
+
+  if (next_tuple_rid.GetPageId() != INVALID_PAGE_ID) {
+    GetTuple(tuple->rid_, tuple, txn);
+  }
+  // release until copy the tuple
+  cur_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+}
+
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
 
 }  // namespace bustub
@@ -10,13 +10,18 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <mutex>  // NOLINT
 #include <string>
+#include <tuple>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "catalog/catalog.h"
 #include "catalog/table_generator.h"
+#include "concurrency/transaction_manager.h"
 #include "execution/executor_context.h"
 #include "gtest/gtest.h"
 #include "type/value_factory.h"
@@ -688,4 +693,570 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
   remove("catalog_test.log");
 }
 
+// Rebuilding should bring every index of a table back in sync with the table heap
+TEST(CatalogTest, RebuildIndexesTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto lock_manager = std::make_unique<LockManager>();
+  auto catalog = std::make_unique<Catalog>(bpm.get(), lock_manager.get(), nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"foobar"};
+  std::vector<Column> columns{{"A", TypeId::INTEGER}, {"B", TypeId::INTEGER}};
+  Schema table_schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), table_name, table_schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+
+  std::vector<Column> key_columns_a{{"A", TypeId::INTEGER}};
+  std::vector<Column> key_columns_b{{"B", TypeId::INTEGER}};
+  Schema key_schema_a{key_columns_a};
+  Schema key_schema_b{key_columns_b};
+  ASSERT_NE(Catalog::NULL_INDEX_INFO,
+            (catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+                txn.get(), "tree_index", table_name, table_schema, key_schema_a, {0}, 8, HashFunction<GenericKey<8>>{},
+                IndexType::BPlusTreeIndex)));
+  ASSERT_NE(Catalog::NULL_INDEX_INFO,
+            (catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+                txn.get(), "hash_index", table_name, table_schema, key_schema_b, {1}, 8, HashFunction<GenericKey<8>>{},
+                IndexType::HashTableIndex)));
+
+  // Fill the table behind the back of the indexes, in descending key order, then delete every third tuple
+  const int num_tuples = 3000;
+  std::vector<RID> rids(num_tuples);
+  for (int i = num_tuples - 1; i >= 0; i--) {
+    Tuple tuple{std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(-i)},
+                &table_schema};
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rids[i], txn.get()));
+  }
+  for (int i = 0; i < num_tuples; i += 3) {
+    ASSERT_TRUE(table_info->table_->MarkDelete(rids[i], txn.get()));
+    table_info->table_->ApplyDelete(rids[i], txn.get());
+  }
+
+  catalog->RebuildIndexes(txn.get(), 4);
+
+  auto *tree_index = catalog->GetIndex("tree_index", table_name)->index_.get();
+  auto *hash_index = catalog->GetIndex("hash_index", table_name)->index_.get();
+  for (int i = 0; i < num_tuples; i++) {
+    Tuple tuple{std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(-i)},
+                &table_schema};
+    std::vector<RID> tree_result;
+    std::vector<RID> hash_result;
+    tree_index->ScanKey(tuple.KeyFromTuple(table_schema, key_schema_a, {0}), &tree_result, txn.get());
+    hash_index->ScanKey(tuple.KeyFromTuple(table_schema, key_schema_b, {1}), &hash_result, txn.get());
+    if (i % 3 == 0) {
+      EXPECT_TRUE(tree_result.empty());
+      EXPECT_TRUE(hash_result.empty());
+    } else {
+      ASSERT_EQ(1, tree_result.size());
+      EXPECT_EQ(rids[i], tree_result[0]);
+      ASSERT_EQ(1, hash_result.size());
+      EXPECT_EQ(rids[i], hash_result[0]);
+    }
+  }
+
+  // The tree is built bottom-up, a scan sees every live key in order
+  auto *tree = dynamic_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(tree_index);
+  ASSERT_NE(nullptr, tree);
+  int expected = 1;
+  int count = 0;
+  for (auto it = tree->GetBeginIterator(); !it.IsEnd(); ++it) {
+    EXPECT_EQ(rids[expected], (*it).second);
+    expected += expected % 3 == 1 ? 1 : 2;
+    count++;
+  }
+  EXPECT_EQ(num_tuples - (num_tuples + 2) / 3, count);
+
+  // A batch of keys in descending order is answered key by key, whether the index sorts it or not
+  std::vector<Tuple> keys_a;
+  std::vector<Tuple> keys_b;
+  for (int i = num_tuples - 1; i >= 0; i--) {
+    Tuple tuple{std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(-i)},
+                &table_schema};
+    keys_a.emplace_back(tuple.KeyFromTuple(table_schema, key_schema_a, {0}));
+    keys_b.emplace_back(tuple.KeyFromTuple(table_schema, key_schema_b, {1}));
+  }
+  std::vector<std::vector<RID>> tree_results;
+  std::vector<std::vector<RID>> hash_results;
+  tree_index->ScanKeys(keys_a, &tree_results, txn.get());
+  hash_index->ScanKeys(keys_b, &hash_results, txn.get());
+  ASSERT_EQ(num_tuples, tree_results.size());
+  ASSERT_EQ(num_tuples, hash_results.size());
+  for (int i = 0; i < num_tuples; i++) {
+    const auto &tree_result = tree_results[num_tuples - 1 - i];
+    const auto &hash_result = hash_results[num_tuples - 1 - i];
+    if (i % 3 == 0) {
+      EXPECT_TRUE(tree_result.empty());
+      EXPECT_TRUE(hash_result.empty());
+    } else {
+      ASSERT_EQ(1, tree_result.size());
+      EXPECT_EQ(rids[i], tree_result[0]);
+      ASSERT_EQ(1, hash_result.size());
+      EXPECT_EQ(rids[i], hash_result[0]);
+    }
+  }
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+/** A buffer pool that keeps track of the pages created and not deleted yet */
+class PageCountingBufferPool : public BufferPoolManagerInstance {
+ public:
+  using BufferPoolManagerInstance::BufferPoolManagerInstance;
+
+  size_t GetPageCount() {
+    std::scoped_lock latch(latch_);
+    return live_pages_.size();
+  }
+
+ protected:
+  Page *NewPgImp(page_id_t *page_id) override {
+    Page *page = BufferPoolManagerInstance::NewPgImp(page_id);
+    if (page != nullptr) {
+      std::scoped_lock latch(latch_);
+      live_pages_.insert(*page_id);
+    }
+    return page;
+  }
+
+  bool DeletePgImp(page_id_t page_id) override {
+    bool deleted = BufferPoolManagerInstance::DeletePgImp(page_id);
+    if (deleted) {
+      std::scoped_lock latch(latch_);
+      live_pages_.erase(page_id);
+    }
+    return deleted;
+  }
+
+ private:
+  std::mutex latch_;
+  std::unordered_set<page_id_t> live_pages_;
+};
+
+// A rebuild deletes the pages of the indexes it replaces, so rebuilding again takes no more pages
+TEST(CatalogTest, RebuildIndexesTwiceTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<PageCountingBufferPool>(64, disk_manager.get());
+  // the header page, where the trees keep their root page ids
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto lock_manager = std::make_unique<LockManager>();
+  auto catalog = std::make_unique<Catalog>(bpm.get(), lock_manager.get(), nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"foobar"};
+  std::vector<Column> columns{{"A", TypeId::INTEGER}};
+  Schema table_schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), table_name, table_schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+
+  std::vector<Column> key_columns{{"A", TypeId::INTEGER}};
+  Schema key_schema{key_columns};
+  // the index name, its type and the number of its levels kept pinned
+  std::vector<std::tuple<std::string, IndexType, int>> index_types{{"tree_index", IndexType::BPlusTreeIndex, 0},
+                                                                   {"pinned_tree_index", IndexType::BPlusTreeIndex, 2},
+                                                                   {"link_index", IndexType::BLinkTreeIndex, 0},
+                                                                   {"epsilon_index", IndexType::BEpsilonTreeIndex, 0},
+                                                                   {"hash_index", IndexType::HashTableIndex, 0}};
+  for (const auto &[index_name, index_type, pinned_levels] : index_types) {
+    ASSERT_NE(Catalog::NULL_INDEX_INFO,
+              (catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+                  txn.get(), index_name, table_name, table_schema, key_schema, {0}, 8, HashFunction<GenericKey<8>>{},
+                  index_type, pinned_levels)));
+  }
+
+  const int num_tuples = 3000;
+  for (int i = 0; i < num_tuples; i++) {
+    RID rid;
+    Tuple tuple{std::vector<Value>{ValueFactory::GetIntegerValue(i)}, &table_schema};
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  catalog->RebuildIndexes(txn.get(), 1);
+  const size_t page_count = bpm->GetPageCount();
+  for (int round = 0; round < 2; round++) {
+    catalog->RebuildIndexes(txn.get(), 1);
+    EXPECT_EQ(page_count, bpm->GetPageCount());
+  }
+
+  for (const auto &[index_name, index_type, pinned_levels] : index_types) {
+    auto *index = catalog->GetIndex(index_name, table_name)->index_.get();
+    for (int i = 0; i < num_tuples; i += 7) {
+      Tuple tuple{std::vector<Value>{ValueFactory::GetIntegerValue(i)}, &table_schema};
+      std::vector<RID> result;
+      index->ScanKey(tuple, &result, txn.get());
+      EXPECT_EQ(1, result.size()) << index_name;
+    }
+  }
+
+  // no page stays pinned once the indexes go away, including the pinned levels of the replaced trees
+  catalog.reset();
+  for (int i = 0; i < 64; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+TEST(CatalogTest, NonUniqueIndexTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto lock_manager = std::make_unique<LockManager>();
+  auto catalog = std::make_unique<Catalog>(bpm.get(), lock_manager.get(), nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"foobar"};
+  std::vector<Column> columns{{"A", TypeId::INTEGER}, {"B", TypeId::INTEGER}};
+  Schema table_schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), table_name, table_schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+
+  // A takes only num_keys distinct values, the first half of the tuples is there before the index is built
+  const int num_keys = 7;
+  const int num_tuples = 2000;
+  std::vector<RID> rids(num_tuples);
+  auto make_tuple = [&](int i) {
+    return Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(i % num_keys), ValueFactory::GetIntegerValue(i)},
+                 &table_schema};
+  };
+  for (int i = 0; i < num_tuples / 2; i++) {
+    ASSERT_TRUE(table_info->table_->InsertTuple(make_tuple(i), &rids[i], txn.get()));
+  }
+
+  std::vector<Column> key_columns{{"A", TypeId::INTEGER}};
+  Schema key_schema{key_columns};
+  EXPECT_THROW((catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+                   txn.get(), "narrow_index", table_name, table_schema, key_schema, {0}, 8,
+                   HashFunction<GenericKey<8>>{}, IndexType::NonUniqueBPlusTreeIndex)),
+               Exception);
+  auto *index_info = catalog->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(
+      txn.get(), "index", table_name, table_schema, key_schema, {0}, 16, HashFunction<GenericKey<16>>{},
+      IndexType::NonUniqueBPlusTreeIndex);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *index = index_info->index_.get();
+  for (int i = num_tuples / 2; i < num_tuples; i++) {
+    ASSERT_TRUE(table_info->table_->InsertTuple(make_tuple(i), &rids[i], txn.get()));
+    index->InsertEntry(make_tuple(i).KeyFromTuple(table_schema, key_schema, {0}), rids[i], txn.get());
+  }
+
+  // every key finds all of its entries, in RID order; deleting one (key, rid) pair leaves the others of the key be
+  auto check_key = [&](int key, const std::unordered_set<int> &deleted) {
+    std::vector<RID> result;
+    index->ScanKey(make_tuple(key).KeyFromTuple(table_schema, key_schema, {0}), &result, txn.get());
+    std::vector<RID> expected;
+    for (int i = key; i < num_tuples; i += num_keys) {
+      if (deleted.count(i) == 0) {
+        expected.push_back(rids[i]);
+      }
+    }
+    std::sort(expected.begin(), expected.end(), [](const RID &lhs, const RID &rhs) { return lhs.Get() < rhs.Get(); });
+    EXPECT_EQ(expected, result) << key;
+  };
+  for (int key = 0; key < num_keys; key++) {
+    check_key(key, {});
+  }
+  std::unordered_set<int> deleted{3, 3 + num_keys, num_tuples - 4};
+  for (int i : deleted) {
+    index->DeleteEntry(make_tuple(i).KeyFromTuple(table_schema, key_schema, {0}), rids[i], txn.get());
+  }
+  for (int key = 0; key < num_keys; key++) {
+    check_key(key, deleted);
+  }
+
+  // range bounds take in, or leave out, every entry of their key
+  auto *tree = dynamic_cast<BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>> *>(index);
+  ASSERT_NE(nullptr, tree);
+  auto count_range = [&](int lower, bool lower_inclusive, int upper, bool upper_inclusive) {
+    GenericKey<16> lower_key;
+    GenericKey<16> upper_key;
+    lower_key.SetFromKey(make_tuple(lower).KeyFromTuple(table_schema, key_schema, {0}), &key_schema);
+    upper_key.SetFromKey(make_tuple(upper).KeyFromTuple(table_schema, key_schema, {0}), &key_schema);
+    int count = 0;
+    for (auto it = tree->GetRangeIterator(&lower_key, lower_inclusive, &upper_key, upper_inclusive); !it.IsEnd();
+         ++it) {
+      count++;
+    }
+    return count;
+  };
+  // keys 2 to 4 each have one entry more than num_tuples / num_keys, two of key 3 were deleted
+  const int per_key = num_tuples / num_keys + 1;
+  EXPECT_EQ(3 * per_key - 2, count_range(2, true, 4, true));
+  EXPECT_EQ(per_key - 2, count_range(2, false, 4, false));
+  EXPECT_EQ(0, count_range(3, false, 3, true));
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// Keys that share a long prefix stay apart in a non-unique index, whose key schema must leave room for the RID
+TEST(CatalogTest, NonUniqueIndexLongKeyTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto lock_manager = std::make_unique<LockManager>();
+  auto catalog = std::make_unique<Catalog>(bpm.get(), lock_manager.get(), nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"foobar"};
+  std::vector<Column> columns{{"A", TypeId::VARCHAR, 10}, {"B", TypeId::INTEGER}};
+  Schema table_schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), table_name, table_schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+
+  // a VARCHAR(10) takes up to 23 bytes, which leave no room for the RID in 16 bytes but do in 32
+  std::vector<Column> key_columns{{"A", TypeId::VARCHAR, 10}};
+  Schema key_schema{key_columns};
+  EXPECT_THROW((catalog->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(
+                   txn.get(), "narrow_index", table_name, table_schema, key_schema, {0}, 16,
+                   HashFunction<GenericKey<16>>{}, IndexType::NonUniqueBPlusTreeIndex)),
+               Exception);
+  auto *index_info = catalog->CreateIndex<GenericKey<32>, RID, GenericComparator<32>>(
+      txn.get(), "index", table_name, table_schema, key_schema, {0}, 32, HashFunction<GenericKey<32>>{},
+      IndexType::NonUniqueBPlusTreeIndex);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *index = index_info->index_.get();
+
+  const std::vector<std::string> keys{"applesauce", "applesaXYZ", "applesa", "applesauc", "applesaucf"};
+  const int per_key = 50;
+  std::vector<std::vector<RID>> rids(keys.size());
+  auto make_tuple = [&](size_t key, int i) {
+    return Tuple{std::vector<Value>{ValueFactory::GetVarcharValue(keys[key]), ValueFactory::GetIntegerValue(i)},
+                 &table_schema};
+  };
+  for (int i = 0; i < per_key; i++) {
+    for (size_t key = 0; key < keys.size(); key++) {
+      RID rid;
+      Tuple tuple = make_tuple(key, i);
+      ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+      index->InsertEntry(tuple.KeyFromTuple(table_schema, key_schema, {0}), rid, txn.get());
+      rids[key].push_back(rid);
+    }
+  }
+
+  for (size_t key = 0; key < keys.size(); key++) {
+    std::vector<RID> result;
+    index->ScanKey(make_tuple(key, 0).KeyFromTuple(table_schema, key_schema, {0}), &result, txn.get());
+    EXPECT_EQ(rids[key], result) << keys[key];
+  }
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+TEST(CatalogTest, BEpsilonTreeIndexTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto lock_manager = std::make_unique<LockManager>();
+  auto catalog = std::make_unique<Catalog>(bpm.get(), lock_manager.get(), nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"foobar"};
+  std::vector<Column> columns{{"A", TypeId::INTEGER}, {"B", TypeId::INTEGER}};
+  Schema table_schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), table_name, table_schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+
+  // the first half of the tuples is there before the index is built, the rest is inserted into it afterwards
+  const int num_tuples = 5000;
+  std::vector<RID> rids(num_tuples);
+  auto make_tuple = [&](int i) {
+    return Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(-i)},
+                 &table_schema};
+  };
+  for (int i = 0; i < num_tuples / 2; i++) {
+    ASSERT_TRUE(table_info->table_->InsertTuple(make_tuple(i), &rids[i], txn.get()));
+  }
+  std::vector<Column> key_columns{{"A", TypeId::INTEGER}};
+  Schema key_schema{key_columns};
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      txn.get(), "index", table_name, table_schema, key_schema, {0}, 8, HashFunction<GenericKey<8>>{},
+      IndexType::BEpsilonTreeIndex);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *index = index_info->index_.get();
+  for (int i = num_tuples / 2; i < num_tuples; i++) {
+    ASSERT_TRUE(table_info->table_->InsertTuple(make_tuple(i), &rids[i], txn.get()));
+    index->InsertEntry(make_tuple(i).KeyFromTuple(table_schema, key_schema, {0}), rids[i], txn.get());
+  }
+  for (int i = 0; i < num_tuples; i += 3) {
+    index->DeleteEntry(make_tuple(i).KeyFromTuple(table_schema, key_schema, {0}), rids[i], txn.get());
+  }
+
+  // the point queries and the scan see the buffered writes
+  for (int i = 0; i < num_tuples; i++) {
+    std::vector<RID> result;
+    index->ScanKey(make_tuple(i).KeyFromTuple(table_schema, key_schema, {0}), &result, txn.get());
+    if (i % 3 == 0) {
+      EXPECT_TRUE(result.empty()) << i;
+    } else {
+      ASSERT_EQ(1, result.size()) << i;
+      EXPECT_EQ(rids[i], result[0]);
+    }
+  }
+  auto *tree = dynamic_cast<BEpsilonTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(index);
+  ASSERT_NE(nullptr, tree);
+  int expected = 1;
+  for (auto it = tree->GetBeginIterator(); !it.IsEnd(); ++it) {
+    EXPECT_EQ(rids[expected], (*it).second);
+    expected += expected % 3 == 1 ? 1 : 2;
+  }
+  EXPECT_EQ(num_tuples, expected);
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+
+TEST(CatalogTest, AdaptiveRadixTreeIndexTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto lock_manager = std::make_unique<LockManager>();
+  auto catalog = std::make_unique<Catalog>(bpm.get(), lock_manager.get(), nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"foobar"};
+  std::vector<Column> columns{{"A", TypeId::INTEGER}, {"B", TypeId::INTEGER}};
+  Schema table_schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), table_name, table_schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+
+  // the first half of the tuples is there before the index is built, the rest is inserted into it afterwards
+  const int num_tuples = 5000;
+  std::vector<RID> rids(num_tuples);
+  auto make_tuple = [&](int i) {
+    return Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(-i)},
+                 &table_schema};
+  };
+  for (int i = 0; i < num_tuples / 2; i++) {
+    ASSERT_TRUE(table_info->table_->InsertTuple(make_tuple(i), &rids[i], txn.get()));
+  }
+  std::vector<Column> key_columns{{"B", TypeId::INTEGER}};
+  Schema key_schema{key_columns};
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      txn.get(), "index", table_name, table_schema, key_schema, {1}, 8, HashFunction<GenericKey<8>>{},
+      IndexType::AdaptiveRadixTreeIndex);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *index = index_info->index_.get();
+  for (int i = num_tuples / 2; i < num_tuples; i++) {
+    ASSERT_TRUE(table_info->table_->InsertTuple(make_tuple(i), &rids[i], txn.get()));
+    index->InsertEntry(make_tuple(i).KeyFromTuple(table_schema, key_schema, {1}), rids[i], txn.get());
+  }
+  for (int i = 0; i < num_tuples; i += 3) {
+    ASSERT_TRUE(table_info->table_->MarkDelete(rids[i], txn.get()));
+    table_info->table_->ApplyDelete(rids[i], txn.get());
+    index->DeleteEntry(make_tuple(i).KeyFromTuple(table_schema, key_schema, {1}), rids[i], txn.get());
+  }
+
+  // the keys are the negated values of column A, which a range scan returns from the most negative one up; the index
+  // is lost on a restart and rebuilt from the table
+  for (int rebuild = 0; rebuild < 2; rebuild++) {
+    for (int i = 0; i < num_tuples; i++) {
+      std::vector<RID> result;
+      index->ScanKey(make_tuple(i).KeyFromTuple(table_schema, key_schema, {1}), &result, txn.get());
+      if (i % 3 == 0) {
+        EXPECT_TRUE(result.empty()) << i;
+      } else {
+        ASSERT_EQ(1, result.size()) << i;
+        EXPECT_EQ(rids[i], result[0]);
+      }
+    }
+    auto *tree = dynamic_cast<AdaptiveRadixTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(index);
+    ASSERT_NE(nullptr, tree);
+    GenericKey<8> lower;
+    GenericKey<8> upper;
+    lower.SetFromKey(make_tuple(1000).KeyFromTuple(table_schema, key_schema, {1}), &key_schema);
+    upper.SetFromKey(make_tuple(10).KeyFromTuple(table_schema, key_schema, {1}), &key_schema);
+    std::vector<RID> result;
+    tree->ScanRange(&lower, true, &upper, false, &result);
+    int expected = 1000;
+    for (const auto &rid : result) {
+      EXPECT_EQ(rids[expected], rid);
+      expected -= expected % 3 == 1 ? 2 : 1;
+    }
+    EXPECT_EQ(10, expected);
+
+    catalog->RebuildIndexes(txn.get(), 2);
+    index = catalog->GetIndex("index", table_name)->index_.get();
+  }
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+TEST(CatalogTest, LsmTableTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto lock_manager = std::make_unique<LockManager>();
+  auto catalog = std::make_unique<Catalog>(bpm.get(), lock_manager.get(), nullptr);
+  TransactionManager txn_mgr(lock_manager.get());
+  auto *txn = txn_mgr.Begin();
+
+  const std::string table_name{"events"};
+  std::vector<Column> columns{{"A", TypeId::INTEGER}, {"B", TypeId::INTEGER}};
+  Schema table_schema{columns};
+  auto *table_info = catalog->CreateTable(txn, table_name, table_schema, TableType::LsmTable);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  ASSERT_NE(nullptr, dynamic_cast<LsmTable *>(table_info->table_.get()));
+  auto *table = table_info->table_.get();
+
+  // enough tuples for the table to write runs, which the index is built from
+  const int num_tuples = 20000;
+  std::vector<RID> rids(num_tuples);
+  auto make_tuple = [&](int i) {
+    return Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(-i)},
+                 &table_schema};
+  };
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i), &rids[i], txn));
+  }
+  txn_mgr.Commit(txn);
+  delete txn;
+
+  // an aborted transaction takes back its inserts and deletes
+  txn = txn_mgr.Begin();
+  RID aborted_rid;
+  ASSERT_TRUE(table->InsertTuple(make_tuple(num_tuples), &aborted_rid, txn));
+  ASSERT_TRUE(table->MarkDelete(rids[0], txn));
+  txn_mgr.Abort(txn);
+  delete txn;
+  txn = txn_mgr.Begin();
+  Tuple tuple;
+  EXPECT_FALSE(table->GetTuple(aborted_rid, &tuple, txn));
+  EXPECT_TRUE(table->GetTuple(rids[0], &tuple, txn));
+  for (int i = 1; i < num_tuples; i += 2) {
+    ASSERT_TRUE(table->MarkDelete(rids[i], txn));
+  }
+  txn_mgr.Commit(txn);
+  delete txn;
+
+  txn = txn_mgr.Begin();
+  std::vector<Column> key_columns{{"B", TypeId::INTEGER}};
+  Schema key_schema{key_columns};
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      txn, "index", table_name, table_schema, key_schema, {1}, 8, HashFunction<GenericKey<8>>{},
+      IndexType::BPlusTreeIndex);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  for (int rebuild = 0; rebuild < 2; rebuild++) {
+    auto *index = catalog->GetIndex("index", table_name)->index_.get();
+    for (int i = 0; i < num_tuples; i++) {
+      std::vector<RID> result;
+      index->ScanKey(make_tuple(i).KeyFromTuple(table_schema, key_schema, {1}), &result, txn);
+      if (i % 2 == 1) {
+        EXPECT_TRUE(result.empty()) << i;
+      } else {
+        ASSERT_EQ(1, result.size()) << i;
+        EXPECT_EQ(rids[i], result[0]);
+      }
+    }
+    catalog->RebuildIndexes(txn, 2);
+  }
+  txn_mgr.Commit(txn);
+  delete txn;
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
 }  // namespace bustub
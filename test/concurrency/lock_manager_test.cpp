@@ -204,4 +204,35 @@ void WoundWaitBasicTest() {
 }
 TEST(LockManagerTest, DISABLED_WoundWaitBasicTest) { WoundWaitBasicTest(); }
 
+// NOLINTNEXTLINE
+TEST(LockManagerTest, CommitDependencyTest) {
+  LockManager lock_mgr{};
+  RID rid{0, 0};
+  RID other_rid{0, 1};
+
+  // a writer that releases its lock before its COMMIT record is flushed passes that record on to the next locker
+  Transaction writer(0);
+  lock_mgr.LockExclusive(&writer, rid);
+  lock_mgr.Unlock(&writer, rid, 10);
+  Transaction reader(1);
+  lock_mgr.LockShared(&reader, rid);
+  lock_mgr.LockShared(&reader, other_rid);
+  EXPECT_EQ(10, reader.GetCommitDependencyLSN());
+
+  // once the record is on disk it is forgotten, and so is the rid if no one else has it locked
+  Transaction second_writer(2);
+  lock_mgr.LockExclusive(&second_writer, other_rid);
+  lock_mgr.Unlock(&second_writer, other_rid, 20);
+  lock_mgr.ForgetDurableCommits(15);
+  Transaction late_reader(3);
+  lock_mgr.LockShared(&late_reader, rid);
+  EXPECT_EQ(INVALID_LSN, late_reader.GetCommitDependencyLSN());
+  lock_mgr.LockShared(&late_reader, other_rid);
+  EXPECT_EQ(20, late_reader.GetCommitDependencyLSN());
+  lock_mgr.ForgetDurableCommits(20);
+  Transaction last_reader(4);
+  lock_mgr.LockShared(&last_reader, other_rid);
+  EXPECT_EQ(INVALID_LSN, last_reader.GetCommitDependencyLSN());
+}
+
 }  // namespace bustub
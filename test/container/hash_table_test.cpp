@@ -10,6 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <random>
+#include <string>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -117,4 +121,165 @@ TEST(HashTableTest, SampleTest) {
   delete bpm;
 }
 
+namespace {
+// runs task(thread_itr) on num_threads threads
+template <typename Task>
+void RunThreads(uint64_t num_threads, Task task) {
+  std::vector<std::thread> threads;
+  for (uint64_t thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+    threads.emplace_back(task, thread_itr);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentInsertRemoveTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // the threads insert their own keys side by side, splitting buckets as they go, and read back each other's
+  const int num_threads = 4;
+  const int num_keys = 20000;
+  RunThreads(num_threads, [&](uint64_t thread_itr) {
+    for (int key = static_cast<int>(thread_itr); key < num_keys; key += num_threads) {
+      EXPECT_TRUE(ht.Insert(nullptr, key, key));
+      EXPECT_FALSE(ht.Insert(nullptr, key, key));
+      std::vector<int> res;
+      ht.GetValue(nullptr, key / 2, &res);
+      EXPECT_LE(res.size(), 1);
+    }
+  });
+  ht.VerifyIntegrity();
+  for (int key = 0; key < num_keys; key++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, key, &res)) << key;
+    EXPECT_EQ(std::vector<int>{key}, res);
+  }
+
+  // then they remove all but every tenth key, which merges the emptied buckets back
+  uint32_t grown_depth = ht.GetGlobalDepth();
+  RunThreads(num_threads, [&](uint64_t thread_itr) {
+    for (int key = static_cast<int>(thread_itr); key < num_keys; key += num_threads) {
+      if (key % 10 != 0) {
+        EXPECT_TRUE(ht.Remove(nullptr, key, key));
+        EXPECT_FALSE(ht.Remove(nullptr, key, key));
+      }
+    }
+  });
+  ht.VerifyIntegrity();
+  EXPECT_LE(ht.GetGlobalDepth(), grown_depth);
+  for (int key = 0; key < num_keys; key++) {
+    std::vector<int> res;
+    EXPECT_EQ(key % 10 == 0, ht.GetValue(nullptr, key, &res)) << key;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, GrowPastDirectoryPageTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // more buckets than one directory page has slots for, so that some of them move into child directory pages
+  const int num_keys = 250000;
+  for (int key = 0; key < num_keys; key++) {
+    ASSERT_TRUE(ht.Insert(nullptr, key, key)) << key;
+  }
+  ht.VerifyIntegrity();
+  uint32_t grown_depth = ht.GetGlobalDepth();
+  EXPECT_GT(grown_depth, DIRECTORY_MAX_DEPTH);
+  for (int key = 0; key < num_keys; key++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, key, &res)) << key;
+    EXPECT_EQ(std::vector<int>{key}, res);
+  }
+
+  // emptied buckets merge back, and child directory pages left with a single bucket fold into their parents
+  for (int key = 0; key < num_keys; key++) {
+    ASSERT_TRUE(ht.Remove(nullptr, key, key)) << key;
+  }
+  ht.VerifyIntegrity();
+  EXPECT_LE(ht.GetGlobalDepth(), DIRECTORY_MAX_DEPTH);
+  for (int key = 0; key < num_keys; key += 7) {
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, key, &res)) << key;
+    EXPECT_TRUE(ht.Insert(nullptr, key, key)) << key;
+  }
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// Records insert, lookup and mixed throughput for a growing number of threads that share one hash table as test
+// properties, run it with --gtest_also_run_disabled_tests --gtest_output=xml to see them
+// NOLINTNEXTLINE
+TEST(HashTableTest, DISABLED_ContentionBenchmark) {
+  const int num_keys = 40000;
+  std::vector<int> keys(num_keys);
+  for (int key = 0; key < num_keys; key++) {
+    keys[key] = key;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  for (uint64_t num_threads : {1, 2, 4, 8}) {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new BufferPoolManagerInstance(256, disk_manager);
+    ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+    auto start = std::chrono::steady_clock::now();
+    RunThreads(num_threads, [&](uint64_t thread_itr) {
+      for (size_t i = thread_itr; i < keys.size(); i += num_threads) {
+        ht.Insert(nullptr, keys[i], keys[i]);
+      }
+    });
+    auto inserted = std::chrono::steady_clock::now();
+    RunThreads(num_threads, [&](uint64_t thread_itr) {
+      std::vector<int> res;
+      for (size_t i = thread_itr; i < keys.size(); i += num_threads) {
+        res.clear();
+        ht.GetValue(nullptr, keys[i], &res);
+        EXPECT_EQ(1, res.size());
+      }
+    });
+    auto looked_up = std::chrono::steady_clock::now();
+    // every thread removes and puts back its keys while reading the others, all of it in the same buckets
+    RunThreads(num_threads, [&](uint64_t thread_itr) {
+      std::vector<int> res;
+      for (size_t i = thread_itr; i < keys.size(); i += num_threads) {
+        res.clear();
+        ht.Remove(nullptr, keys[i], keys[i]);
+        ht.Insert(nullptr, keys[i], keys[i]);
+        ht.GetValue(nullptr, keys[(i + 1) % keys.size()], &res);
+      }
+    });
+    auto mixed = std::chrono::steady_clock::now();
+    ht.VerifyIntegrity();
+
+    auto ops_per_sec = [&](auto begin, auto end, int ops) {
+      return static_cast<int>(ops / std::chrono::duration<double>(end - begin).count());
+    };
+    const std::string threads = std::to_string(num_threads);
+    RecordProperty("inserts_per_sec_" + threads, ops_per_sec(start, inserted, num_keys));
+    RecordProperty("lookups_per_sec_" + threads, ops_per_sec(inserted, looked_up, num_keys));
+    RecordProperty("mixed_ops_per_sec_" + threads, ops_per_sec(looked_up, mixed, 3 * num_keys));
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+    delete bpm;
+  }
+}
+
 }  // namespace bustub
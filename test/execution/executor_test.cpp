@@ -31,6 +31,7 @@
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/distinct_plan.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/limit_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/update_plan.h"
@@ -110,6 +111,46 @@ TEST_F(ExecutorTest, DISABLED_SimpleSeqScanTest) {
   }
 }
 
+// SELECT col_a, col_b FROM test_1 WHERE col_a < 50 (resp. col_a >= 990, 500 > col_a, col_a = 7), with an index on col_a
+TEST_F(ExecutorTest, IndexScanRangeTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("a bigint");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 8, HashFunctionType{}, IndexType::BPlusTreeIndex);
+
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  auto check_scan = [&](const AbstractExpression *predicate, int32_t first, int32_t last) {
+    IndexScanPlanNode plan{out_schema, predicate, index_info->index_oid_};
+    std::vector<Tuple> result_set{};
+    GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+
+    // the tuples come back in key order, colB is taken from the table
+    ASSERT_EQ(result_set.size(), last - first + 1);
+    for (int32_t i = first; i <= last; i++) {
+      const auto &tuple = result_set[i - first];
+      ASSERT_EQ(tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), i);
+      ASSERT_TRUE(tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>() < 10);
+    }
+  };
+
+  check_scan(MakeComparisonExpression(col_a, MakeConstantValueExpression(ValueFactory::GetIntegerValue(50)),
+                                      ComparisonType::LessThan),
+             0, 49);
+  check_scan(MakeComparisonExpression(col_a, MakeConstantValueExpression(ValueFactory::GetIntegerValue(990)),
+                                      ComparisonType::GreaterThanOrEqual),
+             990, TEST1_SIZE - 1);
+  check_scan(MakeComparisonExpression(MakeConstantValueExpression(ValueFactory::GetIntegerValue(500)), col_a,
+                                      ComparisonType::GreaterThan),
+             0, 499);
+  check_scan(MakeComparisonExpression(col_a, MakeConstantValueExpression(ValueFactory::GetIntegerValue(7)),
+                                      ComparisonType::Equal),
+             7, 7);
+  check_scan(nullptr, 0, TEST1_SIZE - 1);
+}
+
 // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
 TEST_F(ExecutorTest, DISABLED_SimpleRawInsertTest) {
   // Create Values to insert
@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <filesystem>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "common/bustub_instance.h"
@@ -23,6 +25,7 @@
 #include "storage/table/table_heap.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -31,15 +34,23 @@ class RecoveryTest : public ::testing::Test {
   // This function is called before every test.
   void SetUp() override {
     remove("test.db");
-    remove("test.log");
+    RemoveLogSegments();
   }
 
   // This function is called after every test.
   void TearDown() override {
     LOG_INFO("Tearing down the system..");
     remove("test.db");
-    remove("test.log");
+    RemoveLogSegments();
   };
+
+  static void RemoveLogSegments() {
+    for (const auto &entry : std::filesystem::directory_iterator(".")) {
+      if (entry.path().filename().string().rfind("test.log", 0) == 0) {
+        std::filesystem::remove(entry.path());
+      }
+    }
+  }
 };
 
 // NOLINTNEXTLINE
@@ -314,4 +325,317 @@ TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
   LOG_INFO("Shutdown System");
   delete bustub_instance;
 }
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, DeltaUpdateLogRecordTest) {
+  Column col1{"a", TypeId::VARCHAR, 128};
+  Column col2{"b", TypeId::INTEGER};
+  Column col3{"c", TypeId::BIGINT};
+  std::vector<Column> cols{col1, col2, col3};
+  Schema schema{cols};
+  std::string payload(100, 'x');
+  RID rid(0, 0);
+
+  // A single changed integer column is logged as a small delta.
+  Tuple old_tuple({ValueFactory::GetVarcharValue(payload), ValueFactory::GetIntegerValue(1),
+                   ValueFactory::GetBigIntValue(2)},
+                  &schema);
+  Tuple new_tuple({ValueFactory::GetVarcharValue(payload), ValueFactory::GetIntegerValue(42),
+                   ValueFactory::GetBigIntValue(2)},
+                  &schema);
+  LogRecord delta(0, INVALID_LSN, LogRecordType::DELTAUPDATE, rid, old_tuple, new_tuple);
+  EXPECT_LT(delta.GetSize(), LogRecord::FullUpdateSize(old_tuple, new_tuple) / 4);
+
+  Tuple redone = delta.ApplyDelta(old_tuple);
+  ASSERT_EQ(redone.GetLength(), new_tuple.GetLength());
+  EXPECT_EQ(std::memcmp(redone.GetData(), new_tuple.GetData(), new_tuple.GetLength()), 0);
+  Tuple undone = delta.ApplyDelta(new_tuple);
+  ASSERT_EQ(undone.GetLength(), old_tuple.GetLength());
+  EXPECT_EQ(std::memcmp(undone.GetData(), old_tuple.GetData(), old_tuple.GetLength()), 0);
+
+  // Tuples of different lengths round trip as well.
+  Tuple longer_tuple({ValueFactory::GetVarcharValue(payload + "yz"), ValueFactory::GetIntegerValue(1),
+                      ValueFactory::GetBigIntValue(2)},
+                     &schema);
+  LogRecord resize(0, INVALID_LSN, LogRecordType::DELTAUPDATE, rid, old_tuple, longer_tuple);
+  Tuple grown = resize.ApplyDelta(old_tuple);
+  ASSERT_EQ(grown.GetLength(), longer_tuple.GetLength());
+  EXPECT_EQ(std::memcmp(grown.GetData(), longer_tuple.GetData(), longer_tuple.GetLength()), 0);
+  Tuple shrunk = resize.ApplyDelta(longer_tuple);
+  ASSERT_EQ(shrunk.GetLength(), old_tuple.GetLength());
+  EXPECT_EQ(std::memcmp(shrunk.GetData(), old_tuple.GetData(), old_tuple.GetLength()), 0);
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, DeltaUpdateRecoveryTest) {
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  ASSERT_TRUE(enable_logging);
+
+  Column col1{"a", TypeId::VARCHAR, 128};
+  Column col2{"b", TypeId::INTEGER};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  std::string payload(100, 'x');
+  auto make_tuple = [&](int32_t b) {
+    return Tuple({ValueFactory::GetVarcharValue(payload), ValueFactory::GetIntegerValue(b)}, &schema);
+  };
+
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  RID rid;
+  ASSERT_TRUE(test_table->InsertTuple(make_tuple(1), &rid, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // The committed update has to be redone, the uncommitted one undone.
+  txn = bustub_instance->transaction_manager_->Begin();
+  ASSERT_TRUE(test_table->UpdateTuple(make_tuple(2), rid, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  Transaction *loser_txn = bustub_instance->transaction_manager_->Begin();
+  ASSERT_TRUE(test_table->UpdateTuple(make_tuple(3), rid, loser_txn));
+
+  LOG_INFO("System crash with the table page only in memory");
+  delete loser_txn;
+  delete test_table;
+  delete bustub_instance;
+
+  bustub_instance = new BustubInstance("test.db");
+  auto *log_recovery = new LogRecovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  ASSERT_TRUE(test_table->GetTuple(rid, &tuple, txn));
+  EXPECT_EQ(tuple.GetValue(&schema, 1).CompareEquals(ValueFactory::GetIntegerValue(2)), CmpBool::CmpTrue);
+  EXPECT_EQ(tuple.GetValue(&schema, 0).CompareEquals(ValueFactory::GetVarcharValue(payload)), CmpBool::CmpTrue);
+  bustub_instance->transaction_manager_->Commit(txn);
+
+  delete txn;
+  delete test_table;
+  delete log_recovery;
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, CheckpointTruncateTest) {
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::SMALLINT};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  Tuple tuple = ConstructTuple(&schema);
+
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  RID rid;
+  ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // Fill a few log segments with empty transactions.
+  while (bustub_instance->disk_manager_->GetLogWriteOffset() < 2 * LOG_SEGMENT_SIZE) {
+    txn = bustub_instance->transaction_manager_->Begin();
+    bustub_instance->transaction_manager_->Commit(txn);
+    delete txn;
+  }
+  EXPECT_EQ(bustub_instance->disk_manager_->GetLogStartOffset(), 0);
+
+  bustub_instance->checkpoint_manager_->BeginCheckpoint();
+  bustub_instance->checkpoint_manager_->EndCheckpoint();
+  EXPECT_EQ(bustub_instance->disk_manager_->GetLogStartOffset(), 2 * LOG_SEGMENT_SIZE);
+
+  // Work after the checkpoint is recovered from the remaining segments alone.
+  txn = bustub_instance->transaction_manager_->Begin();
+  RID rid1;
+  ASSERT_TRUE(test_table->InsertTuple(tuple, &rid1, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+
+  bustub_instance = new BustubInstance("test.db");
+  auto *log_recovery = new LogRecovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+  log_recovery->Redo();
+  log_recovery->Undo();
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple old_tuple;
+  EXPECT_TRUE(test_table->GetTuple(rid, &old_tuple, txn));
+  EXPECT_TRUE(test_table->GetTuple(rid1, &old_tuple, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+
+  delete txn;
+  delete test_table;
+  delete log_recovery;
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, RepeatedRestartTest) {
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::INTEGER};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  auto make_tuple = [&](int32_t b) {
+    return Tuple({ValueFactory::GetVarcharValue("restart"), ValueFactory::GetIntegerValue(b)}, &schema);
+  };
+
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  RID rid;
+  ASSERT_TRUE(test_table->InsertTuple(make_tuple(0), &rid, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  lsn_t last_lsn = txn->GetPrevLSN();
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+
+  // Every run recovers the runs before it, writes the recovered page out and commits one more update before it
+  // crashes. The update is only redone if its LSN is above the one the page got from the earlier runs.
+  for (int32_t round = 1; round <= 3; round++) {
+    bustub_instance = new BustubInstance("test.db");
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+    log_recovery.Redo();
+    log_recovery.Undo();
+    bustub_instance->buffer_pool_manager_->FlushAllPages();
+    bustub_instance->log_manager_->RunFlushThread();
+
+    txn = bustub_instance->transaction_manager_->Begin();
+    test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                               bustub_instance->log_manager_, first_page_id);
+    Tuple tuple;
+    ASSERT_TRUE(test_table->GetTuple(rid, &tuple, txn));
+    EXPECT_EQ(tuple.GetValue(&schema, 1).CompareEquals(ValueFactory::GetIntegerValue(round - 1)), CmpBool::CmpTrue)
+        << round;
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(round), rid, txn));
+    bustub_instance->transaction_manager_->Commit(txn);
+    EXPECT_GT(txn->GetPrevLSN(), last_lsn);
+    last_lsn = txn->GetPrevLSN();
+    delete txn;
+    delete test_table;
+    delete bustub_instance;
+  }
+
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+  log_recovery.Redo();
+  log_recovery.Undo();
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  ASSERT_TRUE(test_table->GetTuple(rid, &tuple, txn));
+  EXPECT_EQ(tuple.GetValue(&schema, 1).CompareEquals(ValueFactory::GetIntegerValue(3)), CmpBool::CmpTrue);
+  bustub_instance->transaction_manager_->Commit(txn);
+
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, AsyncCommitTest) {
+  auto saved_log_timeout = log_timeout;
+  log_timeout = std::chrono::seconds(1);
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::SMALLINT};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  Tuple tuple = ConstructTuple(&schema);
+  RID rid;
+
+  // A synchronous commit is durable when it returns.
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  EXPECT_GE(bustub_instance->log_manager_->GetPersistentLSN(), txn->GetPrevLSN());
+  delete txn;
+
+  // An asynchronous commit returns right away and becomes durable with the next timed flush.
+  txn = bustub_instance->transaction_manager_->Begin();
+  txn->SetAsyncCommit(true);
+  ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  EXPECT_LT(bustub_instance->log_manager_->GetPersistentLSN(), txn->GetPrevLSN());
+  std::this_thread::sleep_for(log_timeout + std::chrono::milliseconds(500));
+  EXPECT_GE(bustub_instance->log_manager_->GetPersistentLSN(), txn->GetPrevLSN());
+  delete txn;
+
+  delete test_table;
+  delete bustub_instance;
+  log_timeout = saved_log_timeout;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, EarlyLockReleaseTest) {
+  auto saved_log_timeout = log_timeout;
+  // no timed flushes during the test
+  log_timeout = std::chrono::seconds(15);
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::SMALLINT};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  Tuple tuple = ConstructTuple(&schema);
+
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  // The writer releases its lock as soon as the COMMIT record is appended.
+  Transaction *writer = bustub_instance->transaction_manager_->Begin();
+  writer->SetAsyncCommit(true);
+  RID rid;
+  ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, writer));
+  bustub_instance->transaction_manager_->Commit(writer);
+  EXPECT_TRUE(writer->GetExclusiveLockSet()->empty());
+  EXPECT_LT(bustub_instance->log_manager_->GetPersistentLSN(), writer->GetPrevLSN());
+
+  // A read-only transaction that does not touch the row commits without a flush.
+  Transaction *bystander = bustub_instance->transaction_manager_->Begin();
+  bustub_instance->transaction_manager_->Commit(bystander);
+  EXPECT_EQ(bystander->GetCommitDependencyLSN(), INVALID_LSN);
+  EXPECT_LT(bustub_instance->log_manager_->GetPersistentLSN(), writer->GetPrevLSN());
+
+  // A reader of the row depends on the writer, its commit returns only once the writer's commit is durable.
+  Transaction *reader = bustub_instance->transaction_manager_->Begin();
+  Tuple result;
+  ASSERT_TRUE(test_table->GetTuple(rid, &result, reader));
+  EXPECT_EQ(reader->GetCommitDependencyLSN(), writer->GetPrevLSN());
+  bustub_instance->transaction_manager_->Commit(reader);
+  EXPECT_GE(bustub_instance->log_manager_->GetPersistentLSN(), writer->GetPrevLSN());
+
+  delete writer;
+  delete bystander;
+  delete reader;
+  delete test_table;
+  delete bustub_instance;
+  log_timeout = saved_log_timeout;
+}
 }  // namespace bustub
@@ -0,0 +1,197 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree_test.cpp
+//
+// Identification: test/storage/adaptive_radix_tree_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/adaptive_radix_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+// runs random inserts and removes of the keys make_key(0..max_key) against a map of their bytes, which orders them as
+// memcmp does, and checks point queries, full scans and range scans against it as it goes
+template <size_t KeySize>
+void CheckRandomOperations(const std::function<GenericKey<KeySize>(int64_t)> &make_key, int64_t max_key) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<KeySize> comparator(key_schema.get());
+  AdaptiveRadixTree<GenericKey<KeySize>, RID, GenericComparator<KeySize>> tree(comparator);
+  EXPECT_TRUE(tree.IsEmpty());
+
+  std::map<std::string, RID> model;
+  auto bytes = [](const GenericKey<KeySize> &key) { return std::string(key.data_, KeySize); };
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<int64_t> key_dist(0, max_key);
+  for (int round = 0; round < 6; round++) {
+    // grow the tree in the even rounds and shrink it in the odd ones, so that nodes grow and shrink through each size
+    for (int i = 0; i < 4 * max_key; i++) {
+      int64_t key = key_dist(rng);
+      auto index_key = make_key(key);
+      if (rng() % 4 < (round % 2 == 0 ? 1U : 3U)) {
+        tree.Remove(index_key);
+        model.erase(bytes(index_key));
+      } else {
+        RID rid(static_cast<int32_t>(round), static_cast<uint32_t>(key));
+        bool inserted = model.emplace(bytes(index_key), rid).second;
+        EXPECT_EQ(inserted, tree.Insert(index_key, rid)) << key;
+      }
+    }
+
+    for (int64_t key = 0; key <= max_key; key++) {
+      auto index_key = make_key(key);
+      std::vector<RID> rids;
+      auto entry = model.find(bytes(index_key));
+      ASSERT_EQ(entry != model.end(), tree.GetValue(index_key, &rids)) << key;
+      if (entry != model.end()) {
+        ASSERT_EQ(1, rids.size());
+        EXPECT_EQ(entry->second, rids[0]);
+      }
+    }
+
+    std::vector<std::pair<GenericKey<KeySize>, RID>> result;
+    tree.ScanRange(nullptr, true, nullptr, true, &result);
+    ASSERT_EQ(model.size(), result.size());
+    auto entry = model.begin();
+    for (const auto &[key, rid] : result) {
+      EXPECT_EQ(entry->first, bytes(key));
+      EXPECT_EQ(entry->second, rid);
+      ++entry;
+    }
+
+    for (int scan = 0; scan < 50; scan++) {
+      auto lower = make_key(key_dist(rng));
+      auto upper = make_key(key_dist(rng));
+      bool lower_inclusive = rng() % 2 == 0;
+      bool upper_inclusive = rng() % 2 == 0;
+      bool open_lower = scan % 10 == 0;
+      result.clear();
+      tree.ScanRange(open_lower ? nullptr : &lower, lower_inclusive, &upper, upper_inclusive, &result);
+      std::vector<std::string> expected;
+      for (const auto &[key, rid] : model) {
+        bool below = key < bytes(lower) || (key == bytes(lower) && !lower_inclusive);
+        bool above = key > bytes(upper) || (key == bytes(upper) && !upper_inclusive);
+        if ((open_lower || !below) && !above) {
+          expected.push_back(key);
+        }
+      }
+      ASSERT_EQ(expected.size(), result.size());
+      for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(expected[i], bytes(result[i].first));
+      }
+    }
+  }
+
+  for (int64_t key = 0; key <= max_key; key++) {
+    tree.Remove(make_key(key));
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+}
+}  // namespace
+
+TEST(AdaptiveRadixTreeTest, InsertRemoveScanTest) {
+  // dense integer keys, whose last byte fills nodes of all sizes
+  CheckRandomOperations<8>(
+      [](int64_t key) {
+        GenericKey<8> index_key;
+        index_key.SetFromInteger(key);
+        return index_key;
+      },
+      3000);
+}
+
+TEST(AdaptiveRadixTreeTest, LongPrefixTest) {
+  // keys with a long common prefix, which differs in a byte past the ones an inner node keeps for three groups of keys,
+  // and sparse integers after it, so that prefixes are split and merged beyond the kept bytes
+  CheckRandomOperations<32>(
+      [](int64_t key) {
+        GenericKey<32> index_key;
+        memset(index_key.data_, 0x5A, sizeof(index_key.data_));
+        index_key.data_[ART_PREFIX_SIZE + 3] = static_cast<char>(key % 3);
+        int64_t value = (key / 3) * 7919;
+        for (int i = 0; i < 8; i++) {
+          index_key.data_[16 + i] = static_cast<char>(value >> (56 - 8 * i));
+        }
+        return index_key;
+      },
+      2000);
+}
+
+TEST(AdaptiveRadixTreeTest, ConcurrentTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  AdaptiveRadixTree<GenericKey<8>, RID, GenericComparator<8>> tree(comparator);
+
+  // writers insert, then delete the odd keys of their share, while readers look up the even keys already in and scan
+  const int64_t num_keys = 20000;
+  const uint64_t num_writers = 4;
+  std::vector<std::thread> threads;
+  for (uint64_t thread_itr = 0; thread_itr < num_writers; thread_itr++) {
+    threads.emplace_back([&tree, thread_itr, num_keys, num_writers] {
+      GenericKey<8> index_key;
+      for (int64_t key = static_cast<int64_t>(thread_itr); key < num_keys; key += num_writers) {
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, RID(0, key));
+      }
+      for (int64_t key = static_cast<int64_t>(thread_itr); key < num_keys; key += num_writers) {
+        if (key % 2 == 1) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key);
+        }
+      }
+    });
+  }
+  threads.emplace_back([&tree] {
+    for (int i = 0; i < 20; i++) {
+      std::vector<std::pair<GenericKey<8>, RID>> result;
+      tree.ScanRange(nullptr, true, nullptr, true, &result);
+      for (size_t j = 1; j < result.size(); j++) {
+        EXPECT_LT(result[j - 1].first.ToString(), result[j].first.ToString());
+      }
+    }
+  });
+  for (int reader = 0; reader < 2; reader++) {
+    threads.emplace_back([&tree, num_keys] {
+      // an even key is never deleted, so once it is found it stays
+      GenericKey<8> index_key;
+      std::vector<bool> seen(num_keys);
+      for (int round = 0; round < 5; round++) {
+        for (int64_t key = 0; key < num_keys; key += 2) {
+          index_key.SetFromInteger(key);
+          std::vector<RID> rids;
+          bool found = tree.GetValue(index_key, &rids);
+          EXPECT_TRUE(found || !seen[key]) << key;
+          seen[key] = seen[key] || found;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<std::pair<GenericKey<8>, RID>> result;
+  tree.ScanRange(nullptr, true, nullptr, true, &result);
+  ASSERT_EQ(num_keys / 2, result.size());
+  for (int64_t i = 0; i < num_keys / 2; i++) {
+    EXPECT_EQ(2 * i, result[i].first.ToString());
+    EXPECT_EQ(2 * i, result[i].second.GetSlotNum());
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,187 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_epsilon_tree_test.cpp
+//
+// Identification: test/storage/b_epsilon_tree_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_epsilon_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using BEpsilonTreeType = BEpsilonTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+namespace {
+// checks the point queries of every key up to max_key, and a scan from the first key and from key start, against model
+void CheckTree(BEpsilonTreeType *tree, const std::map<int64_t, RID> &model, int64_t max_key, int64_t start) {
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key <= max_key; key++) {
+    index_key.SetFromInteger(key);
+    std::vector<RID> rids;
+    auto entry = model.find(key);
+    ASSERT_EQ(entry != model.end(), tree->GetValue(index_key, &rids)) << key;
+    if (entry != model.end()) {
+      ASSERT_EQ(1, rids.size());
+      EXPECT_EQ(entry->second, rids[0]) << key;
+    }
+  }
+
+  auto entry = model.begin();
+  for (auto it = tree->Begin(); !it.IsEnd(); ++it, ++entry) {
+    ASSERT_NE(model.end(), entry);
+    EXPECT_EQ(entry->first, (*it).first.ToString());
+    EXPECT_EQ(entry->second, (*it).second);
+  }
+  EXPECT_EQ(model.end(), entry);
+
+  index_key.SetFromInteger(start);
+  entry = model.lower_bound(start);
+  for (auto it = tree->Begin(index_key); !it.IsEnd(); ++it, ++entry) {
+    ASSERT_NE(model.end(), entry);
+    EXPECT_EQ(entry->first, (*it).first.ToString());
+  }
+  EXPECT_EQ(model.end(), entry);
+}
+}  // namespace
+
+TEST(BEpsilonTreeTest, InsertRemoveScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // small pages and buffers, so that flushes cascade over several levels and split nodes on the way
+  BEpsilonTreeType tree("foo_pk", bpm, comparator, 4, 4, 3);
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_THROW(BEpsilonTreeType("bar_pk", bpm, comparator, 4, PAGE_SIZE / 8, 3), Exception);
+
+  // random inserts and deletes of the keys up to max_key, checked against a map as they go. An insert of a key that is
+  // there, in a buffer or in a leaf, fails and leaves its value
+  const int64_t max_key = 1500;
+  std::map<int64_t, RID> model;
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<int64_t> key_dist(0, max_key);
+  GenericKey<8> index_key;
+  for (int round = 0; round < 4; round++) {
+    for (int i = 0; i < 3000; i++) {
+      int64_t key = key_dist(rng);
+      index_key.SetFromInteger(key);
+      if (rng() % 3 == 0) {
+        tree.Remove(index_key);
+        model.erase(key);
+      } else {
+        RID rid(static_cast<int32_t>(rng() % 100), static_cast<uint32_t>(key));
+        EXPECT_EQ(model.count(key) == 0, tree.Insert(index_key, rid)) << key;
+        model.emplace(key, rid);
+      }
+    }
+    CheckTree(&tree, model, max_key, key_dist(rng));
+  }
+  EXPECT_FALSE(tree.IsEmpty());
+
+  // once everything is deleted the point queries find nothing from the buffers or the leaves
+  for (int64_t key = 0; key <= max_key; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  model.clear();
+  CheckTree(&tree, model, max_key, 0);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BEpsilonTreeTest, ConcurrentTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  BEpsilonTreeType tree("foo_pk", bpm, comparator, 8, 6, 16);
+
+  // writers insert, then delete the odd keys of their share, while readers look up the even keys already in and scan
+  const int64_t num_keys = 4000;
+  const uint64_t num_writers = 4;
+  std::vector<std::thread> threads;
+  for (uint64_t thread_itr = 0; thread_itr < num_writers; thread_itr++) {
+    threads.emplace_back([&tree, thread_itr, num_keys, num_writers] {
+      GenericKey<8> index_key;
+      for (int64_t key = static_cast<int64_t>(thread_itr); key < num_keys; key += num_writers) {
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, RID(0, key));
+      }
+      for (int64_t key = static_cast<int64_t>(thread_itr); key < num_keys; key += num_writers) {
+        if (key % 2 == 1) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key);
+        }
+      }
+    });
+  }
+  threads.emplace_back([&tree] {
+    for (int i = 0; i < 20; i++) {
+      int64_t last = -1;
+      for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+        EXPECT_LT(last, (*it).first.ToString());
+        last = (*it).first.ToString();
+      }
+    }
+  });
+  for (int reader = 0; reader < 2; reader++) {
+    threads.emplace_back([&tree, num_keys] {
+      // an even key is never deleted, so once it is found it stays
+      GenericKey<8> index_key;
+      std::vector<bool> seen(num_keys);
+      for (int round = 0; round < 5; round++) {
+        for (int64_t key = 0; key < num_keys; key += 2) {
+          index_key.SetFromInteger(key);
+          std::vector<RID> rids;
+          bool found = tree.GetValue(index_key, &rids);
+          EXPECT_TRUE(found || !seen[key]) << key;
+          seen[key] = seen[key] || found;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int64_t key = 0;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it, key += 2) {
+    EXPECT_EQ(key, (*it).first.ToString());
+    EXPECT_EQ(key, (*it).second.GetSlotNum());
+  }
+  EXPECT_EQ(num_keys, key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
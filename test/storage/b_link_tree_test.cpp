@@ -0,0 +1,178 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_link_tree_test.cpp
+//
+// Identification: test/storage/b_link_tree_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_link_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using BLinkTreeType = BLinkTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+namespace {
+// insert or remove the keys that belong to thread thread_itr out of total_threads
+void ApplyHelperSplit(BLinkTreeType *tree, const std::vector<int64_t> &keys, bool insert, uint64_t total_threads,
+                      uint64_t thread_itr) {
+  GenericKey<8> index_key;
+  RID rid;
+  for (auto key : keys) {
+    if (static_cast<uint64_t>(key) % total_threads != thread_itr) {
+      continue;
+    }
+    index_key.SetFromInteger(key);
+    if (insert) {
+      rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+      tree->Insert(index_key, rid);
+    } else {
+      tree->Remove(index_key);
+    }
+  }
+}
+}  // namespace
+
+TEST(BLinkTreeTest, InsertRemoveScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  BLinkTreeType tree("foo_pk", bpm, comparator, 3, 3);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  EXPECT_TRUE(tree.IsEmpty());
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 500; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  GenericKey<8> index_key;
+  RID rid;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    rid.Set(0, key);
+    EXPECT_TRUE(tree.Insert(index_key, rid));
+  }
+  index_key.SetFromInteger(7);
+  EXPECT_FALSE(tree.Insert(index_key, rid));
+
+  for (int64_t key = 1; key <= 500; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 500; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key % 2 == 0, tree.GetValue(index_key, &rids)) << key;
+  }
+
+  int64_t expected = 100;
+  index_key.SetFromInteger(99);
+  for (auto iterator = tree.Begin(index_key); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(expected, (*iterator).second.GetSlotNum());
+    expected += 2;
+  }
+  EXPECT_EQ(502, expected);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Concurrent inserts, removals and lookups on small nodes, so that splits cascade up to new roots while readers and
+// writers are moving right past them
+TEST(BLinkTreeTest, ConcurrentMixTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(1024, disk_manager);
+  BLinkTreeType tree("foo_pk", bpm, comparator, 4, 4);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t scale_factor = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  std::vector<std::thread> threads;
+  for (uint64_t i = 0; i < 4; i++) {
+    threads.emplace_back(ApplyHelperSplit, &tree, keys, true, 4, i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // even keys go away while keys above scale_factor come in and odd keys are looked up
+  std::vector<int64_t> remove_keys;
+  std::vector<int64_t> new_keys;
+  for (int64_t key = 2; key <= scale_factor; key += 2) {
+    remove_keys.push_back(key);
+  }
+  for (int64_t key = scale_factor + 1; key <= 2 * scale_factor; key++) {
+    new_keys.push_back(key);
+  }
+  threads.clear();
+  for (uint64_t i = 0; i < 2; i++) {
+    threads.emplace_back(ApplyHelperSplit, &tree, remove_keys, false, 2, i);
+    threads.emplace_back(ApplyHelperSplit, &tree, new_keys, true, 2, i);
+    threads.emplace_back([&tree, scale_factor] {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int64_t key = 1; key <= scale_factor; key += 2) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.GetValue(index_key, &rids)) << key;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 2 * scale_factor; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, &rids);
+    EXPECT_EQ(key <= scale_factor && key % 2 == 0 ? 0 : 1, rids.size()) << key;
+  }
+  int64_t expected = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(expected, (*iterator).second.GetSlotNum());
+    expected += expected < scale_factor ? 2 : 1;
+  }
+  EXPECT_EQ(2 * scale_factor + 1, expected);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
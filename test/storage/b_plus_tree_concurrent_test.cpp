@@ -10,10 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
+#include <limits>
+#include <random>
+#include <set>
+#include <string>
 #include <thread>  // NOLINT
+#include <utility>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -333,4 +339,762 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   remove("test.log");
 }
 
+// Concurrent inserts and deletes on small nodes, so that splits, merges and root changes race with each other
+TEST(BPlusTreeConcurrentTest, MixSmallNodesTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t scale_factor = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+  }
+  LaunchParallelTest(4, InsertHelperSplit, &tree, keys, 4);
+
+  // even keys go away while keys above scale_factor come in
+  std::vector<int64_t> remove_keys;
+  std::vector<int64_t> new_keys;
+  for (int64_t key = 2; key <= scale_factor; key += 2) {
+    remove_keys.push_back(key);
+  }
+  for (int64_t key = scale_factor + 1; key <= 2 * scale_factor; key++) {
+    new_keys.push_back(key);
+  }
+  std::vector<std::thread> threads;
+  for (uint64_t i = 0; i < 2; i++) {
+    threads.emplace_back(DeleteHelperSplit, &tree, remove_keys, 2, i);
+    threads.emplace_back(InsertHelperSplit, &tree, new_keys, 2, i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 2 * scale_factor; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, &rids);
+    EXPECT_EQ(key <= scale_factor && key % 2 == 0 ? 0 : 1, rids.size()) << key;
+  }
+  int64_t expected = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(expected, (*iterator).second.GetSlotNum());
+    expected += expected < scale_factor ? 2 : 1;
+  }
+  EXPECT_EQ(2 * scale_factor + 1, expected);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Mixed inserts, removes and lookups on small nodes with the top levels pinned, which grow and shrink under them
+TEST(BPlusTreeConcurrentTest, PinnedUpperLevelsTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  const size_t pool_size = 128;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  tree.PinUpperLevels(3);
+
+  const int64_t scale_factor = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+  }
+  LaunchParallelTest(4, InsertHelperSplit, &tree, keys, 4);
+
+  // odd keys are looked up while even keys go away, then come back
+  std::vector<int64_t> remove_keys;
+  for (int64_t key = 2; key <= scale_factor; key += 2) {
+    remove_keys.push_back(key);
+  }
+  std::vector<std::thread> threads;
+  for (uint64_t i = 0; i < 2; i++) {
+    threads.emplace_back([&, i]() {
+      DeleteHelperSplit(&tree, remove_keys, 2, i);
+      InsertHelperSplit(&tree, remove_keys, 2, i);
+    });
+    threads.emplace_back([&, i]() {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int64_t key = 1 + 2 * static_cast<int64_t>(i); key <= scale_factor; key += 4) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.GetValue(index_key, &rids)) << key;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  DeleteHelper(&tree, remove_keys);
+
+  int64_t expected = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(expected, (*iterator).second.GetSlotNum());
+    expected += 2;
+  }
+  EXPECT_EQ(scale_factor + 1, expected);
+
+  // no page stays pinned once the upper levels are released
+  tree.PinUpperLevels(0);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  for (size_t i = 0; i < pool_size; i++) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Compaction running alongside lookups and inserts, on a tree left sparse by removes
+TEST(BPlusTreeConcurrentTest, CompactTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(1000, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 16, 8);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // the leaves in key order, and the height of the tree
+  auto leaves = [&]() {
+    std::vector<page_id_t> page_ids;
+    GenericKey<8> index_key;
+    Page *page = tree.FindLeafPage(index_key, true);
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    page_id_t parent_page_id = node->GetParentPageId();
+    while (page != nullptr) {
+      auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(page->GetData());
+      page_ids.push_back(page->GetPageId());
+      page_id_t next_page_id = leaf->GetNextPageId();
+      bpm->UnpinPage(page->GetPageId(), false);
+      page = next_page_id == INVALID_PAGE_ID ? nullptr : bpm->FetchPage(next_page_id);
+    }
+    int height = 1;
+    while (parent_page_id != INVALID_PAGE_ID) {
+      page = bpm->FetchPage(parent_page_id);
+      parent_page_id = reinterpret_cast<BPlusTreePage *>(page->GetData())->GetParentPageId();
+      bpm->UnpinPage(page->GetPageId(), false);
+      height++;
+    }
+    return std::make_pair(page_ids, height);
+  };
+
+  const int64_t scale_factor = 1500;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+  // the leaves of ascending inserts are half full, and stay so as two thirds of the keys go away
+  std::vector<int64_t> remove_keys;
+  std::vector<int64_t> kept_keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    (key % 3 == 0 ? kept_keys : remove_keys).push_back(key);
+  }
+  DeleteHelper(&tree, remove_keys);
+  auto [sparse_leaves, sparse_height] = leaves();
+
+  std::vector<int64_t> new_keys;
+  for (int64_t key = scale_factor + 1; key <= scale_factor + 100; key++) {
+    new_keys.push_back(key);
+  }
+  std::vector<std::thread> threads;
+  threads.emplace_back([&]() { tree.Compact(); });
+  threads.emplace_back([&]() { InsertHelper(&tree, new_keys); });
+  for (uint64_t i = 0; i < 2; i++) {
+    threads.emplace_back([&, i]() {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (size_t j = i; j < kept_keys.size(); j += 2) {
+        rids.clear();
+        index_key.SetFromInteger(kept_keys[j]);
+        EXPECT_TRUE(tree.GetValue(index_key, &rids)) << kept_keys[j];
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // once more without other work, the leaves then follow each other on disk but where the pages the inserts took
+  // are left out
+  tree.Compact();
+  auto [packed_leaves, packed_height] = leaves();
+  const int64_t size = kept_keys.size() + new_keys.size();
+  EXPECT_LE(static_cast<int64_t>(packed_leaves.size()), size / 12);
+  EXPECT_LT(packed_height, sparse_height);
+  size_t breaks = 0;
+  for (size_t i = 1; i < packed_leaves.size(); i++) {
+    breaks += packed_leaves[i - 1] + 1 == packed_leaves[i] ? 0 : 1;
+  }
+  EXPECT_LE(breaks, packed_leaves.size() / 4);
+
+  int64_t count = 0;
+  int64_t previous = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    int64_t key = (*iterator).second.GetSlotNum();
+    EXPECT_TRUE(key % 3 == 0 || key > scale_factor) << key;
+    EXPECT_LT(previous, key);
+    previous = key;
+    count++;
+  }
+  EXPECT_EQ(size, count);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Background compaction paced by an interval, with lookups and inserts running against it
+TEST(BPlusTreeConcurrentTest, BackgroundCompactionTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(1000, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 16, 8);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // the number of leaves, read while the compaction is stopped
+  auto count_leaves = [&]() {
+    GenericKey<8> index_key{};
+    Page *page = tree.FindLeafPage(index_key, true);
+    int count = 0;
+    while (page != nullptr) {
+      auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(page->GetData());
+      page_id_t next_page_id = leaf->GetNextPageId();
+      bpm->UnpinPage(page->GetPageId(), false);
+      page = next_page_id == INVALID_PAGE_ID ? nullptr : bpm->FetchPage(next_page_id);
+      count++;
+    }
+    return count;
+  };
+
+  const int64_t scale_factor = 1500;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+  std::vector<int64_t> remove_keys;
+  std::vector<int64_t> kept_keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    (key % 3 == 0 ? kept_keys : remove_keys).push_back(key);
+  }
+  DeleteHelper(&tree, remove_keys);
+  int sparse_leaves = count_leaves();
+
+  tree.StartCompaction(std::chrono::milliseconds(1));
+  // a second start leaves the running compaction alone
+  tree.StartCompaction(std::chrono::milliseconds(1));
+  std::vector<int64_t> new_keys;
+  for (int64_t key = scale_factor + 1; key <= scale_factor + 100; key++) {
+    new_keys.push_back(key);
+  }
+  std::vector<std::thread> threads;
+  threads.emplace_back([&]() { InsertHelper(&tree, new_keys); });
+  threads.emplace_back([&]() {
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    for (int round = 0; round < 20; round++) {
+      for (int64_t key : kept_keys) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.GetValue(index_key, &rids)) << key;
+      }
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // stopped and started again until a pass went over the sparse leaves
+  const int64_t size = kept_keys.size() + new_keys.size();
+  int packed_leaves = sparse_leaves;
+  for (int attempt = 0; attempt < 100; attempt++) {
+    tree.StopCompaction();
+    packed_leaves = count_leaves();
+    if (packed_leaves <= size / 12) {
+      break;
+    }
+    tree.StartCompaction(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  tree.StopCompaction();
+  EXPECT_LT(packed_leaves, sparse_leaves);
+  EXPECT_LE(packed_leaves, size / 12);
+
+  int64_t count = 0;
+  int64_t previous = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    int64_t key = (*iterator).second.GetSlotNum();
+    EXPECT_TRUE(key % 3 == 0 || key > scale_factor) << key;
+    EXPECT_LT(previous, key);
+    previous = key;
+    count++;
+  }
+  EXPECT_EQ(size, count);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Concurrent batched inserts of interleaved keys on small nodes, with batched lookups racing with them
+TEST(BPlusTreeConcurrentTest, BatchTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 8);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // thread i inserts the keys that are i modulo num_threads, in sorted batches
+  const int64_t scale_factor = 4000;
+  const int64_t num_threads = 4;
+  const int64_t batch_size = 64;
+  auto insert_batches = [&](int64_t thread_itr) {
+    std::vector<std::pair<GenericKey<8>, RID>> batch;
+    GenericKey<8> index_key;
+    for (int64_t key = thread_itr + 1; key <= scale_factor; key += num_threads) {
+      index_key.SetFromInteger(key);
+      batch.emplace_back(index_key, RID(0, key));
+      if (static_cast<int64_t>(batch.size()) == batch_size || key + num_threads > scale_factor) {
+        EXPECT_EQ(batch.size(), tree.InsertBatch(batch));
+        batch.clear();
+      }
+    }
+  };
+  // a key that is found must carry its own RID
+  auto lookup_batches = [&]() {
+    std::vector<GenericKey<8>> keys;
+    std::vector<std::vector<RID>> results;
+    GenericKey<8> index_key;
+    for (int64_t key = 1; key <= scale_factor; key++) {
+      index_key.SetFromInteger(key);
+      keys.push_back(index_key);
+      if (static_cast<int64_t>(keys.size()) == batch_size || key == scale_factor) {
+        tree.GetValues(keys, &results);
+        for (size_t i = 0; i < keys.size(); i++) {
+          ASSERT_GE(1, results[i].size());
+          if (!results[i].empty()) {
+            EXPECT_EQ(keys[i].ToString(), results[i][0].GetSlotNum());
+          }
+        }
+        keys.clear();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int64_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(insert_batches, i);
+  }
+  threads.emplace_back(lookup_batches);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // odd keys beyond the inserted ones are missing, a batch that repeats every key inserts nothing new
+  std::vector<GenericKey<8>> keys;
+  std::vector<std::pair<GenericKey<8>, RID>> pairs;
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= scale_factor + 100; key++) {
+    index_key.SetFromInteger(key);
+    keys.push_back(index_key);
+    if (key <= scale_factor || key % 2 == 0) {
+      pairs.emplace_back(index_key, RID(0, key));
+    }
+  }
+  EXPECT_EQ(50, tree.InsertBatch(pairs));
+  std::vector<std::vector<RID>> results;
+  tree.GetValues(keys, &results);
+  ASSERT_EQ(keys.size(), results.size());
+  for (int64_t key = 1; key <= scale_factor + 100; key++) {
+    bool present = key <= scale_factor || key % 2 == 0;
+    ASSERT_EQ(present ? 1 : 0, results[key - 1].size()) << key;
+    if (present) {
+      EXPECT_EQ(key, results[key - 1][0].GetSlotNum());
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, RangeScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  // a pool much smaller than the tree, so that pins left behind by a scan would run it dry
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 8);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t scale_factor = 2000;
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= scale_factor; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key));
+  }
+
+  // collects the keys in range, which must be the odd ones in [first, last] while even keys may come and go
+  auto scan = [&](const int64_t *lower, bool lower_inclusive, const int64_t *upper, bool upper_inclusive,
+                  int prefetch_size, int64_t first, int64_t last) {
+    GenericKey<8> lower_key;
+    GenericKey<8> upper_key;
+    if (lower != nullptr) {
+      lower_key.SetFromInteger(*lower);
+    }
+    if (upper != nullptr) {
+      upper_key.SetFromInteger(*upper);
+    }
+    std::vector<int64_t> odd_keys;
+    int64_t previous = 0;
+    for (auto iterator = tree.BeginRange(lower != nullptr ? &lower_key : nullptr, lower_inclusive,
+                                         upper != nullptr ? &upper_key : nullptr, upper_inclusive, prefetch_size);
+         !iterator.IsEnd(); ++iterator) {
+      int64_t key = (*iterator).first.ToString();
+      EXPECT_LT(previous, key);
+      previous = key;
+      if (key % 2 == 1) {
+        odd_keys.push_back(key);
+      }
+    }
+    std::vector<int64_t> expected;
+    for (int64_t key = first + (first % 2 == 0 ? 1 : 0); key <= last; key += 2) {
+      expected.push_back(key);
+    }
+    EXPECT_EQ(expected, odd_keys);
+  };
+  auto check_scans = [&](int prefetch_size) {
+    const int64_t from = 101;
+    const int64_t to = 1501;
+    scan(&from, true, &to, true, prefetch_size, 101, 1501);
+    scan(&from, false, &to, false, prefetch_size, 103, 1499);
+    scan(nullptr, true, &to, false, prefetch_size, 1, 1499);
+    scan(&from, true, nullptr, true, prefetch_size, 101, scale_factor);
+    scan(nullptr, true, nullptr, true, prefetch_size, 1, scale_factor);
+    scan(&to, false, &from, true, prefetch_size, 1, 0);
+  };
+  for (int prefetch_size : {0, 1, INDEX_SCAN_PREFETCH_SIZE, 16}) {
+    check_scans(prefetch_size);
+  }
+
+  // scans run next to a thread that inserts and removes the even keys
+  std::thread writer([&]() {
+    GenericKey<8> even_key;
+    for (int round = 0; round < 2; round++) {
+      for (int64_t key = 2; key <= scale_factor; key += 2) {
+        even_key.SetFromInteger(key);
+        tree.Insert(even_key, RID(0, key));
+      }
+      for (int64_t key = 2; key <= scale_factor; key += 2) {
+        even_key.SetFromInteger(key);
+        tree.Remove(even_key);
+      }
+    }
+  });
+  for (int i = 0; i < 4; i++) {
+    check_scans(INDEX_SCAN_PREFETCH_SIZE);
+  }
+  writer.join();
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, ReverseScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 8);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  GenericKey<8> index_key;
+  EXPECT_TRUE(tree.RBegin().IsEnd());
+
+  // multiples of 3 in [3, 3000], minus the ones in (900, 1200], so that separators outlive the keys they came from
+  const int64_t scale_factor = 3000;
+  std::set<int64_t> keys;
+  for (int64_t key = 3; key <= scale_factor; key += 3) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key));
+    keys.insert(key);
+  }
+  for (int64_t key = 903; key <= 1200; key += 3) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+    keys.erase(key);
+  }
+
+  // collects the keys of a descending scan that are multiples of 3 and checks that they come in descending order
+  auto scan = [&](const int64_t *from) {
+    std::vector<int64_t> seen;
+    int64_t previous = std::numeric_limits<int64_t>::max();
+    GenericKey<8> from_key;
+    if (from != nullptr) {
+      from_key.SetFromInteger(*from);
+    }
+    for (auto iterator = from != nullptr ? tree.RBegin(from_key) : tree.RBegin(); !iterator.IsEnd(); ++iterator) {
+      int64_t key = (*iterator).first.ToString();
+      EXPECT_GT(previous, key);
+      EXPECT_EQ(key, (*iterator).second.GetSlotNum());
+      previous = key;
+      if (key % 3 == 0) {
+        seen.push_back(key);
+      }
+    }
+    return seen;
+  };
+  auto expected_from = [&](int64_t from) {
+    std::vector<int64_t> expected;
+    for (auto it = keys.upper_bound(from); it != keys.begin();) {
+      expected.push_back(*--it);
+    }
+    return expected;
+  };
+  auto check_scans = [&]() {
+    EXPECT_EQ(std::vector<int64_t>(keys.rbegin(), keys.rend()), scan(nullptr));
+    for (int64_t from : {int64_t{0}, int64_t{3}, int64_t{4}, int64_t{900}, int64_t{1000}, int64_t{1200},
+                         int64_t{1201}, int64_t{2999}, scale_factor, scale_factor + 10}) {
+      EXPECT_EQ(expected_from(from), scan(&from)) << from;
+    }
+  };
+  check_scans();
+
+  // scans run next to a thread that inserts and removes the keys that are not multiples of 3
+  std::thread writer([&]() {
+    GenericKey<8> other_key;
+    for (int round = 0; round < 2; round++) {
+      for (int64_t key = 1; key <= scale_factor; key++) {
+        if (key % 3 != 0) {
+          other_key.SetFromInteger(key);
+          tree.Insert(other_key, RID(0, key));
+        }
+      }
+      for (int64_t key = 1; key <= scale_factor; key++) {
+        if (key % 3 != 0) {
+          other_key.SetFromInteger(key);
+          tree.Remove(other_key);
+        }
+      }
+    }
+  });
+  for (int i = 0; i < 4; i++) {
+    check_scans();
+  }
+  writer.join();
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Snapshots keep the keys they were taken with while removes, inserts, range removes and compaction change the tree
+TEST(BPlusTreeConcurrentTest, SnapshotTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  // a small pool, so that pins the snapshots leak or their copies left behind run it out
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 6);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  EXPECT_TRUE(tree.Snapshot()->IsEmpty());
+  const int64_t scale_factor = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  // the snapshot holds exactly the keys of expected, by point queries and by scans from the start and from a key
+  auto check_snapshot = [](const auto &snapshot, const std::set<int64_t> &expected, int64_t max_key) {
+    GenericKey<8> index_key;
+    for (int64_t key = 1; key <= max_key; key += 7) {
+      std::vector<RID> rids;
+      index_key.SetFromInteger(key);
+      ASSERT_EQ(expected.count(key) != 0, snapshot->GetValue(index_key, &rids)) << key;
+    }
+    auto entry = expected.begin();
+    for (auto iterator = snapshot->Begin(); !iterator.IsEnd(); ++iterator, ++entry) {
+      ASSERT_NE(expected.end(), entry);
+      EXPECT_EQ(*entry, (*iterator).second.GetSlotNum());
+    }
+    EXPECT_EQ(expected.end(), entry);
+    index_key.SetFromInteger(max_key / 2);
+    entry = expected.lower_bound(max_key / 2);
+    for (auto iterator = snapshot->Begin(index_key); !iterator.IsEnd(); ++iterator, ++entry) {
+      ASSERT_NE(expected.end(), entry);
+      EXPECT_EQ(*entry, (*iterator).first.ToString());
+    }
+    EXPECT_EQ(expected.end(), entry);
+  };
+
+  std::set<int64_t> original(keys.begin(), keys.end());
+  auto snapshot = tree.Snapshot();
+  EXPECT_FALSE(snapshot->IsEmpty());
+  check_snapshot(snapshot, original, scale_factor);
+
+  // writers remove the odd keys, add keys above the original ones and remove a range, while the snapshot is scanned
+  std::vector<int64_t> odd_keys;
+  std::vector<int64_t> new_keys;
+  for (int64_t key = 1; key <= scale_factor; key += 2) {
+    odd_keys.push_back(key);
+    new_keys.push_back(scale_factor + key);
+  }
+  std::vector<std::thread> threads;
+  threads.emplace_back([&]() { DeleteHelper(&tree, odd_keys); });
+  threads.emplace_back([&]() { InsertHelper(&tree, new_keys); });
+  threads.emplace_back([&]() {
+    GenericKey<8> lower;
+    GenericKey<8> upper;
+    lower.SetFromInteger(500);
+    upper.SetFromInteger(800);
+    tree.RemoveRange(lower, upper);
+  });
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back([&]() { check_snapshot(snapshot, original, scale_factor); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  tree.Compact();
+
+  std::set<int64_t> current;
+  for (int64_t key = 2; key <= scale_factor; key += 2) {
+    if (key < 500 || key >= 800) {
+      current.insert(key);
+    }
+  }
+  current.insert(new_keys.begin(), new_keys.end());
+  check_snapshot(snapshot, original, 2 * scale_factor);
+  check_snapshot(tree.Snapshot(), current, 2 * scale_factor);
+  int64_t count = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator, count++) {
+    EXPECT_EQ(1, current.count((*iterator).second.GetSlotNum()));
+  }
+  EXPECT_EQ(static_cast<int64_t>(current.size()), count);
+
+  // a second snapshot shares the copies made from then on with the first, and either one goes away on its own
+  auto second = tree.Snapshot();
+  std::vector<int64_t> current_keys(current.begin(), current.end());
+  DeleteHelper(&tree, current_keys);
+  EXPECT_TRUE(tree.IsEmpty());
+  check_snapshot(second, current, 2 * scale_factor);
+  check_snapshot(snapshot, original, 2 * scale_factor);
+  snapshot.reset();
+  check_snapshot(second, current, 2 * scale_factor);
+  second.reset();
+
+  InsertHelper(&tree, keys);
+  check_snapshot(tree.Snapshot(), original, scale_factor);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Records insert and lookup throughput for a growing number of threads as test properties, run it with
+// --gtest_also_run_disabled_tests --gtest_output=xml to see them
+TEST(BPlusTreeConcurrentTest, DISABLED_ThroughputBenchmark) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const int64_t num_keys = 20000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  for (uint64_t num_threads : {1, 2, 4, 8}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(512, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    auto start = std::chrono::steady_clock::now();
+    LaunchParallelTest(num_threads, InsertHelperSplit, &tree, keys, num_threads);
+    auto inserted = std::chrono::steady_clock::now();
+    LaunchParallelTest(num_threads, [&](uint64_t thread_itr) {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (auto key : keys) {
+        if (static_cast<uint64_t>(key) % num_threads == thread_itr) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          tree.GetValue(index_key, &rids);
+          EXPECT_EQ(1, rids.size());
+        }
+      }
+    });
+    auto looked_up = std::chrono::steady_clock::now();
+
+    auto ops_per_sec = [&](auto begin, auto end) {
+      return static_cast<int>(num_keys / std::chrono::duration<double>(end - begin).count());
+    };
+    const std::string threads = std::to_string(num_threads);
+    RecordProperty("inserts_per_sec_" + threads, ops_per_sec(start, inserted));
+    RecordProperty("lookups_per_sec_" + threads, ops_per_sec(inserted, looked_up));
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
 }  // namespace bustub
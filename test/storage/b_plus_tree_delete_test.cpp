@@ -12,14 +12,74 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 #include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
+namespace {
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// checks that the pages below page_id point to their parent and are at least half full unless they are the root, and
+// returns the height of the subtree, which must be the same for all the children of a page
+template <size_t KeySize>
+int CheckSubtree(BufferPoolManager *bpm, page_id_t page_id, page_id_t parent_page_id) {
+  Page *page = bpm->FetchPage(page_id);
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  EXPECT_EQ(parent_page_id, node->GetParentPageId()) << page_id;
+  if (parent_page_id != INVALID_PAGE_ID) {
+    EXPECT_GE(node->GetSize(), node->GetMinSize()) << page_id;
+  }
+  int height = 1;
+  if (!node->IsLeafPage()) {
+    auto *internal =
+        reinterpret_cast<BPlusTreeInternalPage<GenericKey<KeySize>, page_id_t, GenericComparator<KeySize>> *>(node);
+    int child_height = CheckSubtree<KeySize>(bpm, internal->ValueAt(0), page_id);
+    for (int i = 1; i < internal->GetSize(); i++) {
+      EXPECT_EQ(child_height, CheckSubtree<KeySize>(bpm, internal->ValueAt(i), page_id));
+    }
+    height += child_height;
+  }
+  bpm->UnpinPage(page_id, false);
+  return height;
+}
+
+// checks the structure of the tree and that it holds the keys of model, in order
+void CheckTree(Tree *tree, BufferPoolManager *bpm, const std::set<int64_t> &model) {
+  if (model.empty()) {
+    EXPECT_TRUE(tree->IsEmpty());
+    return;
+  }
+  GenericKey<8> index_key;
+  Page *page = tree->FindLeafPage(index_key, true);
+  page_id_t root_page_id = page->GetPageId();
+  page_id_t parent_page_id = reinterpret_cast<BPlusTreePage *>(page->GetData())->GetParentPageId();
+  bpm->UnpinPage(root_page_id, false);
+  while (parent_page_id != INVALID_PAGE_ID) {
+    root_page_id = parent_page_id;
+    page = bpm->FetchPage(root_page_id);
+    parent_page_id = reinterpret_cast<BPlusTreePage *>(page->GetData())->GetParentPageId();
+    bpm->UnpinPage(root_page_id, false);
+  }
+  CheckSubtree<8>(bpm, root_page_id, INVALID_PAGE_ID);
+
+  auto expected = model.begin();
+  for (auto iterator = tree->Begin(); iterator != tree->End(); ++iterator, ++expected) {
+    ASSERT_NE(model.end(), expected);
+    EXPECT_EQ(*expected, (*iterator).second.GetSlotNum());
+  }
+  EXPECT_EQ(model.end(), expected);
+}
+}  // namespace
+
 TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
@@ -175,4 +235,161 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
   remove("test.db");
   remove("test.log");
 }
+
+// Range removals of various widths on small nodes, checked against a model of the keys
+TEST(BPlusTreeTests, RemoveRangeTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(1000, disk_manager);
+  Tree tree("foo_pk", bpm, comparator, 4, 4);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t scale_factor = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(5));
+  std::set<int64_t> model;
+  GenericKey<8> index_key;
+  RID rid;
+  for (auto key : keys) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid);
+    model.insert(key);
+  }
+
+  GenericKey<8> lower;
+  GenericKey<8> upper;
+  auto remove_range = [&](int64_t from, int64_t to) {
+    lower.SetFromInteger(from);
+    upper.SetFromInteger(to);
+    auto begin = model.lower_bound(from);
+    auto end = model.lower_bound(std::max(from, to));
+    int expected = std::distance(begin, end);
+    model.erase(begin, end);
+    EXPECT_EQ(expected, tree.RemoveRange(lower, upper)) << from << " " << to;
+    CheckTree(&tree, bpm, model);
+  };
+  remove_range(500, 400);
+  remove_range(700, 700);
+  std::mt19937 rng(9);
+  for (int64_t width : {1, 2, 5, 30, 200}) {
+    for (int i = 0; i < 8; i++) {
+      int64_t from = static_cast<int64_t>(rng() % (scale_factor + 10)) - 5;
+      remove_range(from, from + width);
+    }
+  }
+  remove_range(scale_factor / 4, scale_factor * 3 / 4);
+  remove_range(0, scale_factor / 2);
+  remove_range(scale_factor - 10, scale_factor + 10);
+
+  // the tree is empty once everything goes, and grows again
+  remove_range(0, scale_factor + 1);
+  rid.Set(0, 7);
+  index_key.SetFromInteger(7);
+  EXPECT_TRUE(tree.Insert(index_key, rid));
+  model.insert(7);
+  CheckTree(&tree, bpm, model);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Inserts groups of keys until the parent of the last leaves is full, with no room for a long separator in place of a
+// short one, then has a removal redistribute two of those leaves so that their separator gets long, which splits the
+// parent
+TEST(BPlusTreeTests, RedistributeIntoFullParentTest) {
+  using InternalPage = BPlusTreeInternalPage<GenericKey<128>, page_id_t, GenericComparator<128>>;
+  auto key_schema = ParseCreateStatement("a varchar(128)");
+  GenericComparator<128> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(100, disk_manager);
+  BPlusTree<GenericKey<128>, RID, GenericComparator<128>> tree("foo_pk", bpm, comparator, 4);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // the keys of a group share all but their last byte, the keys of two groups differ in their first bytes, so the
+  // leaves of sequential inserts hold half a group each and the separator in front of a group is short
+  auto make_key = [&](int group, int index) {
+    std::string string = std::to_string(100000 + group) + std::string(100, 'x') + static_cast<char>('a' + index);
+    GenericKey<128> key;
+    key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(string)}, key_schema.get()), key_schema.get());
+    return key;
+  };
+  auto leaf_of = [&](const GenericKey<128> &key) {
+    Page *page = tree.FindLeafPage(key);
+    page_id_t leaf_page_id = page->GetPageId();
+    bpm->UnpinPage(leaf_page_id, false);
+    return leaf_page_id;
+  };
+  auto parent_of = [&](page_id_t page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    page_id_t parent_page_id = reinterpret_cast<BPlusTreePage *>(page->GetData())->GetParentPageId();
+    bpm->UnpinPage(page_id, false);
+    return parent_page_id;
+  };
+
+  // a key past the last one of a group moves over to the leaf of the next group, with a separator as long as the keys
+  int groups = 0;
+  page_id_t parent_page_id = INVALID_PAGE_ID;
+  int parent_size = 0;
+  while (parent_page_id == INVALID_PAGE_ID) {
+    for (int index = 0; index < 4; index++) {
+      ASSERT_TRUE(tree.Insert(make_key(groups, index), RID(groups, index)));
+    }
+    groups++;
+    page_id_t candidate_page_id = parent_of(leaf_of(make_key(groups - 1, 0)));
+    if (groups < 2 || candidate_page_id == INVALID_PAGE_ID ||
+        candidate_page_id != parent_of(leaf_of(make_key(groups - 2, 3)))) {
+      continue;
+    }
+    Page *page = bpm->FetchPage(candidate_page_id);
+    auto *parent = reinterpret_cast<InternalPage *>(page->GetData());
+    GenericKey<128> separator = InternalPage::ShortestSeparator(make_key(groups - 2, 3), make_key(groups - 2, 4));
+    int index = parent->ValueIndex(leaf_of(make_key(groups - 1, 0)));
+    if (parent->GetSize() == parent->GetMaxSize() && parent->MaxSizeWithKeyAt(index, separator) < parent->GetSize()) {
+      parent_page_id = candidate_page_id;
+      parent_size = parent->GetSize();
+    }
+    bpm->UnpinPage(candidate_page_id, false);
+  }
+  const int group = groups - 1;
+  ASSERT_TRUE(tree.Insert(make_key(group - 1, 4), RID(group - 1, 4)));
+  tree.Remove(make_key(group, 0));
+  EXPECT_EQ(leaf_of(make_key(group - 1, 4)), leaf_of(make_key(group, 1)));
+  Page *page = bpm->FetchPage(parent_page_id);
+  EXPECT_GT(parent_size, reinterpret_cast<BPlusTreePage *>(page->GetData())->GetSize());
+  bpm->UnpinPage(parent_page_id, false);
+
+  std::vector<RID> rids;
+  for (int i = 0; i < groups; i++) {
+    for (int index = 0; index < 5; index++) {
+      bool exists = index < 4 ? i != group || index != 0 : i == group - 1;
+      rids.clear();
+      EXPECT_EQ(exists, tree.GetValue(make_key(i, index), &rids)) << i << " " << index;
+    }
+  }
+  page_id_t root_page_id = parent_page_id;
+  while (parent_of(root_page_id) != INVALID_PAGE_ID) {
+    root_page_id = parent_of(root_page_id);
+  }
+  CheckSubtree<128>(bpm, root_page_id, INVALID_PAGE_ID);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
 }  // namespace bustub
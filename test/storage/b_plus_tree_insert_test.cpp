@@ -12,11 +12,15 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 #include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -145,4 +149,319 @@ TEST(BPlusTreeTests, DISABLED_InsertTest2) {
   remove("test.db");
   remove("test.log");
 }
+// Bulk loads shuffled pairs with duplicate keys, in memory and through spilled runs, at several fill factors
+TEST(BPlusTreeTests, BulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const int64_t num_keys = 3000;
+  const int leaf_max_size = 16;
+
+  // every third key comes twice, the pair with page id 0 is first and must win
+  std::vector<std::pair<GenericKey<8>, RID>> pairs;
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    index_key.SetFromInteger(key);
+    pairs.emplace_back(index_key, RID(0, key));
+  }
+  std::shuffle(pairs.begin(), pairs.end(), std::mt19937(15445));
+  for (int64_t key = 3; key <= num_keys; key += 3) {
+    index_key.SetFromInteger(key);
+    pairs.emplace_back(index_key, RID(1, key));
+  }
+
+  for (double fill_factor : {1.0, 0.5}) {
+    for (size_t run_size : {static_cast<size_t>(BULK_LOAD_RUN_SIZE), static_cast<size_t>(500)}) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, leaf_max_size, 8);
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      tree.BulkLoad(pairs.begin(), pairs.end(), fill_factor, nullptr, run_size);
+
+      // leaves hold the fill of their capacity, except for the last two that may be evened out
+      const size_t fill = fill_factor == 1.0 ? leaf_max_size - 1 : (leaf_max_size - 1) / 2 + 1;
+      std::vector<size_t> leaf_sizes;
+      Page *page = tree.FindLeafPage(index_key, true);
+      while (true) {
+        auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(page->GetData());
+        leaf_sizes.push_back(leaf->GetSize());
+        page_id_t next_page_id = leaf->GetNextPageId();
+        bpm->UnpinPage(page->GetPageId(), false);
+        if (next_page_id == INVALID_PAGE_ID) {
+          break;
+        }
+        page = bpm->FetchPage(next_page_id);
+      }
+      for (size_t i = 0; i + 2 < leaf_sizes.size(); i++) {
+        EXPECT_EQ(fill, leaf_sizes[i]);
+      }
+      for (auto size : leaf_sizes) {
+        EXPECT_LE(leaf_max_size / 2, size);
+        EXPECT_GT(leaf_max_size, size);
+      }
+
+      int64_t expected = 1;
+      for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+        EXPECT_EQ(RID(0, expected), (*iterator).second);
+        expected++;
+      }
+      EXPECT_EQ(num_keys + 1, expected);
+
+      // the loaded tree keeps growing and shrinking as usual
+      for (int64_t key = num_keys + 1; key <= 2 * num_keys; key++) {
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.Insert(index_key, RID(0, key)));
+      }
+      for (int64_t key = 1; key <= num_keys; key += 2) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key);
+      }
+      std::vector<RID> rids;
+      for (int64_t key = 1; key <= 2 * num_keys; key++) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_EQ(key > num_keys || key % 2 == 0, tree.GetValue(index_key, &rids)) << key;
+      }
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete disk_manager;
+      delete bpm;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+}
+
+// Loads full leaves with keys that share most of their bytes, then inserts keys that share fewer of them and removes
+// the first ones, so that compressed leaves widen their layout, split to make room, and merge
+TEST(BPlusTreeTests, CompressedLeavesTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // the keys loaded first only differ in their third and fourth byte
+  const int64_t num_keys = 4000;
+  std::vector<int64_t> keys;
+  std::vector<std::pair<GenericKey<8>, RID>> pairs;
+  GenericKey<8> index_key;
+  for (int64_t i = 1; i <= num_keys; i++) {
+    keys.push_back(i << 16);
+    index_key.SetFromInteger(i << 16);
+    pairs.emplace_back(index_key, RID(0, i));
+  }
+  tree.BulkLoad(pairs.begin(), pairs.end());
+
+  // full leaves hold more entries than uncompressed keys would leave room for
+  const int uncompressed = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - 8) / 16;
+  int max_leaf_size = 0;
+  index_key.SetFromInteger(0);
+  Page *page = tree.FindLeafPage(index_key, true);
+  while (true) {
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(page->GetData());
+    max_leaf_size = std::max(max_leaf_size, leaf->GetSize());
+    page_id_t next_page_id = leaf->GetNextPageId();
+    bpm->UnpinPage(page->GetPageId(), false);
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    page = bpm->FetchPage(next_page_id);
+  }
+  EXPECT_LT(uncompressed, max_leaf_size);
+
+  // keys in between share only their trailing bytes with the others
+  std::vector<int64_t> new_keys;
+  for (int64_t i = 1; i <= num_keys; i++) {
+    new_keys.push_back((i << 16) + 1 + (i * 7919) % 65535);
+  }
+  std::shuffle(new_keys.begin(), new_keys.end(), std::mt19937(15445));
+  for (auto key : new_keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(1, key >> 16)));
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    if ((key >> 16) % 3 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+  }
+
+  std::vector<RID> rids;
+  for (int64_t i = 1; i <= num_keys; i++) {
+    rids.clear();
+    index_key.SetFromInteger(i << 16);
+    EXPECT_EQ(i % 3 == 0, tree.GetValue(index_key, &rids)) << i;
+    rids.clear();
+    index_key.SetFromInteger((i << 16) + 1 + (i * 7919) % 65535);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids)) << i;
+    EXPECT_EQ(RID(1, i), rids[0]);
+  }
+  int64_t previous = 0;
+  int64_t count = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    int64_t key = (*iterator).first.ToString();
+    EXPECT_LT(previous, key);
+    previous = key;
+    count++;
+  }
+  EXPECT_EQ(num_keys + num_keys / 3, count);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Inserts short and long string keys in random order, then removes every other one, so that leaves take as many short
+// keys as fit and split, merge and redistribute around long ones
+TEST(BPlusTreeTests, VariableLengthKeysTest) {
+  auto key_schema = ParseCreateStatement("a varchar(128)");
+  GenericComparator<128> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  BPlusTree<GenericKey<128>, RID, GenericComparator<128>> tree("foo_pk", bpm, comparator);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // every fourth key is longer than a 64 byte key would hold, the others take a few bytes
+  const int num_keys = 3000;
+  auto make_key = [&](int i) {
+    std::string string = std::to_string(i);
+    if (i % 4 == 0) {
+      string = std::string(100, 'x') + string;
+    }
+    GenericKey<128> key;
+    key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(string)}, key_schema.get()), key_schema.get());
+    return key;
+  };
+  std::vector<int> keys;
+  for (int i = 0; i < num_keys; i++) {
+    keys.push_back(i);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    EXPECT_TRUE(tree.Insert(make_key(key), RID(0, key)));
+  }
+
+  // full leaves hold more entries than uncompressed keys would leave room for
+  const int uncompressed = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - 128) / (128 + 8);
+  int max_leaf_size = 0;
+  Page *page = tree.FindLeafPage(make_key(0), true);
+  while (true) {
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<128>, RID, GenericComparator<128>> *>(page->GetData());
+    max_leaf_size = std::max(max_leaf_size, leaf->GetSize());
+    page_id_t next_page_id = leaf->GetNextPageId();
+    bpm->UnpinPage(page->GetPageId(), false);
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    page = bpm->FetchPage(next_page_id);
+  }
+  EXPECT_LT(4 * uncompressed, max_leaf_size);
+
+  for (auto key : keys) {
+    if (key % 2 == 0) {
+      tree.Remove(make_key(key));
+    }
+  }
+  std::vector<RID> rids;
+  for (int i = 0; i < num_keys; i++) {
+    rids.clear();
+    EXPECT_EQ(i % 2 == 1, tree.GetValue(make_key(i), &rids)) << i;
+    if (i % 2 == 1) {
+      EXPECT_EQ(RID(0, i), rids[0]);
+    }
+  }
+  int count = 0;
+  GenericKey<128> previous;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    if (count > 0) {
+      EXPECT_LT(comparator(previous, (*iterator).first), 0);
+    }
+    EXPECT_EQ(1, (*iterator).second.GetSlotNum() % 2);
+    previous = (*iterator).first;
+    count++;
+  }
+  EXPECT_EQ(num_keys / 2, count);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Inserts long keys that differ in their first few bytes, so that internal pages hold short separators and take many
+// more children than full keys would leave room for
+TEST(BPlusTreeTests, ShortestSeparatorsTest) {
+  auto key_schema = ParseCreateStatement("a varchar(128)");
+  GenericComparator<128> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  BPlusTree<GenericKey<128>, RID, GenericComparator<128>> tree("foo_pk", bpm, comparator);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int num_keys = 20000;
+  auto make_key = [&](int i) {
+    GenericKey<128> key;
+    std::string string = std::to_string(i) + std::string(100, 'y');
+    key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(string)}, key_schema.get()), key_schema.get());
+    return key;
+  };
+  std::vector<int> keys;
+  for (int i = 0; i < num_keys; i++) {
+    keys.push_back(i);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    EXPECT_TRUE(tree.Insert(make_key(key), RID(0, key)));
+  }
+
+  // the parent of a leaf holds more children than full keys would leave room for
+  const int uncompressed = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(uint16_t) + 128 + sizeof(page_id_t));
+  Page *page = tree.FindLeafPage(make_key(0), true);
+  page_id_t parent_page_id = reinterpret_cast<BPlusTreePage *>(page->GetData())->GetParentPageId();
+  bpm->UnpinPage(page->GetPageId(), false);
+  ASSERT_NE(INVALID_PAGE_ID, parent_page_id);
+  page = bpm->FetchPage(parent_page_id);
+  auto *parent =
+      reinterpret_cast<BPlusTreeInternalPage<GenericKey<128>, page_id_t, GenericComparator<128>> *>(page->GetData());
+  EXPECT_LT(2 * uncompressed, parent->GetSize());
+  bpm->UnpinPage(parent_page_id, false);
+
+  for (auto key : keys) {
+    if (key % 2 == 0) {
+      tree.Remove(make_key(key));
+    }
+  }
+  std::vector<RID> rids;
+  for (int i = 0; i < num_keys; i++) {
+    rids.clear();
+    EXPECT_EQ(i % 2 == 1, tree.GetValue(make_key(i), &rids)) << i;
+    if (i % 2 == 1) {
+      EXPECT_EQ(RID(0, i), rids[0]);
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
@@ -11,6 +11,10 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -23,14 +27,22 @@ class DiskManagerTest : public ::testing::Test {
   // This function is called before every test.
   void SetUp() override {
     remove("test.db");
-    remove("test.log");
+    RemoveLogSegments();
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
-    remove("test.log");
+    RemoveLogSegments();
   };
+
+  static void RemoveLogSegments() {
+    for (const auto &entry : std::filesystem::directory_iterator(".")) {
+      if (entry.path().filename().string().rfind("test.log", 0) == 0) {
+        std::filesystem::remove(entry.path());
+      }
+    }
+  }
 };
 
 // NOLINTNEXTLINE
@@ -72,6 +84,74 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LogSegmentTest) {
+  std::vector<char> data(LOG_BUFFER_SIZE);
+  std::vector<char> buffers[2] = {std::vector<char>(LOG_BUFFER_SIZE), std::vector<char>(LOG_BUFFER_SIZE)};
+  std::vector<char> buf(LOG_BUFFER_SIZE);
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Write two and a half segments, the buffers have to alternate like the log manager's.
+  int total = 2 * LOG_SEGMENT_SIZE + LOG_SEGMENT_SIZE / 2;
+  for (int offset = 0, i = 0; offset < total; offset += LOG_BUFFER_SIZE, i++) {
+    auto &buffer = buffers[i % 2];
+    for (int j = 0; j < LOG_BUFFER_SIZE; j++) {
+      buffer[j] = static_cast<char>((offset + j) % 251 + 1);
+    }
+    dm.WriteLog(buffer.data(), std::min(LOG_BUFFER_SIZE, total - offset));
+  }
+  EXPECT_EQ(dm.GetLogWriteOffset(), total);
+  EXPECT_EQ(dm.GetLogStartOffset(), 0);
+  EXPECT_EQ(static_cast<int>(std::filesystem::file_size("test.log.0")), LOG_SEGMENT_SIZE);
+  EXPECT_EQ(static_cast<int>(std::filesystem::file_size("test.log.2")), LOG_SEGMENT_SIZE);
+
+  // Reads stop at the end of a segment.
+  ASSERT_TRUE(dm.ReadLog(buf.data(), LOG_BUFFER_SIZE, LOG_SEGMENT_SIZE - 16));
+  for (int j = 0; j < 16; j++) {
+    EXPECT_EQ(buf[j], static_cast<char>((LOG_SEGMENT_SIZE - 16 + j) % 251 + 1));
+  }
+  EXPECT_EQ(buf[16], 0);
+
+  // Recycling turns the old segments into zero filled future segments.
+  dm.RecycleLogSegments(2 * LOG_SEGMENT_SIZE + 100);
+  EXPECT_EQ(dm.GetLogStartOffset(), 2 * LOG_SEGMENT_SIZE);
+  EXPECT_FALSE(dm.ReadLog(buf.data(), LOG_BUFFER_SIZE, 0));
+  ASSERT_TRUE(dm.ReadLog(buf.data(), LOG_BUFFER_SIZE, 2 * LOG_SEGMENT_SIZE));
+  EXPECT_EQ(buf[0], static_cast<char>((2 * LOG_SEGMENT_SIZE) % 251 + 1));
+  ASSERT_TRUE(dm.ReadLog(buf.data(), LOG_BUFFER_SIZE, 3 * LOG_SEGMENT_SIZE));
+  EXPECT_EQ(buf[0], 0);
+  EXPECT_EQ(static_cast<int>(std::filesystem::file_size("test.log.4")), LOG_SEGMENT_SIZE);
+  dm.ShutDown();
+
+  // A restarted database continues in the first spare segment.
+  auto dm2 = DiskManager(db_file);
+  EXPECT_EQ(dm2.GetLogStartOffset(), 2 * LOG_SEGMENT_SIZE);
+  EXPECT_EQ(dm2.GetLogWriteOffset(), 3 * LOG_SEGMENT_SIZE);
+  dm2.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LargeLogOffsetTest) {
+  // a log whose segments have been recycled so often that its offsets no longer fit in 32 bits
+  const int segment = 4000;
+  const int64_t segment_offset = static_cast<int64_t>(segment) * LOG_SEGMENT_SIZE;
+  ASSERT_GT(segment_offset, INT32_MAX);
+  std::ofstream("test.log." + std::to_string(segment));
+  std::vector<char> data(LOG_BUFFER_SIZE, 7);
+  std::vector<char> buf(LOG_BUFFER_SIZE);
+  auto dm = DiskManager("test.db");
+  EXPECT_EQ(dm.GetLogStartOffset(), segment_offset);
+  EXPECT_EQ(dm.GetLogWriteOffset(), segment_offset);
+
+  dm.WriteLog(data.data(), LOG_BUFFER_SIZE);
+  EXPECT_EQ(dm.GetLogWriteOffset(), segment_offset + LOG_BUFFER_SIZE);
+  ASSERT_TRUE(dm.ReadLog(buf.data(), LOG_BUFFER_SIZE, segment_offset));
+  EXPECT_EQ(buf, data);
+  EXPECT_EQ(static_cast<int>(std::filesystem::file_size("test.log." + std::to_string(segment))), LOG_SEGMENT_SIZE);
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
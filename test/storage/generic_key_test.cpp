@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key_test.cpp
+//
+// Identification: test/storage/generic_key_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"  // NOLINT
+#include "type/limits.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+// checks that the encodings of values, which are in ascending order, order alike with memcmp
+void CheckEncodedOrder(const std::vector<Value> &values) {
+  const uint32_t size = 32;
+  std::vector<std::string> encoded;
+  for (const auto &value : values) {
+    std::string data(size, '\0');
+    uint32_t offset = 0;
+    EncodeKeyValue(value, data.data(), size, &offset);
+    encoded.push_back(data);
+  }
+  for (size_t i = 0; i < encoded.size(); i++) {
+    for (size_t j = i + 1; j < encoded.size(); j++) {
+      EXPECT_LT(memcmp(encoded[i].data(), encoded[j].data(), size), 0) << values[i].ToString() << " < "
+                                                                        << values[j].ToString();
+    }
+  }
+}
+}  // namespace
+
+TEST(GenericKeyTest, EncodedOrderTest) {
+  CheckEncodedOrder({ValueFactory::GetNullValueByType(TypeId::TINYINT), ValueFactory::GetTinyIntValue(-127),
+                     ValueFactory::GetTinyIntValue(-1), ValueFactory::GetTinyIntValue(0),
+                     ValueFactory::GetTinyIntValue(1), ValueFactory::GetTinyIntValue(127)});
+  CheckEncodedOrder({ValueFactory::GetNullValueByType(TypeId::SMALLINT), ValueFactory::GetSmallIntValue(-300),
+                     ValueFactory::GetSmallIntValue(-2), ValueFactory::GetSmallIntValue(255),
+                     ValueFactory::GetSmallIntValue(256)});
+  CheckEncodedOrder({ValueFactory::GetNullValueByType(TypeId::INTEGER), ValueFactory::GetIntegerValue(-70000),
+                     ValueFactory::GetIntegerValue(-1), ValueFactory::GetIntegerValue(0),
+                     ValueFactory::GetIntegerValue(65536), ValueFactory::GetIntegerValue(70000)});
+  CheckEncodedOrder({ValueFactory::GetNullValueByType(TypeId::BIGINT),
+                     ValueFactory::GetBigIntValue(std::numeric_limits<int64_t>::min() + 1),
+                     ValueFactory::GetBigIntValue(-(int64_t{1} << 40)), ValueFactory::GetBigIntValue(-1),
+                     ValueFactory::GetBigIntValue(0), ValueFactory::GetBigIntValue(int64_t{1} << 40),
+                     ValueFactory::GetBigIntValue(std::numeric_limits<int64_t>::max())});
+  CheckEncodedOrder({ValueFactory::GetNullValueByType(TypeId::BOOLEAN), ValueFactory::GetBooleanValue(false),
+                     ValueFactory::GetBooleanValue(true)});
+  CheckEncodedOrder({ValueFactory::GetDecimalValue(-1e10), ValueFactory::GetDecimalValue(-2.5),
+                     ValueFactory::GetDecimalValue(-0.5), ValueFactory::GetDecimalValue(0.0),
+                     ValueFactory::GetDecimalValue(0.5), ValueFactory::GetDecimalValue(2.5),
+                     ValueFactory::GetDecimalValue(1e10)});
+  CheckEncodedOrder({Value(TypeId::TIMESTAMP, BUSTUB_TIMESTAMP_NULL), ValueFactory::GetTimestampValue(0),
+                     ValueFactory::GetTimestampValue(1), ValueFactory::GetTimestampValue(int64_t{1} << 40)});
+  CheckEncodedOrder({ValueFactory::GetNullValueByType(TypeId::VARCHAR), ValueFactory::GetVarcharValue(""),
+                     ValueFactory::GetVarcharValue("a"), ValueFactory::GetVarcharValue(std::string("a\0", 2)),
+                     ValueFactory::GetVarcharValue(std::string("a\0b", 3)), ValueFactory::GetVarcharValue("ab"),
+                     ValueFactory::GetVarcharValue("b")});
+}
+
+TEST(GenericKeyTest, MultiColumnKeyTest) {
+  auto key_schema = ParseCreateStatement("a varchar(64),b integer");
+  GenericComparator<16> comparator(key_schema.get());
+  auto make_key = [&](const std::string &a, int32_t b) {
+    GenericKey<16> key;
+    key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(a), ValueFactory::GetIntegerValue(b)}, key_schema.get()),
+                   key_schema.get());
+    return key;
+  };
+
+  // the string column orders first, even where a shorter string is followed by a larger integer
+  EXPECT_LT(comparator(make_key("ab", 5), make_key("abc", -5)), 0);
+  EXPECT_LT(comparator(make_key("ab", -5), make_key("ab", 5)), 0);
+  EXPECT_EQ(comparator(make_key("ab", 5), make_key("ab", 5)), 0);
+  // keys longer than the key size are cut off
+  EXPECT_EQ(comparator(make_key(std::string(40, 'x'), 1), make_key(std::string(40, 'x'), 2)), 0);
+  EXPECT_LT(comparator(make_key(std::string(10, 'x'), 1), make_key(std::string(40, 'x'), 2)), 0);
+}
+
+TEST(GenericKeyTest, IntegerRoundTripTest) {
+  for (int64_t integer : {std::numeric_limits<int64_t>::min() + 1, int64_t{-70000}, int64_t{-1}, int64_t{0},
+                          int64_t{42}, std::numeric_limits<int64_t>::max()}) {
+    GenericKey<8> key;
+    key.SetFromInteger(integer);
+    EXPECT_EQ(integer, key.ToString());
+  }
+  GenericKey<4> key;
+  key.SetFromInteger(-70000);
+  EXPECT_EQ(-70000, key.ToString());
+}
+
+TEST(GenericKeyTest, RidSuffixTest) {
+  // the RID suffix orders the entries of one key by page id, then slot number, after every smaller key
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<16> comparator(key_schema.get());
+  auto make_key = [&](int64_t a, const RID &rid) {
+    GenericKey<16> key;
+    key.SetFromKey(Tuple({ValueFactory::GetBigIntValue(a)}, key_schema.get()), key_schema.get());
+    key.SetRid(rid);
+    return key;
+  };
+  std::vector<RID> rids{RID(-1, 0), RID(0, 0), RID(0, 1), RID(0, 300), RID(1, 0), RID(70000, 2)};
+  for (size_t i = 0; i < rids.size(); i++) {
+    EXPECT_EQ(rids[i], make_key(5, rids[i]).GetRid());
+    EXPECT_LT(comparator(make_key(4, rids.back()), make_key(5, rids[i])), 0);
+    for (size_t j = i + 1; j < rids.size(); j++) {
+      EXPECT_LT(comparator(make_key(5, rids[i]), make_key(5, rids[j])), 0);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search_test.cpp
+//
+// Identification: test/storage/key_search_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/key_search.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+// checks the searches over sorted random integers of the given byte size against std::lower_bound/upper_bound
+template <size_t KeySize>
+void CheckIntegerSearch(const std::string &column_type, uint32_t integer_size, int64_t lowest, int64_t highest) {
+  auto key_schema = ParseCreateStatement("a " + column_type);
+  GenericComparator<KeySize> comparator(key_schema.get());
+
+  auto make_key = [&](int64_t integer) {
+    Value value = integer_size == sizeof(int8_t)    ? Value(TypeId::TINYINT, static_cast<int8_t>(integer))
+                  : integer_size == sizeof(int16_t) ? Value(TypeId::SMALLINT, static_cast<int16_t>(integer))
+                  : integer_size == sizeof(int32_t) ? Value(TypeId::INTEGER, static_cast<int32_t>(integer))
+                                                    : Value(TypeId::BIGINT, integer);
+    GenericKey<KeySize> key;
+    key.SetFromKey(Tuple({value}, key_schema.get()), key_schema.get());
+    return key;
+  };
+
+  std::mt19937_64 rng(static_cast<uint64_t>(integer_size));
+  std::uniform_int_distribution<int64_t> dist(lowest, highest);
+  for (int n : {0, 1, 3, KEY_SEARCH_SCAN_SIZE - 1, KEY_SEARCH_SCAN_SIZE, KEY_SEARCH_SCAN_SIZE + 1, 100, 500}) {
+    std::vector<int64_t> integers;
+    for (int i = 0; i < n; i++) {
+      integers.push_back(dist(rng));
+    }
+    std::sort(integers.begin(), integers.end());
+    integers.erase(std::unique(integers.begin(), integers.end()), integers.end());
+    std::vector<GenericKey<KeySize>> keys;
+    for (auto integer : integers) {
+      keys.push_back(make_key(integer));
+    }
+    auto key_at = [&](int index) -> const GenericKey<KeySize> & { return keys[index]; };
+
+    std::vector<int64_t> probes{lowest, highest};
+    for (auto integer : integers) {
+      probes.push_back(integer);
+      probes.push_back(std::max(lowest, integer - 1));
+      probes.push_back(std::min(highest, integer + 1));
+    }
+    const int size = static_cast<int>(keys.size());
+    for (auto probe : probes) {
+      auto key = make_key(probe);
+      int lower = std::lower_bound(integers.begin(), integers.end(), probe) - integers.begin();
+      int upper = std::upper_bound(integers.begin(), integers.end(), probe) - integers.begin();
+      using Search = KeySearch<GenericKey<KeySize>, GenericComparator<KeySize>>;
+      EXPECT_EQ(lower, Search::LowerBound(key, 0, size, key_at, comparator));
+      EXPECT_EQ(upper, Search::UpperBound(key, 0, size, key_at, comparator));
+      if (size > 0) {
+        EXPECT_EQ(std::max(upper, 1), Search::UpperBound(key, 1, size, key_at, comparator));
+      }
+    }
+  }
+}
+}  // namespace
+
+TEST(KeySearchTest, IntegerKeysTest) {
+  CheckIntegerSearch<8>("tinyint", 1, std::numeric_limits<int8_t>::min(), std::numeric_limits<int8_t>::max());
+  CheckIntegerSearch<8>("smallint", 2, std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max());
+  CheckIntegerSearch<8>("integer", 4, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max());
+  CheckIntegerSearch<8>("bigint", 8, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+  CheckIntegerSearch<16>("bigint", 8, -1000, 1000);
+}
+
+TEST(KeySearchTest, CountIntegersBelowTest) {
+  const int64_t lowest = std::numeric_limits<int64_t>::min();
+  const int64_t highest = std::numeric_limits<int64_t>::max();
+  std::vector<int64_t> keys{lowest, -5, -5, 0, 3, 3, 3, highest};
+  for (int n = 0; n <= static_cast<int>(keys.size()); n++) {
+    for (auto key : keys) {
+      int below = std::count_if(keys.begin(), keys.begin() + n, [&](int64_t k) { return k < key; });
+      int not_above = std::count_if(keys.begin(), keys.begin() + n, [&](int64_t k) { return k <= key; });
+      EXPECT_EQ(below, CountIntegersBelow(keys.data(), n, key, false));
+      EXPECT_EQ(not_above, CountIntegersBelow(keys.data(), n, key, true));
+    }
+  }
+}
+
+TEST(KeySearchTest, MultiColumnKeysTest) {
+  // keys that share their first 8 bytes are told apart by the comparator
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  GenericComparator<16> comparator(key_schema.get());
+
+  std::vector<GenericKey<16>> keys;
+  for (int64_t a = 0; a < 10; a++) {
+    for (int64_t b = -30; b < 30; b++) {
+      GenericKey<16> key;
+      key.SetFromKey(Tuple({Value(TypeId::BIGINT, a), Value(TypeId::BIGINT, b)}, key_schema.get()), key_schema.get());
+      keys.push_back(key);
+    }
+  }
+  auto key_at = [&](int index) -> const GenericKey<16> & { return keys[index]; };
+  using Search = KeySearch<GenericKey<16>, GenericComparator<16>>;
+  const int size = static_cast<int>(keys.size());
+  for (int i = 0; i < size; i++) {
+    EXPECT_EQ(i, Search::LowerBound(keys[i], 0, size, key_at, comparator));
+    EXPECT_EQ(i + 1, Search::UpperBound(keys[i], 0, size, key_at, comparator));
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,227 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_table_test.cpp
+//
+// Identification: test/table/lsm_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/table/lsm_table.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+Tuple MakeTuple(const Schema &schema, int64_t key, const std::string &payload) {
+  return Tuple{std::vector<Value>{ValueFactory::GetBigIntValue(key), ValueFactory::GetVarcharValue(payload)}, &schema};
+}
+
+int64_t KeyOf(const Schema &schema, const Tuple &tuple) { return tuple.GetValue(&schema, 0).GetAs<int64_t>(); }
+}  // namespace
+
+TEST(LsmTableTest, InsertScanTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  Schema schema{std::vector<Column>{{"key", TypeId::BIGINT}, {"payload", TypeId::VARCHAR, 64}}};
+  Transaction txn(0);
+  // a memtable of 16 KB, flushed every hundred tuples or so
+  auto *table = new LsmTable(bpm, nullptr, nullptr, 16 << 10, 4, 4);
+
+  const int num_tuples = 10000;
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(table->InsertTuple(MakeTuple(schema, i, "event " + std::to_string(i)), &rids[i], &txn));
+  }
+  table->Flush();
+  // level 0 is merged away once it fills up, and the levels below it take the runs
+  EXPECT_LT(table->GetNumRuns(0), 4);
+  EXPECT_EQ(1, table->GetNumRuns(2));
+
+  for (int i = 0; i < num_tuples; i++) {
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, &txn)) << i;
+    EXPECT_EQ(i, KeyOf(schema, tuple));
+    EXPECT_EQ("event " + std::to_string(i), tuple.GetValue(&schema, 1).ToString());
+    EXPECT_EQ(rids[i], tuple.GetRid());
+  }
+
+  // a scan returns the tuples in the order of the inserts
+  int64_t expected = 0;
+  for (auto tuple = table->Begin(&txn); tuple != table->End(); ++tuple) {
+    EXPECT_EQ(expected, KeyOf(schema, *tuple));
+    EXPECT_EQ(rids[expected], tuple->GetRid());
+    expected++;
+  }
+  EXPECT_EQ(num_tuples, expected);
+
+  delete table;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(LsmTableTest, DeleteUpdateTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  Schema schema{std::vector<Column>{{"key", TypeId::BIGINT}, {"payload", TypeId::VARCHAR, 64}}};
+  Transaction txn(0);
+  auto *table = new LsmTable(bpm, nullptr, nullptr, 16 << 10, 2, 2);
+
+  const int num_tuples = 4000;
+  std::vector<RID> rids(num_tuples);
+  std::map<int64_t, int64_t> model;
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(table->InsertTuple(MakeTuple(schema, i, "x"), &rids[i], &txn));
+    model[i] = i;
+  }
+  table->Flush();
+
+  // the writes land in the memtable on top of the runs, and in runs of their own after the next flush
+  for (int round = 0; round < 2; round++) {
+    for (int i = round; i < num_tuples; i += 5) {
+      ASSERT_TRUE(table->MarkDelete(rids[i], &txn));
+      Tuple tuple;
+      EXPECT_FALSE(table->GetTuple(rids[i], &tuple, &txn));
+      if (i % 2 == 0) {
+        table->ApplyDelete(rids[i], &txn);
+        model.erase(i);
+        EXPECT_FALSE(table->MarkDelete(rids[i], &txn));
+      } else {
+        table->RollbackDelete(rids[i], &txn);
+      }
+    }
+    for (int i = round + 2; i < num_tuples; i += 7) {
+      if (model.count(i) != 0) {
+        ASSERT_TRUE(table->UpdateTuple(MakeTuple(schema, -i, "updated"), rids[i], &txn));
+        model[i] = -i;
+      }
+    }
+    table->Flush();
+  }
+  txn.GetWriteSet()->clear();
+
+  for (int i = 0; i < num_tuples; i++) {
+    Tuple tuple;
+    auto found = model.find(i);
+    if (found == model.end()) {
+      EXPECT_FALSE(table->GetTuple(rids[i], &tuple, &txn)) << i;
+      continue;
+    }
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, &txn)) << i;
+    EXPECT_EQ(found->second, KeyOf(schema, tuple));
+  }
+  auto expected = model.begin();
+  for (auto tuple = table->Begin(&txn); tuple != table->End(); ++tuple, ++expected) {
+    ASSERT_NE(model.end(), expected);
+    EXPECT_EQ(rids[expected->first], tuple->GetRid());
+    EXPECT_EQ(expected->second, KeyOf(schema, *tuple));
+  }
+  EXPECT_EQ(model.end(), expected);
+
+  delete table;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(LsmTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(128, disk_manager);
+  Schema schema{std::vector<Column>{{"key", TypeId::BIGINT}, {"payload", TypeId::VARCHAR, 64}}};
+  auto *table = new LsmTable(bpm, nullptr, nullptr, 8 << 10, 2, 4);
+
+  // writers append while readers scan; a scan sees the rows in order and every row it sees is complete
+  const int num_writers = 4;
+  const int num_tuples = 3000;
+  std::vector<std::thread> threads;
+  std::vector<std::vector<RID>> rids(num_writers);
+  for (int writer = 0; writer < num_writers; writer++) {
+    threads.emplace_back([&, writer] {
+      Transaction txn(writer);
+      for (int i = 0; i < num_tuples; i++) {
+        RID rid;
+        ASSERT_TRUE(table->InsertTuple(MakeTuple(schema, writer * num_tuples + i, "concurrent"), &rid, &txn));
+        rids[writer].push_back(rid);
+      }
+    });
+  }
+  for (int reader = 0; reader < 2; reader++) {
+    threads.emplace_back([&, reader] {
+      Transaction txn(num_writers + reader);
+      for (int scan = 0; scan < 5; scan++) {
+        int64_t last_row = -1;
+        for (auto tuple = table->Begin(&txn); tuple != table->End(); ++tuple) {
+          EXPECT_LT(last_row, tuple->GetRid().Get());
+          last_row = tuple->GetRid().Get();
+          EXPECT_EQ("concurrent", tuple->GetValue(&schema, 1).ToString());
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  table->Flush();
+
+  Transaction txn(num_writers + 2);
+  for (int writer = 0; writer < num_writers; writer++) {
+    ASSERT_EQ(num_tuples, rids[writer].size());
+    for (int i = 0; i < num_tuples; i++) {
+      Tuple tuple;
+      ASSERT_TRUE(table->GetTuple(rids[writer][i], &tuple, &txn));
+      EXPECT_EQ(writer * num_tuples + i, KeyOf(schema, tuple));
+    }
+  }
+  int count = 0;
+  for (auto tuple = table->Begin(&txn); tuple != table->End(); ++tuple) {
+    count++;
+  }
+  EXPECT_EQ(num_writers * num_tuples, count);
+
+  delete table;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// Two tables hand out different RIDs for their rows, so that the lock manager tells them apart
+TEST(LsmTableTest, DistinctRidsTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  Schema schema{std::vector<Column>{{"key", TypeId::BIGINT}, {"payload", TypeId::VARCHAR, 64}}};
+  Transaction txn(0);
+  auto *first = new LsmTable(bpm, nullptr, nullptr);
+  auto *second = new LsmTable(bpm, nullptr, nullptr);
+
+  const int num_tuples = 100;
+  for (int i = 0; i < num_tuples; i++) {
+    RID first_rid;
+    RID second_rid;
+    ASSERT_TRUE(first->InsertTuple(MakeTuple(schema, i, "first"), &first_rid, &txn));
+    ASSERT_TRUE(second->InsertTuple(MakeTuple(schema, i, "second"), &second_rid, &txn));
+    EXPECT_FALSE(first_rid == second_rid);
+    Tuple tuple;
+    ASSERT_TRUE(second->GetTuple(second_rid, &tuple, &txn));
+    EXPECT_EQ("second", tuple.GetValue(&schema, 1).ToString());
+  }
+
+  delete first;
+  delete second;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+}  // namespace bustub